@@ -0,0 +1,68 @@
+#version 330 core
+// collectibles: one instanced draw of a unit cube, animated here from the spawn data alone
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+// per instance (Collectible), written only when one spawns or is picked up
+layout(location = 3) in vec4 aSpawn;    // xyz resting position, w spawn time (uTime clock)
+layout(location = 4) in vec4 aColorLife; // rgb color, a lifetime in seconds
+
+out vec3 vNormal;
+out vec3 vWorldPos;
+out vec2 vUV;
+out vec4 vLightSpacePos;
+out vec4 vTint;
+
+layout(std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec3 uViewPos;
+    float uTime;
+};
+
+layout(std140) uniform Light
+{
+    mat4 uLightVP;
+    vec3 uLightDir;        // direction FROM surface toward light (unit)
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
+const float kSize = 0.4;       // edge length
+const float kBobHeight = 0.08;
+const float kBobSpeed = 2.5;   // radians per second
+const float kSpinSpeed = 1.5;  // radians per second
+const float kFadeTime = 1.5;   // seconds of fade-out before the lifetime ends
+
+void main()
+{
+    float age = uTime - aSpawn.w;
+    float remaining = aColorLife.a - age;
+    if (remaining <= 0.0)
+    {
+        // expired, waiting for the next rewrite of the buffer: outside the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        vNormal = vec3(0.0, 1.0, 0.0);
+        vWorldPos = vec3(0.0);
+        vUV = vec2(0.0);
+        vLightSpacePos = vec4(0.0, 0.0, 0.0, 1.0);
+        vTint = vec4(0.0);
+        return;
+    }
+
+    float s = sin(age * kSpinSpeed);
+    float c = cos(age * kSpinSpeed);
+    mat3 spin = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c); // about +Y
+    // the phase keeps neighbouring cubes from bobbing in step
+    float bob = kBobHeight * (1.0 + sin(age * kBobSpeed + aSpawn.x + aSpawn.z));
+
+    vec4 world = vec4(aSpawn.xyz + vec3(0.0, bob, 0.0) + spin * (aPos * kSize), 1.0);
+    vWorldPos = world.xyz;
+    vNormal = spin * aNormal;
+    vUV = vec2(0.0);
+    vTint = vec4(aColorLife.rgb, clamp(remaining / kFadeTime, 0.0, 1.0));
+
+    vLightSpacePos = uLightVP * world;
+    gl_Position = uViewProj * world;
+}
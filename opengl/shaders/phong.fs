@@ -4,20 +4,33 @@ in vec3 vNormal;
 in vec3 vWorldPos;
 in vec2 vUV;
 in vec4 vLightSpacePos;
+in vec4 vTint;
 
 out vec4 FragColor;
 
-uniform vec3 uViewPos;
+layout(std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec3 uViewPos;
+    float uTime;
+};
+
+layout(std140) uniform Light
+{
+    mat4 uLightVP;
+    vec3 uLightDir;        // direction FROM surface toward light (unit)
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
 uniform vec3 uMatDiffuse;
 uniform bool uHasDiffuse;
 uniform bool uUseAlphaTest;
 uniform float uAlphaCutoff;
 uniform sampler2D uDiffuseMap;
 
-uniform vec3 uLightDir;        // direction FROM surface toward light (unit)
-uniform vec3 uLightColor;
-uniform float uLightIntensity;
-
 uniform sampler2D uShadowMap;
 
 float ShadowCalculation(vec4 lightSpacePos, vec3 normal, vec3 lightDir)
@@ -63,6 +76,8 @@ void main()
         alpha = t.a;
     }
     if (uUseAlphaTest && alpha < uAlphaCutoff) discard;
+    baseColor *= vTint.rgb;
+    alpha *= vTint.a;
 
     vec3 N = normalize(vNormal);
     vec3 L = normalize(-uLightDir); // we use uLightDir as direction FROM fragment to light
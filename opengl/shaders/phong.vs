@@ -2,25 +2,58 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUV;
+// per instance (InstanceData), read only when uInstanced is set
+layout(location = 3) in mat4 aInstanceModel;
+layout(location = 7) in vec4 aInstanceColor;
 
 out vec3 vNormal;
 out vec3 vWorldPos;
 out vec2 vUV;
 out vec4 vLightSpacePos;
+out vec4 vTint; // rgb multiplies the material color, a its alpha
 
-uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+// shared with every program, written once per frame (SharedUniforms)
+layout(std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec3 uViewPos;
+    float uTime;
+};
+
+layout(std140) uniform Light
+{
+    mat4 uLightVP;
+    vec3 uLightDir;        // direction FROM surface toward light (unit)
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
+uniform mat4 uModel;     // instanced: the prototype's DequantMatrix only
 uniform mat3 uNormalMat;
-uniform mat4 uLightVP;
+uniform bool uInstanced;
 
 void main() {
-    vec4 world = uModel * vec4(aPos,1.0);
+    vec4 world;
+    if (uInstanced)
+    {
+        world = aInstanceModel * (uModel * vec4(aPos, 1.0));
+        // cofactor matrix: the inverse transpose up to a scale, which the normalize removes
+        mat3 m = mat3(aInstanceModel);
+        vNormal = normalize(mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1])) * aNormal);
+        vTint = aInstanceColor;
+    }
+    else
+    {
+        world = uModel * vec4(aPos, 1.0);
+        vNormal = normalize(uNormalMat * aNormal);
+        vTint = vec4(1.0);
+    }
     vWorldPos = world.xyz;
 
-    vNormal = normalize(uNormalMat * aNormal);
     vUV = aUV;
     
     vLightSpacePos = uLightVP * world;
-    gl_Position = uProj * uView * world;
+    gl_Position = uViewProj * world;
 }
@@ -1,10 +1,22 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel; // per instance, read only when uInstanced is set
+
+layout(std140) uniform Light
+{
+    mat4 uLightVP;
+    vec3 uLightDir;        // direction FROM surface toward light (unit)
+    float uLightIntensity;
+    vec3 uLightColor;
+};
 
-uniform mat4 uLightVP;
 uniform mat4 uModel;
+uniform bool uInstanced;
 
 void main()
 {
-    gl_Position = uLightVP * uModel * vec4(aPos, 1.0);
+    vec4 world = uModel * vec4(aPos, 1.0);
+    if (uInstanced)
+        world = aInstanceModel * world;
+    gl_Position = uLightVP * world;
 }
@@ -0,0 +1,214 @@
+// src/AssetIndex.cpp
+#include "AssetIndex.h"
+#include "CompressedTexture.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+static const char *kManifestHeader = "ASSETINDEX 1";
+
+AssetIndex &AssetIndex::Instance()
+{
+    static AssetIndex index;
+    return index;
+}
+
+std::string AssetIndex::Normalize(const std::string &path)
+{
+    std::error_code ec;
+    fs::path p = fs::absolute(fs::path(path), ec);
+    if (ec)
+        p = fs::path(path);
+    return p.lexically_normal().generic_string();
+}
+
+std::string AssetIndex::LowerBasename(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    for (auto &c : name)
+        c = (char)std::tolower((unsigned char)c);
+    return name;
+}
+
+// generated next to the sources, never referenced by models
+static bool SkipFile(const fs::path &p)
+{
+    std::string name = p.filename().string();
+    if (name.empty() || name[0] == '.')
+        return true;
+    std::string ext = p.extension().string();
+    return ext == ".smc" || ext == ".btx" || ext == ".pcm" || ext == ".atlas" || ext == ".tmp";
+}
+
+bool AssetIndex::LoadManifest(const std::string &manifestPath, std::unordered_map<std::string, Entry> &out) const
+{
+    std::ifstream in(manifestPath);
+    if (!in.is_open())
+        return false;
+    std::string line;
+    if (!std::getline(in, line) || line != kManifestHeader)
+        return false;
+    // hash size mtime path (the path is the rest of the line and may contain spaces)
+    while (std::getline(in, line))
+    {
+        std::istringstream ls(line);
+        Entry e;
+        std::string hashHex;
+        if (!(ls >> hashHex >> e.size >> e.mtime))
+            continue;
+        e.hash = std::strtoull(hashHex.c_str(), nullptr, 16);
+        ls.get();
+        std::getline(ls, e.path);
+        if (!e.path.empty())
+            out[e.path] = e;
+    }
+    return true;
+}
+
+bool AssetIndex::SaveManifest(const std::string &manifestPath) const
+{
+    std::string tmpPath = manifestPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "AssetIndex: cannot write " << manifestPath << "\n";
+            return false;
+        }
+        out << kManifestHeader << "\n";
+        char hashHex[17];
+        for (const auto &e : entries)
+        {
+            snprintf(hashHex, sizeof(hashHex), "%016llx", (unsigned long long)e.hash);
+            out << hashHex << " " << e.size << " " << e.mtime << " " << e.path << "\n";
+        }
+        if (!out.good())
+            return false;
+    }
+    std::remove(manifestPath.c_str());
+    return std::rename(tmpPath.c_str(), manifestPath.c_str()) == 0;
+}
+
+bool AssetIndex::Build(const std::vector<std::string> &roots, const std::string &manifestPath)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    entries.clear();
+    byPath.clear();
+    byName.clear();
+    byHash.clear();
+    stats = Stats();
+
+    std::unordered_map<std::string, Entry> previous;
+    LoadManifest(manifestPath, previous);
+
+    // walk the roots: directory listing and stat only, nothing is opened here
+    std::vector<size_t> stale;
+    for (const auto &root : roots)
+    {
+        std::error_code ec;
+        if (!fs::is_directory(root, ec))
+            continue;
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+             it != end && !ec; it.increment(ec))
+        {
+            if (!it->is_regular_file(ec) || SkipFile(it->path()))
+                continue;
+            Entry e;
+            e.path = Normalize(it->path().string());
+            if (byPath.count(e.path))
+                continue; // roots may overlap
+            e.size = (uint64_t)it->file_size(ec);
+            e.mtime = (int64_t)it->last_write_time(ec).time_since_epoch().count();
+            auto prev = previous.find(e.path);
+            if (prev != previous.end() && prev->second.size == e.size && prev->second.mtime == e.mtime)
+            {
+                e.hash = prev->second.hash;
+                previous.erase(prev);
+            }
+            else
+            {
+                if (prev != previous.end())
+                    previous.erase(prev);
+                stale.push_back(entries.size());
+            }
+            byPath[e.path] = entries.size();
+            entries.push_back(e);
+        }
+    }
+    stats.removed = previous.size();
+
+    // only new or changed files are read
+    ParallelFor(stale.size(), [&](size_t i)
+                {
+                    Entry &e = entries[stale[i]];
+                    MappedFile f;
+                    e.hash = f.Open(e.path) ? CompressedTexture::HashBytes(f.Data(), f.Size()) : 0;
+                });
+    stats.rehashed = stale.size();
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        byName[LowerBasename(entries[i].path)].push_back(i);
+        if (entries[i].hash != 0)
+            byHash.emplace(entries[i].hash, i);
+    }
+    if (stats.rehashed > 0 || stats.removed > 0)
+        SaveManifest(manifestPath);
+
+    stats.files = entries.size();
+    stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    built = true;
+
+    char line[200];
+    snprintf(line, sizeof(line), "AssetIndex: %zu files, %zu re-hashed, %zu removed, %.2f ms", stats.files,
+             stats.rehashed, stats.removed, stats.buildMs);
+    std::cout << line << std::endl;
+    return true;
+}
+
+const AssetIndex::Entry *AssetIndex::FindPath(const std::string &path) const
+{
+    auto it = byPath.find(Normalize(path));
+    return it == byPath.end() ? nullptr : &entries[it->second];
+}
+
+const AssetIndex::Entry *AssetIndex::FindName(const std::string &reference, const std::string &preferDir) const
+{
+    auto it = byName.find(LowerBasename(reference));
+    if (it == byName.end())
+        return nullptr;
+    if (it->second.size() > 1 && !preferDir.empty())
+    {
+        std::string dir = Normalize(preferDir) + "/";
+        for (size_t i : it->second)
+        {
+            if (entries[i].path.compare(0, dir.size(), dir) == 0)
+                return &entries[i];
+        }
+    }
+    return &entries[it->second.front()];
+}
+
+const AssetIndex::Entry *AssetIndex::FindHash(uint64_t hash) const
+{
+    auto it = byHash.find(hash);
+    return it == byHash.end() ? nullptr : &entries[it->second];
+}
+
+uint64_t AssetIndex::ContentHash(const std::string &path)
+{
+    const AssetIndex &index = Instance();
+    const Entry *e = index.IsBuilt() ? index.FindPath(path) : nullptr;
+    if (e && e->hash != 0)
+        return e->hash;
+    return CompressedTexture::HashSource(path);
+}
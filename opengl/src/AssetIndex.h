@@ -0,0 +1,64 @@
+// src/AssetIndex.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Startup index of every asset file under a set of root directories: basename -> locations and
+// content hash -> location. Persisted as a manifest so a restart only re-hashes files whose size
+// or mtime changed. Texture references from model files (often absolute paths from the machine
+// that exported them) resolve with one lookup instead of probing candidate paths on disk.
+// Build() runs once on the main thread before any loader starts; lookups are read-only after that
+// and safe from any thread.
+class AssetIndex
+{
+public:
+    struct Entry
+    {
+        std::string path; // generic ('/') absolute path
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0; // FNV-1a of the content, same as CompressedTexture::HashBytes
+    };
+
+    static AssetIndex &Instance();
+
+    // scan roots, reuse manifest hashes for unchanged files, hash the rest in parallel and rewrite
+    // the manifest if anything changed
+    bool Build(const std::vector<std::string> &roots, const std::string &manifestPath);
+    bool IsBuilt() const { return built; }
+
+    // exact indexed file (path need not be canonical), nullptr if unknown
+    const Entry *FindPath(const std::string &path) const;
+    // file with this basename (case-insensitive), preferring one inside preferDir; nullptr if none
+    const Entry *FindName(const std::string &reference, const std::string &preferDir) const;
+    const Entry *FindHash(uint64_t hash) const;
+    // content hash of path: from the index when it holds the file, otherwise the file is read and
+    // hashed (CompressedTexture::HashSource). 0 if unreadable.
+    static uint64_t ContentHash(const std::string &path);
+
+    struct Stats
+    {
+        size_t files = 0;
+        size_t rehashed = 0; // new or changed since the manifest was written
+        size_t removed = 0;  // in the manifest but gone from disk
+        double buildMs = 0.0;
+    };
+    const Stats &GetStats() const { return stats; }
+
+private:
+    AssetIndex() = default;
+
+    static std::string Normalize(const std::string &path);
+    static std::string LowerBasename(const std::string &path);
+    bool LoadManifest(const std::string &manifestPath, std::unordered_map<std::string, Entry> &out) const;
+    bool SaveManifest(const std::string &manifestPath) const;
+
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> byPath;
+    std::unordered_map<std::string, std::vector<size_t>> byName;
+    std::unordered_map<uint64_t, size_t> byHash;
+    Stats stats;
+    bool built = false;
+};
@@ -0,0 +1,86 @@
+// src/AssetLoader.cpp
+#include "AssetLoader.h"
+#include <cstdio>
+#include <iostream>
+
+static double MsSince(std::chrono::high_resolution_clock::time_point t0,
+                      std::chrono::high_resolution_clock::time_point t1)
+{
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+AssetLoader::AssetLoader(unsigned int workers)
+    : start(Clock::now()), pool(workers)
+{
+}
+
+void AssetLoader::Add(const std::string &name, Phase cpu, Phase gl)
+{
+    Record *rec;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        records.emplace_back();
+        rec = &records.back();
+        rec->name = name;
+        rec->gl = std::move(gl);
+    }
+    pool.Submit([this, rec, cpu]()
+                {
+        auto t0 = Clock::now();
+        bool ok = cpu ? cpu() : true;
+        auto t1 = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            rec->cpuMs = MsSince(t0, t1);
+            rec->cpuDone = t1;
+            rec->ok = ok;
+            ready.push_back(rec);
+        }
+        readyCv.notify_one(); });
+}
+
+bool AssetLoader::Finish()
+{
+    bool allOk = true;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (finished < records.size())
+    {
+        readyCv.wait(lock, [this]
+                     { return !ready.empty(); });
+        Record *rec = ready.front();
+        ready.pop_front();
+        lock.unlock();
+
+        auto t0 = Clock::now();
+        rec->waitMs = MsSince(rec->cpuDone, t0);
+        if (rec->ok && rec->gl)
+            rec->ok = rec->gl();
+        rec->glMs = MsSince(t0, Clock::now());
+        allOk = allOk && rec->ok;
+
+        lock.lock();
+        ++finished;
+    }
+    lock.unlock();
+
+    PrintReport(MsSince(start, Clock::now()));
+    return allOk;
+}
+
+void AssetLoader::PrintReport(double wallMs) const
+{
+    double cpuSum = 0.0, glSum = 0.0;
+    std::cout << "AssetLoader: " << records.size() << " assets on " << pool.WorkerCount() << " worker(s)\n";
+    for (const auto &r : records)
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "  %-28s cpu %8.2f ms  wait %7.2f ms  gl %7.2f ms  %s",
+                 r.name.c_str(), r.cpuMs, r.waitMs, r.glMs, r.ok ? "ok" : "FAILED");
+        std::cout << line << "\n";
+        cpuSum += r.cpuMs;
+        glSum += r.glMs;
+    }
+    char total[160];
+    snprintf(total, sizeof(total), "  total: wall %.2f ms, cpu sum %.2f ms, gl sum %.2f ms", wallMs, cpuSum, glSum);
+    std::cout << total << std::endl;
+}
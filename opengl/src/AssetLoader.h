@@ -0,0 +1,51 @@
+// src/AssetLoader.h
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "ThreadPool.h"
+
+// Loads assets in two phases:
+//   cpu - file I/O, parsing and decoding into staging memory, runs on a worker thread
+//   gl  - glGen*/glBufferData/glTexImage2D (or alBufferData), runs on the thread calling Finish()
+// The gl phase of an asset only runs if its cpu phase returned true. Either phase may be empty.
+class AssetLoader
+{
+public:
+    using Phase = std::function<bool()>;
+
+    explicit AssetLoader(unsigned int workers = 0);
+
+    void Add(const std::string &name, Phase cpu, Phase gl);
+
+    // Drain the upload queue on the calling (GL context) thread until every added asset is done,
+    // then print a per-asset timing report. Returns false if any asset failed.
+    bool Finish();
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct Record
+    {
+        std::string name;
+        Phase gl;
+        double cpuMs = 0.0;
+        double waitMs = 0.0; // time between cpu completion and the start of the gl phase
+        double glMs = 0.0;
+        bool ok = true;
+        Clock::time_point cpuDone;
+    };
+
+    void PrintReport(double wallMs) const;
+
+    std::mutex mtx;
+    std::condition_variable readyCv;
+    std::deque<Record> records; // deque: references stay valid while more assets are added
+    std::deque<Record *> ready; // cpu phase finished, waiting for the gl phase
+    size_t finished = 0;
+    Clock::time_point start;
+    ThreadPool pool; // declared last so workers are joined before the records go away
+};
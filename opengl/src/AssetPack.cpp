@@ -0,0 +1,507 @@
+// src/AssetPack.cpp
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static const char kPackMagic[8] = {'A', 'S', 'S', 'E', 'T', 'P', 'K', '\0'};
+static const uint32_t kPackVersion = 1;
+static const uint64_t kPageSize = 4096;
+static const uint32_t kCodecStore = 0;
+static const uint32_t kCodecLz = 1;
+
+struct PackHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount; // power of two, larger than entryCount
+    uint32_t reserved;
+    uint64_t namesSize;
+};
+
+struct AssetPack::Entry
+{
+    uint64_t nameHash;
+    uint64_t offset; // from the start of the pack, page aligned
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t codec;
+    uint32_t reserved;
+};
+
+static uint64_t HashName(const std::string &name)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : name)
+    {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static fs::path Normalize(const std::string &path)
+{
+    std::error_code ec;
+    fs::path p = fs::absolute(fs::path(path), ec);
+    if (ec)
+        p = fs::path(path);
+    p = p.lexically_normal();
+    if (!p.has_filename() && p.has_parent_path())
+        p = p.parent_path(); // "dir/" -> "dir"
+    return p;
+}
+
+static uint64_t AlignUp(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+// ---- LZ codec ----
+// LZ4-style block: sequences of [token][literal length+][literals][offset16][match length+]; the
+// high nibble of the token is the literal count, the low nibble the match length minus 4, 15
+// meaning "more length bytes follow". The last sequence carries literals only.
+static const size_t kMinMatch = 4;
+static const unsigned kHashBits = 14;
+static const size_t kMaxOffset = 65535;
+
+static void PutLength(std::vector<unsigned char> &out, size_t len)
+{
+    while (len >= 255)
+    {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back((unsigned char)len);
+}
+
+static void PutSequence(std::vector<unsigned char> &out, const unsigned char *lit, size_t litLen, size_t offset,
+                        size_t matchLen)
+{
+    size_t ml = matchLen ? matchLen - kMinMatch : 0;
+    out.push_back((unsigned char)((std::min(litLen, (size_t)15) << 4) | std::min(ml, (size_t)15)));
+    if (litLen >= 15)
+        PutLength(out, litLen - 15);
+    out.insert(out.end(), lit, lit + litLen);
+    if (matchLen == 0)
+        return;
+    out.push_back((unsigned char)(offset & 0xFF));
+    out.push_back((unsigned char)(offset >> 8));
+    if (ml >= 15)
+        PutLength(out, ml - 15);
+}
+
+static void LzCompress(const unsigned char *src, size_t n, std::vector<unsigned char> &out)
+{
+    out.clear();
+    out.reserve(n / 2 + 16);
+    std::vector<uint32_t> table((size_t)1 << kHashBits, UINT32_MAX);
+    size_t anchor = 0, i = 0;
+    const size_t limit = n > 12 ? n - 12 : 0; // the tail always goes out as literals
+    while (i < limit)
+    {
+        uint32_t seq;
+        std::memcpy(&seq, src + i, 4);
+        uint32_t h = (seq * 2654435761u) >> (32 - kHashBits);
+        uint32_t cand = table[h];
+        table[h] = (uint32_t)i;
+        if (cand == UINT32_MAX || i - cand > kMaxOffset || std::memcmp(src + cand, src + i, 4) != 0)
+        {
+            ++i;
+            continue;
+        }
+        size_t len = kMinMatch;
+        while (i + len < n - 5 && src[cand + len] == src[i + len])
+            ++len;
+        PutSequence(out, src + anchor, i - anchor, i - cand, len);
+        i += len;
+        anchor = i;
+    }
+    PutSequence(out, src + anchor, n - anchor, 0, 0);
+}
+
+static bool LzDecompress(const unsigned char *src, size_t n, unsigned char *dst, size_t size)
+{
+    const unsigned char *ip = src;
+    const unsigned char *end = src + n;
+    size_t op = 0;
+    auto readLength = [&](size_t &len) -> bool
+    {
+        unsigned char b;
+        do
+        {
+            if (ip >= end)
+                return false;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+    while (ip < end)
+    {
+        unsigned char token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !readLength(lit))
+            return false;
+        if ((size_t)(end - ip) < lit || size - op < lit)
+            return false;
+        std::memcpy(dst + op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end)
+            break; // literals-only last sequence
+        if (end - ip < 2)
+            return false;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !readLength(len))
+            return false;
+        len += kMinMatch;
+        if (offset == 0 || offset > op || size - op < len)
+            return false;
+        if (offset >= len)
+            std::memcpy(dst + op, dst + op - offset, len);
+        else
+        {
+            // overlapping match repeats the last offset bytes
+            for (size_t k = 0; k < len; ++k)
+                dst[op + k] = dst[op - offset + k];
+        }
+        op += len;
+    }
+    return op == size;
+}
+
+// ---- AssetData ----
+void AssetData::Close()
+{
+    file.Close();
+    owned.clear();
+    owned.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+}
+
+bool ReadAsset(const std::string &path, AssetData &out)
+{
+    if (AssetPack::Instance().Read(path, out))
+        return true;
+    if (!out.file.Open(path))
+        return false;
+    out.data = out.file.Data();
+    out.size = out.file.Size();
+    return true;
+}
+
+// ---- AssetPack ----
+AssetPack &AssetPack::Instance()
+{
+    static AssetPack pack;
+    return pack;
+}
+
+bool AssetPack::Mount(const std::string &packPath, const std::string &rootDir)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    file.Close();
+    entries = nullptr;
+    slots = nullptr;
+    names = nullptr;
+    stats = Stats();
+    if (!file.Open(packPath))
+        return false;
+
+    // validate the whole directory once so lookups can trust it
+    const unsigned char *base = file.Data();
+    const size_t fileSize = file.Size();
+    PackHeader h = {};
+    bool ok = fileSize >= sizeof(PackHeader);
+    if (ok)
+    {
+        std::memcpy(&h, base, sizeof(h));
+        ok = std::memcmp(h.magic, kPackMagic, sizeof(kPackMagic)) == 0 && h.version == kPackVersion &&
+             h.slotCount > h.entryCount && (h.slotCount & (h.slotCount - 1)) == 0;
+    }
+    uint64_t slotsOffset = sizeof(PackHeader) + (uint64_t)h.entryCount * sizeof(Entry);
+    uint64_t namesOffset = slotsOffset + (uint64_t)h.slotCount * sizeof(uint32_t);
+    ok = ok && h.namesSize <= fileSize && namesOffset + h.namesSize <= fileSize;
+    if (ok)
+    {
+        entries = reinterpret_cast<const Entry *>(base + sizeof(PackHeader));
+        slots = reinterpret_cast<const uint32_t *>(base + slotsOffset);
+        names = reinterpret_cast<const char *>(base + namesOffset);
+        for (uint32_t i = 0; ok && i < h.entryCount; ++i)
+        {
+            const Entry &e = entries[i];
+            ok = e.offset <= fileSize && e.storedSize <= fileSize - e.offset &&
+                 (uint64_t)e.nameOffset + e.nameLength <= h.namesSize &&
+                 (e.codec == kCodecLz || (e.codec == kCodecStore && e.storedSize == e.size));
+            stats.compressed += e.codec == kCodecLz ? 1 : 0;
+            stats.rawBytes += e.size;
+        }
+        for (uint32_t s = 0; ok && s < h.slotCount; ++s)
+            ok = slots[s] <= h.entryCount;
+    }
+    if (!ok)
+    {
+        std::cerr << "AssetPack: " << packPath << " is not a valid asset pack, using loose files\n";
+        file.Close();
+        entries = nullptr;
+        stats = Stats();
+        return false;
+    }
+    slotMask = h.slotCount - 1;
+    root = Normalize(rootDir);
+    stats.entries = h.entryCount;
+    stats.packBytes = fileSize;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    char line[200];
+    snprintf(line, sizeof(line), "AssetPack: %zu entries (%zu compressed), %.1f MB mapped in %.2f ms", stats.entries,
+             stats.compressed, stats.packBytes / (1024.0 * 1024.0), ms);
+    std::cout << line << std::endl;
+    return true;
+}
+
+const AssetPack::Entry *AssetPack::Find(const std::string &path) const
+{
+    if (!entries)
+        return nullptr;
+    std::string name = Normalize(path).lexically_relative(root).generic_string();
+    if (name.empty() || name == ".")
+        return nullptr;
+    if (anyOverridden.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(overrideMtx);
+        if (overridden.count(name))
+            return nullptr;
+    }
+    uint64_t h = HashName(name);
+    // at most one lap: a corrupt table may have no empty slot to stop at
+    uint32_t s = (uint32_t)h & slotMask;
+    for (uint64_t probes = 0; probes <= slotMask; ++probes, s = (s + 1) & slotMask)
+    {
+        uint32_t v = slots[s];
+        if (v == 0)
+            return nullptr;
+        const Entry &e = entries[v - 1];
+        if (e.nameHash == h && e.nameLength == name.size() &&
+            std::memcmp(names + e.nameOffset, name.data(), name.size()) == 0)
+            return &e;
+    }
+    return nullptr;
+}
+
+void AssetPack::Override(const std::string &path)
+{
+    if (!entries)
+        return;
+    std::string name = Normalize(path).lexically_relative(root).generic_string();
+    std::lock_guard<std::mutex> lock(overrideMtx);
+    overridden.insert(name);
+    anyOverridden.store(true, std::memory_order_release);
+}
+
+bool AssetPack::Contains(const std::string &path) const
+{
+    return Find(path) != nullptr;
+}
+
+bool AssetPack::Read(const std::string &path, AssetData &out) const
+{
+    out.Close();
+    const Entry *e = Find(path);
+    if (!e)
+        return false;
+    const unsigned char *src = file.Data() + e->offset;
+    if (e->codec == kCodecStore)
+    {
+        out.data = src;
+        out.size = (size_t)e->size;
+        return true;
+    }
+    out.owned.resize((size_t)e->size);
+    if (!LzDecompress(src, (size_t)e->storedSize, out.owned.data(), out.owned.size()))
+    {
+        std::cerr << "AssetPack: corrupt entry " << path << "\n";
+        out.Close();
+        return false;
+    }
+    out.data = out.owned.data();
+    out.size = out.owned.size();
+    return true;
+}
+
+// cooked artifacts (.smc, .btx, ...) are packed along with their sources; temp files and packs are not
+static bool SkipFile(const fs::path &p)
+{
+    std::string name = p.filename().string();
+    if (name.empty() || name[0] == '.')
+        return true;
+    std::string ext = p.extension().string();
+    return ext == ".tmp" || ext == ".pak";
+}
+
+bool AssetPack::Write(const std::string &rootDir, const std::vector<std::string> &dirs, const std::string &packPath)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    fs::path rootPath = Normalize(rootDir);
+
+    struct Source
+    {
+        std::string path;
+        std::string name;
+        std::vector<unsigned char> bytes;
+        uint64_t size = 0;
+        uint32_t codec = kCodecStore;
+        bool ok = false;
+    };
+    std::vector<Source> sources;
+    for (const auto &dir : dirs)
+    {
+        fs::path d = fs::path(dir).is_absolute() ? fs::path(dir) : rootPath / dir;
+        std::error_code ec;
+        if (!fs::is_directory(d, ec))
+        {
+            std::cerr << "AssetPack: skipping missing directory " << d.string() << "\n";
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(d, fs::directory_options::skip_permission_denied, ec), end;
+             it != end && !ec; it.increment(ec))
+        {
+            if (!it->is_regular_file(ec) || SkipFile(it->path()))
+                continue;
+            Source s;
+            fs::path p = Normalize(it->path().string());
+            s.path = p.string();
+            s.name = p.lexically_relative(rootPath).generic_string();
+            sources.push_back(std::move(s));
+        }
+    }
+    // deterministic order, and files of one directory end up next to each other
+    std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) { return a.name < b.name; });
+    sources.erase(std::unique(sources.begin(), sources.end(),
+                              [](const Source &a, const Source &b) { return a.name == b.name; }),
+                  sources.end());
+
+    // read and compress in parallel; an entry is compressed only when that saves an eighth
+    ParallelFor(sources.size(), [&](size_t i)
+                {
+                    Source &s = sources[i];
+                    MappedFile f;
+                    if (!f.Open(s.path))
+                        return; // empty or unreadable, loaders fall back to the loose file
+                    s.size = f.Size();
+                    if (s.size < UINT32_MAX)
+                        LzCompress(f.Data(), f.Size(), s.bytes);
+                    if (!s.bytes.empty() && s.bytes.size() <= s.size - s.size / 8)
+                        s.codec = kCodecLz;
+                    else
+                        s.bytes.assign(f.Data(), f.Data() + f.Size());
+                    s.ok = true;
+                });
+    sources.erase(std::remove_if(sources.begin(), sources.end(), [](const Source &s) { return !s.ok; }),
+                  sources.end());
+
+    // directory
+    PackHeader h;
+    std::memcpy(h.magic, kPackMagic, sizeof(kPackMagic));
+    h.version = kPackVersion;
+    h.entryCount = (uint32_t)sources.size();
+    h.slotCount = 1;
+    while (h.slotCount < h.entryCount * 2 + 1)
+        h.slotCount <<= 1;
+    h.reserved = 0;
+    std::string nameBlob;
+    std::vector<Entry> table(sources.size());
+    std::vector<uint32_t> slotTable(h.slotCount, 0);
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        Entry &e = table[i];
+        e.nameHash = HashName(sources[i].name);
+        e.nameOffset = (uint32_t)nameBlob.size();
+        e.nameLength = (uint32_t)sources[i].name.size();
+        e.codec = sources[i].codec;
+        e.size = sources[i].size;
+        e.storedSize = sources[i].bytes.size();
+        e.reserved = 0;
+        nameBlob += sources[i].name;
+        uint32_t s = (uint32_t)e.nameHash & (h.slotCount - 1);
+        while (slotTable[s] != 0)
+            s = (s + 1) & (h.slotCount - 1);
+        slotTable[s] = (uint32_t)i + 1;
+    }
+    h.namesSize = nameBlob.size();
+    uint64_t offset = AlignUp(sizeof(PackHeader) + table.size() * sizeof(Entry) + slotTable.size() * sizeof(uint32_t) +
+                                  nameBlob.size(),
+                              kPageSize);
+    for (auto &e : table)
+    {
+        e.offset = offset;
+        offset = AlignUp(offset + e.storedSize, kPageSize);
+    }
+
+    std::string tmpPath = packPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "AssetPack: cannot write " << packPath << "\n";
+            return false;
+        }
+        static const char zeros[kPageSize] = {};
+        uint64_t pos = 0;
+        auto put = [&](const void *p, size_t n)
+        {
+            out.write((const char *)p, (std::streamsize)n);
+            pos += n;
+        };
+        auto pad = [&]()
+        { put(zeros, (size_t)(AlignUp(pos, kPageSize) - pos)); };
+        put(&h, sizeof(h));
+        put(table.data(), table.size() * sizeof(Entry));
+        put(slotTable.data(), slotTable.size() * sizeof(uint32_t));
+        put(nameBlob.data(), nameBlob.size());
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            pad();
+            put(sources[i].bytes.data(), sources[i].bytes.size());
+        }
+        pad();
+        if (!out.good())
+        {
+            std::cerr << "AssetPack: failed writing " << packPath << "\n";
+            return false;
+        }
+    }
+    std::remove(packPath.c_str());
+    if (std::rename(tmpPath.c_str(), packPath.c_str()) != 0)
+    {
+        std::cerr << "AssetPack: cannot replace " << packPath << "\n";
+        return false;
+    }
+
+    size_t compressed = 0;
+    uint64_t raw = 0;
+    for (const auto &s : sources)
+    {
+        compressed += s.codec == kCodecLz ? 1 : 0;
+        raw += s.size;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    char line[200];
+    snprintf(line, sizeof(line), "AssetPack: packed %zu files (%zu compressed), %.1f MB -> %.1f MB in %.0f ms",
+             sources.size(), compressed, raw / (1024.0 * 1024.0), offset / (1024.0 * 1024.0), ms);
+    std::cout << line << std::endl;
+    return true;
+}
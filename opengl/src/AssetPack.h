@@ -0,0 +1,92 @@
+// src/AssetPack.h
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "MappedFile.h"
+
+// Bytes of one asset: a slice of the mounted pack, a decompressed copy of a packed entry or a
+// mapped loose file. Data() stays valid while the AssetData is alive.
+class AssetData
+{
+public:
+    AssetData() = default;
+    AssetData(const AssetData &) = delete;
+    AssetData &operator=(const AssetData &) = delete;
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char *Data() const { return data; }
+    size_t Size() const { return size; }
+    void Close();
+
+private:
+    friend class AssetPack;
+    friend bool ReadAsset(const std::string &path, AssetData &out);
+
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    MappedFile file;
+    std::vector<unsigned char> owned;
+};
+
+// Single-file archive of the shipped shaders and assets, mapped once at startup so loaders stop
+// opening and seeking dozens of loose files. Layout:
+//   header | entry table | hash slots (open addressing on the FNV-1a of the name) | names | data
+// Every entry starts on a page boundary, so uncompressed entries are handed out as pointers into
+// the mapping (and keep whatever alignment the loaders rely on). Entries that shrink by at least
+// an eighth are stored LZ-compressed and decompressed into the AssetData on read.
+// Names are paths relative to the mount root with '/' separators ("assets/models/cat.obj").
+// Mount() runs once on the main thread before any loader starts; reads are safe from any thread.
+class AssetPack
+{
+public:
+    static AssetPack &Instance();
+
+    // map packPath; files under rootDir are served from it from now on
+    bool Mount(const std::string &packPath, const std::string &rootDir);
+    bool IsMounted() const { return file.IsOpen(); }
+
+    bool Contains(const std::string &path) const;
+    // false if the pack is not mounted, does not hold path or the entry is corrupt
+    bool Read(const std::string &path, AssetData &out) const;
+    // serve path from the loose file from now on: it was edited after the pack was built (hot reload)
+    void Override(const std::string &path);
+
+    // pack every regular file under each of dirs (relative to rootDir or absolute) into packPath
+    static bool Write(const std::string &rootDir, const std::vector<std::string> &dirs, const std::string &packPath);
+
+    struct Stats
+    {
+        size_t entries = 0;
+        size_t compressed = 0;
+        uint64_t packBytes = 0;
+        uint64_t rawBytes = 0; // sum of the uncompressed entry sizes
+    };
+    const Stats &GetStats() const { return stats; }
+
+private:
+    AssetPack() = default;
+
+    struct Entry;
+    const Entry *Find(const std::string &path) const;
+
+    MappedFile file;
+    std::filesystem::path root;
+    const Entry *entries = nullptr;
+    const uint32_t *slots = nullptr;
+    uint32_t slotMask = 0;
+    const char *names = nullptr;
+    Stats stats;
+    // names dropped by Override(); readers only take the lock once there is one
+    mutable std::mutex overrideMtx;
+    std::unordered_set<std::string> overridden;
+    std::atomic<bool> anyOverridden{false};
+};
+
+// Read path from the mounted pack when it holds it, from the file on disk otherwise.
+bool ReadAsset(const std::string &path, AssetData &out);
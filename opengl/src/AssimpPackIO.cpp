@@ -0,0 +1,70 @@
+// src/AssimpPackIO.cpp
+#include "AssimpPackIO.h"
+#include "AssetPack.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Seekable view of one AssetData
+class AssetIOStream : public Assimp::IOStream
+{
+public:
+    AssetData asset;
+
+    size_t Read(void *buffer, size_t size, size_t count) override
+    {
+        if (size == 0 || count == 0)
+            return 0;
+        size_t n = std::min(count, (asset.Size() - pos) / size);
+        std::memcpy(buffer, asset.Data() + pos, n * size);
+        pos += n * size;
+        return n;
+    }
+    size_t Write(const void *, size_t, size_t) override { return 0; }
+    aiReturn Seek(size_t offset, aiOrigin origin) override
+    {
+        size_t target;
+        if (origin == aiOrigin_SET)
+            target = offset;
+        else if (origin == aiOrigin_CUR)
+            target = pos + offset;
+        else
+            target = asset.Size() + offset; // Assimp passes the wrapped negative offset for END
+        if (target > asset.Size())
+            return aiReturn_FAILURE;
+        pos = target;
+        return aiReturn_SUCCESS;
+    }
+    size_t Tell() const override { return pos; }
+    size_t FileSize() const override { return asset.Size(); }
+    void Flush() override {}
+
+private:
+    size_t pos = 0;
+};
+
+bool AssimpPackIO::Exists(const char *file) const
+{
+    if (AssetPack::Instance().Contains(file))
+        return true;
+    std::ifstream f(file, std::ios::binary);
+    return f.good();
+}
+
+Assimp::IOStream *AssimpPackIO::Open(const char *file, const char *mode)
+{
+    if (std::strchr(mode, 'w') || std::strchr(mode, 'a') || std::strchr(mode, '+'))
+        return nullptr;
+    AssetIOStream *stream = new AssetIOStream();
+    if (!ReadAsset(file, stream->asset))
+    {
+        delete stream;
+        return nullptr;
+    }
+    return stream;
+}
+
+void AssimpPackIO::Close(Assimp::IOStream *stream)
+{
+    delete stream;
+}
@@ -0,0 +1,16 @@
+// src/AssimpPackIO.h
+#pragma once
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+// Assimp file system backed by ReadAsset: the model and everything it references (.mtl, external
+// buffers) come out of the mounted AssetPack, loose files only when the pack does not hold them.
+// Read-only; opening for write fails.
+class AssimpPackIO : public Assimp::IOSystem
+{
+public:
+    bool Exists(const char *file) const override;
+    char getOsSeparator() const override { return '/'; }
+    Assimp::IOStream *Open(const char *file, const char *mode = "rb") override;
+    void Close(Assimp::IOStream *stream) override;
+};
@@ -1,4 +1,6 @@
 #include "Audio.h"
+#include "AssetIndex.h"
+#include "AssetPack.h"
 #ifdef __APPLE__
     #include <OpenAL/al.h>
     #include <OpenAL/alc.h>
@@ -9,8 +11,12 @@
 #define DR_WAV_IMPLEMENTATION
 #include "dr_wav.h" // put dr_wav.h into src/
 #include <iostream>
+#include <algorithm>
+#include <fstream>
 #include <vector>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 // Undefine Windows PlaySound macro if it exists (from windows.h)
 #ifdef PlaySound
 #undef PlaySound
@@ -40,24 +46,160 @@ void Audio::Shutdown()
 
 unsigned int Audio::LoadWAV(const std::string &path)
 {
+    WavData wav;
+    if (!DecodeWAV(path, wav))
+        return 0;
+    return CreateBuffer(wav);
+}
+
+// "<wav>.pcm": header, then interleaved int16 frames
+struct PcmHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t channels;
+    uint32_t sampleRate;
+    uint64_t frames;
+};
+static const char kPcmMagic[4] = {'P', 'C', 'M', 'C'};
+static const uint32_t kPcmVersion = 1;
+
+std::string Audio::CookedPathFor(const std::string &path)
+{
+    return path + ".pcm";
+}
+
+static bool ReadCooked(const std::string &pcmPath, const std::string &sourcePath, WavData &out)
+{
+    AssetData file;
+    if (!ReadAsset(pcmPath, file) || file.Size() < sizeof(PcmHeader))
+        return false;
+    PcmHeader h;
+    std::memcpy(&h, file.Data(), sizeof(h));
+    if (std::memcmp(h.magic, kPcmMagic, sizeof(kPcmMagic)) != 0 || h.version != kPcmVersion ||
+        h.channels == 0 || h.channels > 2 || h.frames > (file.Size() - sizeof(PcmHeader)) / (h.channels * 2))
+        return false;
+    // only hashed once the cooked file exists; the index usually has it already
+    if (h.sourceHash != AssetIndex::ContentHash(sourcePath))
+        return false;
+    out.pcm.resize((size_t)(h.frames * h.channels));
+    std::memcpy(out.pcm.data(), file.Data() + sizeof(PcmHeader), out.pcm.size() * sizeof(int16_t));
+    out.channels = h.channels;
+    out.sampleRate = h.sampleRate;
+    return true;
+}
+
+// linear interpolation between neighbouring frames
+static void Resample(WavData &wav, unsigned int rate)
+{
+    if (wav.sampleRate == rate || wav.sampleRate == 0 || wav.pcm.empty())
+        return;
+    size_t ch = wav.channels;
+    size_t inFrames = wav.pcm.size() / ch;
+    size_t outFrames = (size_t)((double)inFrames * rate / wav.sampleRate);
+    std::vector<int16_t> out(outFrames * ch);
+    double step = (double)wav.sampleRate / rate;
+    for (size_t i = 0; i < outFrames; ++i)
+    {
+        double t = i * step;
+        size_t i0 = (size_t)t;
+        size_t i1 = std::min(i0 + 1, inFrames - 1);
+        float f = (float)(t - i0);
+        for (size_t c = 0; c < ch; ++c)
+        {
+            float a = wav.pcm[i0 * ch + c];
+            float b = wav.pcm[i1 * ch + c];
+            out[i * ch + c] = (int16_t)(a + (b - a) * f);
+        }
+    }
+    wav.pcm.swap(out);
+    wav.sampleRate = rate;
+}
+
+static bool DecodeSource(const std::string &path, WavData &out)
+{
+    AssetData file;
     drwav wav;
-    if (!drwav_init_file(&wav, path.c_str(), NULL))
+    if (!ReadAsset(path, file) || !drwav_init_memory(&wav, file.Data(), file.Size(), NULL))
     {
         std::cerr << "Failed to open wav: " << path << "\n";
-        return 0;
+        return false;
     }
     size_t samples = wav.totalPCMFrameCount * wav.channels;
-    std::vector<int16_t> pcm(samples);
-    drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, pcm.data());
+    out.pcm.resize(samples);
+    drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, out.pcm.data());
+    out.channels = wav.channels;
+    out.sampleRate = wav.sampleRate;
+    drwav_uninit(&wav);
+    return true;
+}
+
+bool Audio::DecodeWAV(const std::string &path, WavData &out)
+{
+    return ReadCooked(CookedPathFor(path), path, out) || DecodeSource(path, out);
+}
+
+bool Audio::CookWAV(const std::string &path, bool &rebuilt)
+{
+    rebuilt = false;
+    std::string pcmPath = CookedPathFor(path);
+    WavData wav;
+    if (ReadCooked(pcmPath, path, wav) && wav.sampleRate == kCookedSampleRate)
+        return true;
+    uint64_t hash = AssetIndex::ContentHash(path);
+    if (hash == 0 || !DecodeSource(path, wav) || (wav.channels != 1 && wav.channels != 2))
+        return false;
+    Resample(wav, kCookedSampleRate);
+
+    PcmHeader h;
+    std::memcpy(h.magic, kPcmMagic, sizeof(kPcmMagic));
+    h.version = kPcmVersion;
+    h.sourceHash = hash;
+    h.channels = wav.channels;
+    h.sampleRate = wav.sampleRate;
+    h.frames = wav.pcm.size() / wav.channels;
+    std::string tmpPath = pcmPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "Audio: cannot write " << pcmPath << "\n";
+            return false;
+        }
+        out.write((const char *)&h, sizeof(h));
+        out.write((const char *)wav.pcm.data(), (std::streamsize)(wav.pcm.size() * sizeof(int16_t)));
+        if (!out.good())
+            return false;
+    }
+    std::remove(pcmPath.c_str());
+    if (std::rename(tmpPath.c_str(), pcmPath.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    rebuilt = true;
+    return true;
+}
+
+unsigned int Audio::CreateBuffer(const WavData &wav)
+{
+    if (wav.pcm.empty())
+        return 0;
     ALenum format = (wav.channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
 
     ALuint buf;
     alGenBuffers(1, &buf);
-    alBufferData(buf, format, pcm.data(), (ALsizei)(pcm.size() * sizeof(int16_t)), wav.sampleRate);
-    drwav_uninit(&wav);
+    alBufferData(buf, format, wav.pcm.data(), (ALsizei)(wav.pcm.size() * sizeof(int16_t)), wav.sampleRate);
     return buf;
 }
 
+void Audio::DeleteBuffer(unsigned int buffer)
+{
+    if (buffer)
+        alDeleteBuffers(1, &buffer);
+}
+
 unsigned int Audio::PlaySound(unsigned int buffer, bool loop)
 {
     if (!buffer)
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
 
 // Undefine Windows PlaySound macro if it exists (from windows.h)
 // This must be done before declaring the PlaySound function
@@ -7,12 +9,30 @@
 #undef PlaySound
 #endif
 
+// PCM samples decoded off the main thread, waiting for alBufferData
+struct WavData
+{
+    std::vector<int16_t> pcm;
+    unsigned int channels = 0;
+    unsigned int sampleRate = 0;
+};
+
 class Audio
 {
 public:
     bool Init();
     void Shutdown();
     unsigned int LoadWAV(const std::string &path); // returns buffer id
+    // LoadWAV split for parallel loading: decode on any thread, create the buffer on the main thread
+    // Uses the cooked "<path>.pcm" when it matches the source, dr_wav otherwise.
+    static bool DecodeWAV(const std::string &path, WavData &out);
+    // Offline cook for asset_bake: decode, resample to kCookedSampleRate and write "<path>.pcm"
+    // unless an up-to-date one exists (rebuilt reports which).
+    static bool CookWAV(const std::string &path, bool &rebuilt);
+    static std::string CookedPathFor(const std::string &path);
+    static const unsigned int kCookedSampleRate = 44100;
+    unsigned int CreateBuffer(const WavData &wav); // returns buffer id
+    void DeleteBuffer(unsigned int buffer);
     unsigned int PlaySound(unsigned int buffer, bool loop = false);
     void Stop(unsigned int source);
 };
@@ -0,0 +1,334 @@
+// src/BlockCompress.cpp
+#include "BlockCompress.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+size_t BlockBytes(BlockFormat fmt)
+{
+    switch (fmt)
+    {
+    case BlockFormat::BC1:
+        return 8;
+    case BlockFormat::BC3:
+    case BlockFormat::BC7:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+size_t CompressedLevelSize(BlockFormat fmt, int width, int height)
+{
+    if (fmt == BlockFormat::None)
+        return (size_t)width * height * 4;
+    size_t bx = (size_t)std::max(1, (width + 3) / 4);
+    size_t by = (size_t)std::max(1, (height + 3) / 4);
+    return bx * by * BlockBytes(fmt);
+}
+
+// Endpoints along the principal axis of the block's colours (first `channels` components).
+static void FitEndpoints(const unsigned char px[16][4], int channels, float lo[4], float hi[4])
+{
+    float mean[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < channels; ++c)
+            mean[c] += px[i][c] / 16.0f;
+
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        float d[4];
+        for (int c = 0; c < channels; ++c)
+            d[c] = px[i][c] - mean[c];
+        for (int a = 0; a < channels; ++a)
+            for (int b = 0; b < channels; ++b)
+                cov[a][b] += d[a] * d[b];
+    }
+
+    // power iteration, a few steps are plenty for a 16 texel block
+    float axis[4] = {1, 1, 1, 1};
+    for (int it = 0; it < 8; ++it)
+    {
+        float next[4] = {0, 0, 0, 0};
+        for (int a = 0; a < channels; ++a)
+            for (int b = 0; b < channels; ++b)
+                next[a] += cov[a][b] * axis[b];
+        float len = 0.0f;
+        for (int c = 0; c < channels; ++c)
+            len += next[c] * next[c];
+        if (len < 1e-8f)
+            break; // flat block
+        len = std::sqrt(len);
+        for (int c = 0; c < channels; ++c)
+            axis[c] = next[c] / len;
+    }
+
+    float tmin = 0.0f, tmax = 0.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < channels; ++c)
+            t += (px[i][c] - mean[c]) * axis[c];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+    }
+    for (int c = 0; c < channels; ++c)
+    {
+        lo[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmin));
+        hi[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmax));
+    }
+}
+
+static uint16_t To565(const float c[3])
+{
+    int r = (int)(c[0] * 31.0f / 255.0f + 0.5f);
+    int g = (int)(c[1] * 63.0f / 255.0f + 0.5f);
+    int b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void From565(uint16_t v, int out[3])
+{
+    int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+static void PutLE16(unsigned char *dst, uint16_t v)
+{
+    dst[0] = (unsigned char)(v & 0xff);
+    dst[1] = (unsigned char)(v >> 8);
+}
+
+// 8 byte BC1 colour block, always in 4-colour mode (also used as the colour half of BC3)
+static void EncodeColorBlock(const unsigned char px[16][4], unsigned char *dst)
+{
+    float lo[4], hi[4];
+    FitEndpoints(px, 3, lo, hi);
+    uint16_t c0 = To565(hi), c1 = To565(lo);
+    if (c0 < c1)
+        std::swap(c0, c1);
+    PutLE16(dst, c0);
+    PutLE16(dst + 2, c1);
+    std::memset(dst + 4, 0, 4);
+    if (c0 == c1)
+        return; // solid block, every index selects c0
+
+    int pal[4][3];
+    From565(c0, pal[0]);
+    From565(c1, pal[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+        pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestErr = 1 << 30;
+        for (int k = 0; k < 4; ++k)
+        {
+            int err = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                int d = px[i][c] - pal[k][c];
+                err += d * d;
+            }
+            if (err < bestErr)
+            {
+                bestErr = err;
+                best = k;
+            }
+        }
+        indices |= (uint32_t)best << (2 * i);
+    }
+    for (int b = 0; b < 4; ++b)
+        dst[4 + b] = (unsigned char)(indices >> (8 * b));
+}
+
+// 8 byte BC3 alpha block, 8-value mode (a0 > a1)
+static void EncodeAlphaBlock(const unsigned char px[16][4], unsigned char *dst)
+{
+    int amin = 255, amax = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        amin = std::min(amin, (int)px[i][3]);
+        amax = std::max(amax, (int)px[i][3]);
+    }
+    dst[0] = (unsigned char)amax;
+    dst[1] = (unsigned char)amin;
+    std::memset(dst + 2, 0, 6);
+    if (amax == amin)
+        return;
+
+    int pal[8];
+    pal[0] = amax;
+    pal[1] = amin;
+    for (int k = 2; k < 8; ++k)
+        pal[k] = ((8 - k) * amax + (k - 1) * amin) / 7;
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestErr = 1 << 30;
+        for (int k = 0; k < 8; ++k)
+        {
+            int err = std::abs(px[i][3] - pal[k]);
+            if (err < bestErr)
+            {
+                bestErr = err;
+                best = k;
+            }
+        }
+        indices |= (uint64_t)best << (3 * i);
+    }
+    for (int b = 0; b < 6; ++b)
+        dst[2 + b] = (unsigned char)(indices >> (8 * b));
+}
+
+// BC7 fields are packed LSB first across the 16 byte block
+static void PutBits(unsigned char *dst, int &pos, uint32_t value, int count)
+{
+    for (int i = 0; i < count; ++i, ++pos)
+    {
+        if (value & (1u << i))
+            dst[pos >> 3] |= (unsigned char)(1u << (pos & 7));
+    }
+}
+
+// BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints with a unique p-bit each, 4-bit indices
+static void EncodeBC7Block(const unsigned char px[16][4], unsigned char *dst)
+{
+    static const int kWeights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float ends[2][4];
+    FitEndpoints(px, 4, ends[0], ends[1]);
+
+    // quantize to 7 bits + p-bit, keeping whichever p-bit lands closer
+    int q[2][4], pbit[2], e[2][4];
+    for (int k = 0; k < 2; ++k)
+    {
+        float bestErr = 1e30f;
+        for (int p = 0; p < 2; ++p)
+        {
+            int tq[4];
+            float err = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                tq[c] = std::min(127, std::max(0, (int)((ends[k][c] - p) / 2.0f + 0.5f)));
+                float d = (float)((tq[c] << 1) | p) - ends[k][c];
+                err += d * d;
+            }
+            if (err < bestErr)
+            {
+                bestErr = err;
+                pbit[k] = p;
+                std::memcpy(q[k], tq, sizeof(tq));
+            }
+        }
+        for (int c = 0; c < 4; ++c)
+            e[k][c] = (q[k][c] << 1) | pbit[k];
+    }
+
+    int pal[16][4];
+    for (int w = 0; w < 16; ++w)
+        for (int c = 0; c < 4; ++c)
+            pal[w][c] = ((64 - kWeights[w]) * e[0][c] + kWeights[w] * e[1][c] + 32) >> 6;
+
+    int idx[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestErr = 1 << 30;
+        for (int w = 0; w < 16; ++w)
+        {
+            int err = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                int d = px[i][c] - pal[w][c];
+                err += d * d;
+            }
+            if (err < bestErr)
+            {
+                bestErr = err;
+                best = w;
+            }
+        }
+        idx[i] = best;
+    }
+
+    // the anchor (first) index is stored with 3 bits, so its top bit must be 0
+    if (idx[0] & 8)
+    {
+        std::swap(q[0], q[1]);
+        std::swap(pbit[0], pbit[1]);
+        for (int i = 0; i < 16; ++i)
+            idx[i] = 15 - idx[i];
+    }
+
+    std::memset(dst, 0, 16);
+    int pos = 0;
+    PutBits(dst, pos, 1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; ++c)
+    {
+        PutBits(dst, pos, (uint32_t)q[0][c], 7);
+        PutBits(dst, pos, (uint32_t)q[1][c], 7);
+    }
+    PutBits(dst, pos, (uint32_t)pbit[0], 1);
+    PutBits(dst, pos, (uint32_t)pbit[1], 1);
+    PutBits(dst, pos, (uint32_t)idx[0], 3);
+    for (int i = 1; i < 16; ++i)
+        PutBits(dst, pos, (uint32_t)idx[i], 4);
+}
+
+void CompressImage(BlockFormat fmt, const unsigned char *rgba, int width, int height, std::vector<unsigned char> &out)
+{
+    if (fmt == BlockFormat::None)
+    {
+        out.insert(out.end(), rgba, rgba + (size_t)width * height * 4);
+        return;
+    }
+    size_t blockBytes = BlockBytes(fmt);
+    if (blockBytes == 0)
+        return;
+    int blocksX = std::max(1, (width + 3) / 4);
+    int blocksY = std::max(1, (height + 3) / 4);
+    size_t base = out.size();
+    out.resize(base + (size_t)blocksX * blocksY * blockBytes);
+    unsigned char *dst = out.data() + base;
+
+    unsigned char px[16][4];
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            for (int y = 0; y < 4; ++y)
+            {
+                int sy = std::min(by * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x)
+                {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(px[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+                }
+            }
+            switch (fmt)
+            {
+            case BlockFormat::BC1:
+                EncodeColorBlock(px, dst);
+                break;
+            case BlockFormat::BC3:
+                EncodeAlphaBlock(px, dst);
+                EncodeColorBlock(px, dst + 8);
+                break;
+            case BlockFormat::BC7:
+                EncodeBC7Block(px, dst);
+                break;
+            default:
+                break;
+            }
+            dst += blockBytes;
+        }
+    }
+}
@@ -0,0 +1,23 @@
+// src/BlockCompress.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class BlockFormat : uint32_t
+{
+    None = 0, // uncompressed RGBA8 (what drivers without S3TC/BPTC get)
+    BC1 = 1,  // 8 bytes per 4x4 block, RGB (S3TC DXT1)
+    BC3 = 3,  // 16 bytes per 4x4 block, RGB + interpolated alpha (S3TC DXT5)
+    BC7 = 7   // 16 bytes per 4x4 block, RGBA (BPTC), mode 6 only
+};
+
+// bytes per 4x4 block, 0 for BlockFormat::None
+size_t BlockBytes(BlockFormat fmt);
+// size of one compressed level; partial blocks at the edges count as whole blocks.
+// None: width * height * 4
+size_t CompressedLevelSize(BlockFormat fmt, int width, int height);
+
+// Encode an RGBA8 image (tightly packed, width*height*4 bytes). Edge blocks are padded by
+// repeating the last row/column. Output is appended to out; None appends the pixels as they are.
+void CompressImage(BlockFormat fmt, const unsigned char *rgba, int width, int height, std::vector<unsigned char> &out);
@@ -0,0 +1,289 @@
+// src/CompressedTexture.cpp
+#include "CompressedTexture.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// not part of the core 3.3 glad profile
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+static const char kMagic[8] = {'B', 'T', 'E', 'X', 'C', 'H', 'N', '\0'};
+// 2: linear-light mips with coverage preservation (MipChain), RGBA8 chains
+static const uint32_t kVersion = 2;
+static const uint32_t kMaxLevels = 32;
+
+struct BtxHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+    uint64_t sourceHash;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t hasAlpha;
+    uint32_t srgb;
+    float alphaCutoff; // 0 unless the chain preserves alpha-test coverage
+};
+
+struct BtxLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset; // from the start of the file, 16-byte aligned
+    uint64_t size;
+};
+
+static bool KnownFormat(BlockFormat fmt)
+{
+    return fmt == BlockFormat::None || BlockBytes(fmt) != 0;
+}
+
+std::string CompressedTexture::PathFor(const std::string &imagePath)
+{
+    return imagePath + ".btx";
+}
+
+uint64_t CompressedTexture::HashSource(const std::string &imagePath)
+{
+    AssetData src;
+    if (!ReadAsset(imagePath, src))
+        return 0;
+    return HashBytes(src.Data(), src.Size());
+}
+
+uint64_t CompressedTexture::HashBytes(const unsigned char *data, size_t size)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool CompressedTexture::Bake(const std::string &outPath, uint64_t sourceHash, BlockFormat fmt,
+                             const unsigned char *rgba, int width, int height, bool hasAlpha, const MipSettings &mips)
+{
+    if (!KnownFormat(fmt) || !rgba || width <= 0 || height <= 0)
+        return false;
+
+    MipChain chain;
+    BuildMipChain(rgba, width, height, hasAlpha, mips, chain);
+
+    // encode every level into one blob; the level table records where each one starts
+    std::vector<BtxLevel> table;
+    std::vector<unsigned char> blob;
+    for (size_t l = 0; l < chain.levels.size() && l < kMaxLevels; ++l)
+    {
+        while (blob.size() % 16)
+            blob.push_back(0);
+        BtxLevel lv;
+        lv.width = (uint32_t)chain.levels[l].width;
+        lv.height = (uint32_t)chain.levels[l].height;
+        lv.offset = blob.size();
+        CompressImage(fmt, chain.Data(l), chain.levels[l].width, chain.levels[l].height, blob);
+        lv.size = blob.size() - lv.offset;
+        table.push_back(lv);
+    }
+
+    BtxHeader hdr;
+    std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+    hdr.version = kVersion;
+    hdr.format = (uint32_t)fmt;
+    hdr.sourceHash = sourceHash;
+    hdr.width = (uint32_t)width;
+    hdr.height = (uint32_t)height;
+    hdr.levelCount = (uint32_t)table.size();
+    hdr.hasAlpha = hasAlpha ? 1u : 0u;
+    hdr.srgb = mips.srgb ? 1u : 0u;
+    hdr.alphaCutoff = hasAlpha ? mips.alphaCutoff : 0.0f;
+
+    size_t dataStart = sizeof(BtxHeader) + table.size() * sizeof(BtxLevel);
+    dataStart = (dataStart + 15) & ~(size_t)15;
+    for (auto &lv : table)
+        lv.offset += dataStart;
+
+    std::string tmpPath = outPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "CompressedTexture: cannot write " << outPath << "\n";
+            return false;
+        }
+        out.write((const char *)&hdr, sizeof(hdr));
+        out.write((const char *)table.data(), (std::streamsize)(table.size() * sizeof(BtxLevel)));
+        static const char pad[16] = {};
+        size_t written = sizeof(BtxHeader) + table.size() * sizeof(BtxLevel);
+        out.write(pad, (std::streamsize)(dataStart - written));
+        out.write((const char *)blob.data(), (std::streamsize)blob.size());
+        if (!out.good())
+        {
+            std::cerr << "CompressedTexture: write failed " << outPath << "\n";
+            return false;
+        }
+    }
+    std::remove(outPath.c_str());
+    if (std::rename(tmpPath.c_str(), outPath.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    AssetPack::Instance().Override(outPath); // rewritten after the pack was built (hot reload)
+    return true;
+}
+
+bool CompressedTexture::Open(const std::string &path, uint64_t sourceHash, const MipSettings &mips)
+{
+    Close();
+    if (!ReadAsset(path, file))
+        return false;
+
+    auto fail = [this]()
+    {
+        Close();
+        return false;
+    };
+
+    if (file.Size() < sizeof(BtxHeader))
+        return fail();
+    BtxHeader hdr;
+    std::memcpy(&hdr, file.Data(), sizeof(hdr));
+    if (std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) != 0 || hdr.version != kVersion ||
+        hdr.sourceHash != sourceHash || hdr.levelCount == 0 || hdr.levelCount > kMaxLevels)
+        return fail();
+    // opaque images ignore the cutoff, so every material using them shares one file
+    if (hdr.srgb != (mips.srgb ? 1u : 0u) || (hdr.hasAlpha && hdr.alphaCutoff != mips.alphaCutoff))
+        return fail();
+    BlockFormat fmt = (BlockFormat)hdr.format;
+    if (!KnownFormat(fmt))
+        return fail();
+    if (file.Size() < sizeof(BtxHeader) + hdr.levelCount * sizeof(BtxLevel))
+        return fail();
+
+    const BtxLevel *table = reinterpret_cast<const BtxLevel *>(file.Data() + sizeof(BtxHeader));
+    for (uint32_t i = 0; i < hdr.levelCount; ++i)
+    {
+        BtxLevel lv;
+        std::memcpy(&lv, table + i, sizeof(lv));
+        if (lv.size != CompressedLevelSize(fmt, (int)lv.width, (int)lv.height) ||
+            lv.offset > file.Size() || lv.size > file.Size() - lv.offset)
+            return fail();
+        Level out;
+        out.width = (int)lv.width;
+        out.height = (int)lv.height;
+        out.data = file.Data() + lv.offset;
+        out.size = (size_t)lv.size;
+        levels.push_back(out);
+    }
+    format = fmt;
+    hasAlpha = hdr.hasAlpha != 0;
+    return true;
+}
+
+void CompressedTexture::Close()
+{
+    file.Close();
+    levels.clear();
+    format = BlockFormat::None;
+    hasAlpha = false;
+}
+
+size_t CompressedTexture::TotalBytes(size_t firstLevel) const
+{
+    size_t total = 0;
+    for (size_t i = firstLevel; i < levels.size(); ++i)
+        total += levels[i].size;
+    return total;
+}
+
+size_t CompressedTexture::LevelForSize(int maxSize) const
+{
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        if (levels[i].width <= maxSize && levels[i].height <= maxSize)
+            return i;
+    }
+    return levels.empty() ? 0 : levels.size() - 1;
+}
+
+GLenum CompressedTexture::GLFormat(BlockFormat fmt, bool srgb)
+{
+    switch (fmt)
+    {
+    case BlockFormat::None:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    case BlockFormat::BC1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC7:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        return 0;
+    }
+}
+
+bool CompressedTexture::UploadLevels(size_t first, size_t end, bool srgb) const
+{
+    end = std::min(end, levels.size());
+    GLenum internalFormat = GLFormat(format, srgb);
+    // clear stale errors so the check below only sees this upload
+    while (glGetError() != GL_NO_ERROR)
+        ;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = first; i < end; ++i)
+    {
+        const Level &lv = levels[i];
+        if (format == BlockFormat::None)
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)internalFormat, lv.width, lv.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, lv.data);
+        else
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, lv.width, lv.height, 0,
+                                   (GLsizei)lv.size, lv.data);
+    }
+    return glGetError() == GL_NO_ERROR;
+}
+
+GLuint CompressedTexture::Upload(bool srgb, size_t firstLevel, GLuint tex) const
+{
+    if (firstLevel >= levels.size())
+        return 0;
+    bool created = tex == 0;
+    if (created)
+        glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    // a respecified texture may hold finer levels (or a placeholder at level 0): release them
+    for (size_t i = 0; i < firstLevel && !created; ++i)
+        glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)GLFormat(format, srgb), 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     nullptr);
+    bool ok = UploadLevels(firstLevel, levels.size(), srgb);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)firstLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (!ok)
+    {
+        std::cerr << "CompressedTexture: upload rejected by the driver\n";
+        if (created)
+            glDeleteTextures(1, &tex);
+        return 0;
+    }
+    return tex;
+}
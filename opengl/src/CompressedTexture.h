@@ -0,0 +1,63 @@
+// src/CompressedTexture.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "BlockCompress.h"
+#include "AssetPack.h"
+#include "MipChain.h"
+
+// Baked texture stored next to the source image as "<image>.btx": a block-compressed
+// (BC1/BC3/BC7, or plain RGBA8 for drivers without either) mip chain down to 1x1 built by
+// BuildMipChain, keyed by a hash of the source file and the mip settings. Levels are uploaded
+// straight from the mapped file, so no image decoding or mip generation happens at load time.
+class CompressedTexture
+{
+public:
+    struct Level
+    {
+        int width = 0;
+        int height = 0;
+        const unsigned char *data = nullptr;
+        size_t size = 0;
+    };
+
+    static std::string PathFor(const std::string &imagePath);
+    // FNV-1a over the source image, 0 if unreadable
+    static uint64_t HashSource(const std::string &imagePath);
+    // same hash over an encoded image held in memory (e.g. embedded in a GLB)
+    static uint64_t HashBytes(const unsigned char *data, size_t size);
+    // Build the full mip chain from an RGBA8 image and write it (via a temp file)
+    static bool Bake(const std::string &outPath, uint64_t sourceHash, BlockFormat fmt,
+                     const unsigned char *rgba, int width, int height, bool hasAlpha, const MipSettings &mips);
+
+    // Returns false on a missing/corrupt file or if the source hash or mip settings do not match
+    bool Open(const std::string &path, uint64_t sourceHash, const MipSettings &mips);
+    void Close();
+    bool IsOpen() const { return file.IsOpen(); }
+
+    BlockFormat Format() const { return format; }
+    bool HasAlpha() const { return hasAlpha; }
+    const std::vector<Level> &Levels() const { return levels; }
+    // bytes of levels [firstLevel, end)
+    size_t TotalBytes(size_t firstLevel = 0) const;
+    // first level no larger than maxSize in either dimension (the last one if none is)
+    size_t LevelForSize(int maxSize) const;
+
+    // GL thread: upload levels [firstLevel, end) at their own level numbers with
+    // GL_TEXTURE_BASE_LEVEL = firstLevel, into a new texture or, when tex is not 0, respecifying
+    // tex in place (same name; finer levels it held are released). Returns the texture, 0 on
+    // failure; a failed respecify leaves tex for the caller to keep or delete.
+    GLuint Upload(bool srgb, size_t firstLevel = 0, GLuint tex = 0) const;
+    // GL thread: specify levels [first, end) of the bound GL_TEXTURE_2D (partial residency
+    // changes; the caller moves the base level). false if the driver rejected them.
+    bool UploadLevels(size_t first, size_t end, bool srgb) const;
+    static GLenum GLFormat(BlockFormat fmt, bool srgb);
+
+private:
+    AssetData file;
+    BlockFormat format = BlockFormat::None;
+    bool hasAlpha = false;
+    std::vector<Level> levels;
+};
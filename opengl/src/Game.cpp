@@ -1,7 +1,10 @@
 #include "Game.h"
+#include "AssetLoader.h"
+#include "SharedUniforms.h"
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glad/glad.h>
+#include <cstddef>
 #include <cstdlib>
 #include <algorithm>
 #include <iostream>
@@ -162,44 +165,57 @@ Game::Game()
 }
 bool Game::LoadResources(const std::string &assetsDir)
 {
+    AssetLoader loader;
+    QueueResources(loader, assetsDir);
+    return loader.Finish();
+}
+
+StaticModel &Game::Model(ResourceHandle h)
+{
+    static StaticModel missing;
+    StaticModel *m = ResourceManager::Instance().GetModel(h);
+    return m ? *m : missing;
+}
+
+void Game::QueueResources(AssetLoader &loader, const std::string &assetsDir)
+{
+    ResourceManager &resources = ResourceManager::Instance();
     FallingObjectConfig fallingModelsConfig[3] = {
         {assetsDir + "/models/bucket.obj", glm::vec3(0.2f)},
         {assetsDir + "/models/jar.obj", glm::vec3(0.2f)},
         {assetsDir + "/models/teapot.obj", glm::vec3(1.0f)}};
-    bool ok = true;
+    // only registered: a prototype is loaded when SpawnObject first picks it
     for (int i = 0; i < 3; ++i)
-    {
-        fallingModels[i].modelScale = fallingModelsConfig[i].modelScale;
-        ok &= fallingModels[i].LoadFromFile(fallingModelsConfig[i].path);
-        if (!ok)
-        {
-            std::cerr << "Failed load falling objects: " << fallingModelsConfig[i].path << std::endl;
-        }
-    }
-    std::string floorPath = assetsDir + "/models/floor.obj";
-    ok &= floorModel.LoadFromFile(floorPath);
-    if (!ok)
-    {
-        std::cerr << "Failed load floor: " << floorPath << std::endl;
-    }
+        fallingHandles[i] = resources.AddModel(fallingModelsConfig[i].path, VertexFormat::Packed,
+                                               fallingModelsConfig[i].modelScale);
 
     // set reasonable scales if model units differ
-    floorModel.modelScale = glm::vec3(1.0f);
-
-    // compute floorTop from floorModel bbox (world-local bbox)
-    // bboxMin/bboxMax are in model space (apply modelScale when mapping to world)
-    float floorModelTop = floorModel.bboxMax.y * floorModel.modelScale.y;
-    // If your floor model's origin is center and it's placed with translate y = -0.55,
-    // you can compute desired world top. For simplicity, we'll set floorTop to where you want:
-    // For example place floorModel so its top is at -0.5:
-    float desiredTopY = -0.5f;
-    // compute needed base translate and store somewhere or apply in Render.
+    floorHandle = resources.AddModel(assetsDir + "/models/floor.obj", VertexFormat::Float, glm::vec3(1.0f));
+    resources.SetPinned(floorHandle, true);
+    resources.Queue(loader, floorHandle);
+
+    // floorModel bbox is only known after the upload; Reset() derives the floor placement from it.
     // We'll simply store floorTop for collision calculations:
+    float desiredTopY = -0.5f;
     floorTop = desiredTopY;
-    // LoadCatParts(assetsDir);
+}
+
+void Game::QueuePlayerModel(AssetLoader &loader, const std::string &path)
+{
+    // 可选：设置默认缩放来匹配原来 cube 大小
+    playerHandle = ResourceManager::Instance().AddModel(path, VertexFormat::Packed, glm::vec3(0.6f));
+    ResourceManager::Instance().SetPinned(playerHandle, true);
+    ResourceManager::Instance().Queue(loader, playerHandle);
+}
 
-    return ok;
+void Game::LoadPlayerModel(const std::string &path)
+{
+    AssetLoader loader;
+    QueuePlayerModel(loader, path);
+    if (!loader.Finish())
+        std::cerr << "Failed to load player model: " << path << std::endl;
 }
+
 void Game::InitShadowMap()
 {
     // ===== Shadow map framebuffer =====
@@ -228,10 +244,57 @@ void Game::InitShadowMap()
     glReadBuffer(GL_NONE);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
+void Game::InitCollectibles()
+{
+    // unit cube, 36 vertices with face normals: each face from its normal n and two in-plane axes
+    // with u x v = n, so the triangles wind counter-clockwise seen from outside
+    glm::vec3 cube[36 * 2];
+    const glm::vec3 faceNormals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    const float corners[6][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, -1}, {1, 1}, {-1, 1}};
+    for (int f = 0; f < 6; ++f)
+    {
+        glm::vec3 n = faceNormals[f];
+        glm::vec3 u(n.y, n.z, n.x);
+        glm::vec3 v = glm::cross(n, u);
+        for (int k = 0; k < 6; ++k)
+        {
+            cube[(f * 6 + k) * 2] = 0.5f * (n + corners[k][0] * u + corners[k][1] * v);
+            cube[(f * 6 + k) * 2 + 1] = n;
+        }
+    }
+
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &cubeVBO);
+    glGenBuffers(1, &collectibleVBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *)sizeof(glm::vec3));
+
+    // per instance: Collectible as two vec4s (position + spawn time, color + lifetime)
+    static_assert(sizeof(Collectible) == 8 * sizeof(float) && offsetof(Collectible, color) == 4 * sizeof(float),
+                  "Collectible must be two packed vec4s");
+    glBindBuffer(GL_ARRAY_BUFFER, collectibleVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Collectible), (void *)offsetof(Collectible, pos));
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Collectible), (void *)offsetof(Collectible, color));
+    glVertexAttribDivisor(4, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    collectibleCapacity = 0;
+    collectiblesDirty = true;
+}
+
 void Game::Reset()
 {
     falling.clear();
     collectibles.clear();
+    collectiblesDirty = true;
     spawnTimer = 0.0f;
     collectSpawnTimer = 2.0f; // first collectible spawn delay
     score = 0;
@@ -251,6 +314,7 @@ void Game::Reset()
     hitEffectTimer = 0.0f;
 
     // after loading floorModel and setting floorModel.modelScale
+    StaticModel &floorModel = Model(floorHandle);
     float desiredFloorTop = -0.5f; // 你希望地面顶面的 world Y
     float floorTopLocal = floorModel.bboxMax.y * floorModel.modelScale.y;
     float floorYOffset = desiredFloorTop - floorTopLocal;
@@ -278,6 +342,7 @@ static glm::vec3 RandomColor(std::mt19937 &rng)
 void Game::SpawnObject()
 {
     Falling f;
+    StaticModel &floorModel = Model(floorHandle);
 
     // --------- 1) compute floor world bounds (min/max on X,Z) robustly by transforming bbox corners ----------
     float floorMinX, floorMaxX, floorMinZ, floorMaxZ;
@@ -335,12 +400,27 @@ void Game::SpawnObject()
     // std::cout << "[Spawn] floorX=[" << floorMinX << "," << floorMaxX << "] floorZ=[" << floorMinZ << "," << floorMaxZ << "]\n";
 
     // --------- 2) pick prototype index first so we can compute its horizontal footprint ----------
+    // the first pick of a prototype starts loading it; until it is resident another resident one
+    // stands in, and with none resident yet this spawn is skipped
+    ResourceManager &resources = ResourceManager::Instance();
     f.modelIndex = rng() % 3;
-    f.modelScale = fallingModels[f.modelIndex].modelScale;
+    StaticModel *proto = resources.GetModel(fallingHandles[f.modelIndex]);
+    for (int k = 1; k < 3 && !proto; ++k)
+    {
+        int other = (f.modelIndex + k) % 3;
+        if (resources.State(fallingHandles[other]) == ResourceState::Resident)
+        {
+            f.modelIndex = other;
+            proto = resources.GetModel(fallingHandles[other]);
+        }
+    }
+    if (!proto)
+        return;
+    f.modelScale = proto->modelScale;
 
     // get prototype bbox local corners
-    glm::vec3 pmin = fallingModels[f.modelIndex].bboxMin;
-    glm::vec3 pmax = fallingModels[f.modelIndex].bboxMax;
+    glm::vec3 pmin = proto->bboxMin;
+    glm::vec3 pmax = proto->bboxMax;
 
     glm::vec3 protoCorners[8];
     int pidx = 0;
@@ -411,6 +491,7 @@ void Game::SpawnObject()
     f.rotSpeed = 0.0f;
 
     f.alive = true;
+    f.color = glm::vec3(1.0f); // untinted
 
     // store halfExtents for AABB quick test (consistent with computed halfX/halfZ)
     f.halfExtents = glm::vec3(halfX, (pmax.y - pmin.y) * 0.5f * f.modelScale.y + safety, halfZ);
@@ -436,12 +517,13 @@ static Collectible MakeCollectible(std::mt19937 &rng, float floorTop)
     float cubeHalf = 0.2f;
     c.pos.y = floorTop + cubeHalf;
     c.color = RandomColor(rng);
+    c.spawnTime = (float)glfwGetTime();
     c.lifetime = randf(rng, 6.0f, 10.0f); // 生存时间 6-10 秒
-    c.alive = true;
     return c;
 }
 void Game::Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront, const glm::vec3 &cameraUp)
 {
+    StaticModel &playerModel = Model(playerHandle);
     if (playerDead)
         return;
 
@@ -498,32 +580,34 @@ void Game::Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront,
     {
         collectSpawnTimer = randf(rng, 3.0f, 6.0f); // 间隔 3-6 秒生成一个
         collectibles.push_back(MakeCollectible(rng, floorTop));
+        collectiblesDirty = true;
     }
 
+    // nothing is ticked per frame: a collectible has expired once the clock passes its lifetime
+    // (collectible.vs hides it), and the list is compacted only when it is rewritten anyway
     const float pickupRadius = 0.6f;
-    for (auto &c : collectibles)
+    float now = (float)glfwGetTime();
+    auto expired = [&](const Collectible &c)
+    { return now - c.spawnTime >= c.lifetime; };
+    auto pickedUp = [&](const Collectible &c)
     {
-        if (!c.alive)
-            continue;
-        c.lifetime -= dt;
-        if (c.lifetime <= 0.0f)
-        {
-            c.alive = false;
-            continue;
-        }
         // 拾取判定只看 XZ 平面距离（方块在地面上，玩家 Y 高度不同，用 3D 距离会导致永远碰不到）
         glm::vec2 dXZ(c.pos.x - player.pos.x, c.pos.z - player.pos.z);
-        float distXZ = glm::length(dXZ);
-        if (distXZ <= pickupRadius)
+        return !expired(c) && glm::length(dXZ) <= pickupRadius;
+    };
+    for (const auto &c : collectibles)
+    {
+        if (pickedUp(c))
         {
-            c.alive = false;
             score += 10;
+            collectiblesDirty = true;
         }
     }
-    collectibles.erase(std::remove_if(collectibles.begin(), collectibles.end(),
-                                      [](const Collectible &c)
-                                      { return !c.alive; }),
-                       collectibles.end());
+    if (collectiblesDirty)
+        collectibles.erase(std::remove_if(collectibles.begin(), collectibles.end(),
+                                          [&](const Collectible &c)
+                                          { return expired(c) || pickedUp(c); }),
+                           collectibles.end());
 
     // 更新玩家 modelMatrix（把猫脚底对齐地面）
     {
@@ -565,7 +649,8 @@ void Game::Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront,
         auto &o = falling[i];
         // build modelMatrix if you expect it prebuilt:
         glm::mat4 mm = o.modelMatrix;
-        glm::vec4 center = mm * glm::vec4((fallingModels[o.modelIndex].bboxMin + fallingModels[o.modelIndex].bboxMax) * 0.5f, 1.0f);
+        StaticModel &proto = Model(fallingHandles[o.modelIndex]);
+        glm::vec4 center = mm * glm::vec4((proto.bboxMin + proto.bboxMax) * 0.5f, 1.0f);
     }
 
     for (auto &o : falling)
@@ -589,8 +674,9 @@ void Game::Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront,
         }
 
         // 3) build object OBB from proto bbox and the up-to-date modelMatrix
-        const glm::vec3 &pbMin = fallingModels[o.modelIndex].bboxMin;
-        const glm::vec3 &pbMax = fallingModels[o.modelIndex].bboxMax;
+        StaticModel &proto = Model(fallingHandles[o.modelIndex]);
+        const glm::vec3 &pbMin = proto.bboxMin;
+        const glm::vec3 &pbMax = proto.bboxMax;
         OBB objOBB = BuildOBBFromModel(pbMin, pbMax, o.modelMatrix);
 
         // (optional) update instance halfExtents from OBB for consistent later use
@@ -666,8 +752,87 @@ void Game::Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront,
     player.prevPos = player.pos;
 }
 
-void Game::Render(unsigned int shader3D, float dt, const glm::vec3 &cameraPos)
+// largest simplification error a LOD may show on screen, in pixels; shadows get a coarser bias
+// since the shadow map blurs away what the extra triangles would add
+static const float kLodTolerancePx = 1.0f;
+static const float kShadowLodTolerancePx = 4.0f;
+
+static void UpdateLod(const StaticModel &model, const glm::mat4 &m, const glm::vec3 &cameraPos, float projScale,
+                      LodState &lod)
+{
+    lod.view = model.SelectLod(m, cameraPos, projScale, kLodTolerancePx, lod.view);
+    lod.shadow = std::max(lod.view, model.SelectLod(m, cameraPos, projScale, kShadowLodTolerancePx, lod.shadow));
+}
+
+void Game::SetProjection(float fovyRadians, int viewportHeight)
+{
+    lodProjScale = (float)viewportHeight / (2.0f * std::tan(fovyRadians * 0.5f));
+}
+
+void Game::BuildFallingBatches(const glm::vec3 &cameraPos)
 {
+    // counting sort by (prototype, level): the order inside a group does not matter
+    const int kPrototypes = 3;
+    auto build = [&](bool shadow, std::vector<InstanceBatch> &batches)
+    {
+        size_t counts[kPrototypes][kMaxMeshLods] = {};
+        auto lodOf = [&](const Falling &o)
+        { return std::min((uint32_t)std::max(shadow ? o.lod.shadow : o.lod.view, 0), kMaxMeshLods - 1); };
+        for (const auto &o : falling)
+            if (o.alive)
+                counts[o.modelIndex][lodOf(o)]++;
+
+        size_t next[kPrototypes][kMaxMeshLods];
+        batches.clear();
+        for (int p = 0; p < kPrototypes; ++p)
+            for (uint32_t l = 0; l < kMaxMeshLods; ++l)
+            {
+                next[p][l] = instanceData.size();
+                if (counts[p][l])
+                    batches.push_back(InstanceBatch{p, (int)l, instanceData.size(), (GLsizei)counts[p][l], RenderQueue::kMaxDepth});
+                instanceData.resize(instanceData.size() + counts[p][l]);
+            }
+        for (const auto &o : falling)
+            if (o.alive)
+                instanceData[next[o.modelIndex][lodOf(o)]++] = InstanceData{o.modelMatrix, glm::vec4(o.color, 1.0f)};
+        // batches are few: find each instance's batch by its range
+        for (auto &b : batches)
+            for (size_t i = b.first; i < b.first + b.count; ++i)
+                b.depth = std::min(b.depth, glm::length(glm::vec3(instanceData[i].model[3]) - cameraPos));
+    };
+    instanceData.clear();
+    build(false, viewBatches);
+    build(true, shadowBatches);
+
+    if (!instanceVBO)
+        glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceData.size() > instanceCapacity)
+        instanceCapacity = std::max(instanceData.size(), std::max(instanceCapacity * 2, (size_t)256));
+    // orphan last frame's storage, the GPU may still be drawing from it
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    if (!instanceData.empty())
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instanceData.size() * sizeof(InstanceData), instanceData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Game::Render(const Shader &shader3D, float dt, const glm::vec3 &cameraPos)
+{
+    StaticModel &floorModel = Model(floorHandle);
+    StaticModel &playerModel = Model(playerHandle);
+    /* ---- LOD per instance, for both passes ---- */
+    UpdateLod(floorModel, floorModel.modelMatrix, cameraPos, lodProjScale, floorLod);
+    UpdateLod(playerModel, player.modelMatrix, cameraPos, lodProjScale, playerLod);
+    for (auto &o : falling)
+        UpdateLod(Model(fallingHandles[o.modelIndex]), o.modelMatrix, cameraPos, lodProjScale, o.lod);
+
+    /* ---- texture detail: the mip levels this frame shows, made resident by TextureCache::Update ---- */
+    floorModel.RequestTextureDetail(floorModel.modelMatrix, cameraPos, lodProjScale);
+    playerModel.RequestTextureDetail(player.modelMatrix, cameraPos, lodProjScale);
+    for (auto &o : falling)
+        Model(fallingHandles[o.modelIndex]).RequestTextureDetail(o.modelMatrix, cameraPos, lodProjScale);
+    BuildFallingBatches(cameraPos);
+
     /* =========================================================
        1. 计算太阳光矩阵（Directional Light）
        ========================================================= */
@@ -686,6 +851,83 @@ void Game::Render(unsigned int shader3D, float dt, const glm::vec3 &cameraPos)
         1.0f, 50.0f);
 
     glm::mat4 lightVP = lightProj * lightView;
+    // one upload for every program that reads the Light block (both passes below)
+    SharedUniforms::Instance().SetLight(lightVP, sunDir, glm::vec3(1.0f, 0.98f, 0.9f), 1.2f);
+
+    /* ---- the frame's draws, in any order: the queue sorts them by state ---- */
+    queue.Clear();
+    auto distance = [&](const glm::mat4 &m)
+    { return glm::length(glm::vec3(m[3]) - cameraPos); };
+    // 告诉模型当前是否在移动
+    playerModel.animEnable = player.isMoving;
+    playerModel.Animate(player.modelMatrix, dt);
+
+    for (RenderPass pass : {RenderPass::Shadow, RenderPass::Main})
+    {
+        bool shadow = pass == RenderPass::Shadow;
+        const Shader *shader = shadow ? shadowShader : &shader3D;
+        if (!shader)
+            continue;
+        RenderItem item;
+        item.pass = pass;
+        item.shader = shader;
+
+        /* ---- floor ---- */
+        item.transform = floorModel.modelMatrix; // 已在初始化阶段算好
+        item.lod = shadow ? floorLod.shadow : floorLod.view;
+        floorModel.Submit(queue, item, distance(floorModel.modelMatrix));
+
+        /* ---- player: flat material, posed by Animate ---- */
+        item.lod = shadow ? playerLod.shadow : playerLod.view;
+        playerModel.SubmitAnimated(queue, item, distance(player.modelMatrix));
+
+        /* ---- falling objects: one instanced item per prototype, level and mesh ---- */
+        item.transform = glm::mat4(1.0f);
+        item.instanceBuffer = instanceVBO;
+        for (const auto &b : shadow ? shadowBatches : viewBatches)
+        {
+            item.lod = b.lod;
+            item.instanceOffset = b.first * sizeof(InstanceData);
+            item.instances = b.count;
+            Model(fallingHandles[b.modelIndex]).Submit(queue, item, b.depth);
+        }
+    }
+
+    /* ---- collectibles (colored cubes): one instanced draw, animated in collectible.vs ---- */
+    if (cubeVAO && collectibleShader)
+    {
+        if (collectiblesDirty)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, collectibleVBO);
+            if (collectibles.size() > collectibleCapacity)
+            {
+                collectibleCapacity = std::max(collectibles.size(), std::max(collectibleCapacity * 2, (size_t)16));
+                glBufferData(GL_ARRAY_BUFFER, collectibleCapacity * sizeof(Collectible), nullptr, GL_DYNAMIC_DRAW);
+            }
+            if (!collectibles.empty())
+                glBufferSubData(GL_ARRAY_BUFFER, 0, collectibles.size() * sizeof(Collectible), collectibles.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            collectiblesDirty = false;
+        }
+
+        if (!collectibles.empty())
+        {
+            RenderItem item;
+            item.pass = RenderPass::Main;
+            item.shader = collectibleShader;
+            item.vao = cubeVAO;
+            item.vertexCount = 36;
+            item.instances = (GLsizei)collectibles.size();
+            // the instance color tints it; fading out in the last seconds of their lifetime
+            item.material.blend = true;
+            // drawn in spawn order, not by depth: a fading cube must not hide the ones behind it
+            item.material.depthWrite = false;
+            float nearest = RenderQueue::kMaxDepth;
+            for (const auto &c : collectibles)
+                nearest = std::min(nearest, glm::length(c.pos - cameraPos));
+            queue.Submit(item, nearest);
+        }
+    }
 
     GLint prevViewport[4];
     glGetIntegerv(GL_VIEWPORT, prevViewport);
@@ -702,41 +944,7 @@ void Game::Render(unsigned int shader3D, float dt, const glm::vec3 &cameraPos)
         glEnable(GL_POLYGON_OFFSET_FILL);
         glPolygonOffset(2.0f, 4.0f);
 
-        glUseProgram(shadowShader);
-        glUniformMatrix4fv(
-            glGetUniformLocation(shadowShader, "uLightVP"),
-            1, GL_FALSE, &lightVP[0][0]);
-
-        auto setShadowModel = [&](const glm::mat4 &m)
-        {
-            glUniformMatrix4fv(
-                glGetUniformLocation(shadowShader, "uModel"),
-                1, GL_FALSE, &m[0][0]);
-        };
-
-        /* ---- floor ---- */
-        {
-            glm::mat4 m = floorModel.modelMatrix; // 已在初始化阶段算好
-            setShadowModel(m);
-            floorModel.DrawDepth();
-        }
-
-        /* ---- player ---- */
-        {
-            glm::mat4 m = player.modelMatrix;
-            setShadowModel(m);
-            playerModel.animEnable = player.isMoving;
-            playerModel.DrawAnimated(m, dt, shadowShader);
-            playerModel.DrawDepth();
-        }
-
-        /* ---- falling objects ---- */
-        for (auto &o : falling)
-        {
-            glm::mat4 m = o.modelMatrix;
-            setShadowModel(m);
-            fallingModels[o.modelIndex].DrawDepth();
-        }
+        queue.Execute(RenderPass::Shadow);
 
         glDisable(GL_POLYGON_OFFSET_FILL);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -747,122 +955,8 @@ void Game::Render(unsigned int shader3D, float dt, const glm::vec3 &cameraPos)
     /* =========================================================
        3. Main Pass（正常渲染）
        ========================================================= */
-    glUseProgram(shader3D);
-
-    /* ---- camera & light ---- */
-    glUniform3fv(
-        glGetUniformLocation(shader3D, "uViewPos"),
-        1, &cameraPos[0]);
-
-    glUniform3fv(
-        glGetUniformLocation(shader3D, "uLightDir"),
-        1, &sunDir[0]);
-
-    glUniform3f(
-        glGetUniformLocation(shader3D, "uLightColor"),
-        1.0f, 0.98f, 0.9f);
-
-    glUniform1f(
-        glGetUniformLocation(shader3D, "uLightIntensity"),
-        1.2f);
-
-    /* ---- shadow uniforms ---- */
-    glUniformMatrix4fv(
-        glGetUniformLocation(shader3D, "uLightVP"),
-        1, GL_FALSE, &lightVP[0][0]);
-
+    // camera & light come from the Frame and Light blocks, the shadow map stays on unit 3
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, depthMap);
-    glUniform1i(
-        glGetUniformLocation(shader3D, "uShadowMap"),
-        3);
-
-    auto setModelAndNormal = [&](const glm::mat4 &m)
-    {
-        glUniformMatrix4fv(
-            glGetUniformLocation(shader3D, "uModel"),
-            1, GL_FALSE, &m[0][0]);
-
-        glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(m)));
-        glUniformMatrix3fv(
-            glGetUniformLocation(shader3D, "uNormalMat"),
-            1, GL_FALSE, &normalMat[0][0]);
-    };
-    glEnableVertexAttribArray(1); // normal attribute
-    /* ---- floor ---- */
-    {
-        setModelAndNormal(floorModel.modelMatrix);
-
-        glUniform1i(glGetUniformLocation(shader3D, "uHasDiffuse"), 1);
-        glUniform1i(glGetUniformLocation(shader3D, "uUseAlphaTest"), 0);
-        glUniform1i(glGetUniformLocation(shader3D, "uDiffuseMap"), 0);
-
-        glActiveTexture(GL_TEXTURE0);
-        floorModel.Draw(shader3D);
-    }
-
-    /* ---- player ---- */
-    {
-        setModelAndNormal(player.modelMatrix);
-        float horizSpeed = glm::length(glm::vec2(player.pos.x, player.pos.z)); // world units/s
-        float maxSpeed = 3.0f;                                                 // tune to match your control speed
-        float speedFactor = glm::clamp(horizSpeed / maxSpeed, 0.0f, 1.0f);
-        glm::vec3 playerScale = glm::vec3(1.0f); // tune as needed, maybe playerModel.modelScale
-        glUniform1i(glGetUniformLocation(shader3D, "uHasDiffuse"), 1);
-        glUniform1i(glGetUniformLocation(shader3D, "uUseAlphaTest"), 1);
-        glUniform1f(glGetUniformLocation(shader3D, "uAlphaCutoff"), 0.3f);
-        glUniform1i(glGetUniformLocation(shader3D, "uDiffuseMap"), 0);
-        // 告诉模型当前是否在移动
-        playerModel.animEnable = player.isMoving;
-        glUseProgram(shader3D);
-        glActiveTexture(GL_TEXTURE0);
-
-        // set uViewPos if used
-        // glUniform3fv(glGetUniformLocation(shader3D.ID, "uViewPos"), 1, &cameraPos[0]);
-        playerModel.DrawAnimated(player.modelMatrix, dt, shader3D);
-    }
-
-    /* ---- falling objects ---- */
-    for (auto &o : falling)
-    {
-        setModelAndNormal(o.modelMatrix);
-
-        glUniform1i(glGetUniformLocation(shader3D, "uHasDiffuse"), 1);
-        glUniform1i(glGetUniformLocation(shader3D, "uUseAlphaTest"), 0);
-        glUniform1i(glGetUniformLocation(shader3D, "uDiffuseMap"), 0);
-
-        glActiveTexture(GL_TEXTURE0);
-        fallingModels[o.modelIndex].Draw(shader3D);
-    }
-
-    /* ---- collectibles (colored cubes) ---- */
-    if (cubeVAO)
-    {
-        // 使用常量法线，避免缺失顶点法线导致错误 lighting
-        glDisableVertexAttribArray(1); // normal attribute
-        glVertexAttrib3f(1, 0.0f, 1.0f, 0.0f);
-        glDisableVertexAttribArray(2); // uv attribute, if any
-
-        glUniform1i(glGetUniformLocation(shader3D, "uHasDiffuse"), 0);
-        glUniform1i(glGetUniformLocation(shader3D, "uUseAlphaTest"), 0);
-
-        glBindVertexArray(cubeVAO);
-        for (auto &c : collectibles)
-        {
-            glm::mat4 m(1.0f);
-            m = glm::translate(m, c.pos);
-            m = glm::scale(m, glm::vec3(0.4f)); // 小立方体边长约 0.4
-            setModelAndNormal(m);
-
-            // 用 uMatDiffuse 传颜色
-            glUniform3fv(glGetUniformLocation(shader3D, "uMatDiffuse"), 1, &c.color[0]);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-        glBindVertexArray(0);
-
-        // 下帧渲染其他模型会重新启用属性
-    }
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    queue.Execute(RenderPass::Main);
 }
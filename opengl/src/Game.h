@@ -5,34 +5,34 @@
 #include <iostream>
 #include <glm/glm.hpp>
 #include "Player.h"
+#include "ResourceManager.h"
 #include "StaticModel.h"
 #include "Shader.h"
 
-enum CatPart
-{
-    CAT_BODY = 0,
-    CAT_HEAD = 1,
-    CAT_TAIL = 2,
-    CAT_LEG0 = 3,
-    CAT_LEG1 = 4,
-    CAT_LEG2 = 5,
-    CAT_LEG3 = 6,
-    CAT_PART_COUNT = 7
-};
+class AssetLoader;
 
+// Also the per-instance data of collectible.vs (locations 3 and 4), which bobs, spins and fades the
+// cube from these fields alone: the instance buffer changes only when one spawns or is picked up.
 struct Collectible
 {
-    glm::vec3 pos;
+    glm::vec3 pos;   // resting position
+    float spawnTime; // glfwGetTime() clock, the Frame block's uTime
     glm::vec3 color;
-    float lifetime; // seconds remaining
-    bool alive;
+    float lifetime; // seconds after spawnTime
+};
+
+// per-instance StaticModel::SelectLod state, one level per pass
+struct LodState
+{
+    int view = 0;
+    int shadow = 0; // never finer than view
 };
 
 struct Falling
 {
     glm::vec3 pos;
     glm::vec3 vel;
-    glm::vec3 color;
+    glm::vec3 color; // tints the prototype's materials (instance attribute)
     bool alive;
     float rot;            // current rotation angle (radians)
     glm::vec3 rotAxis;    // rotation axis
@@ -41,6 +41,7 @@ struct Falling
     glm::mat4 modelMatrix;
     glm::vec3 halfExtents; // for AABB collision
     int modelIndex;        // which model to use (if multiple)
+    LodState lod;
 };
 
 class Game
@@ -49,14 +50,11 @@ public:
     Player player;
     std::vector<Falling> falling;
 
-    // cat part prototypes (loaded once)
-    StaticModel catParts[CAT_PART_COUNT];
-    glm::vec3 catPartLocalOffset[CAT_PART_COUNT]; // in body-local coordinates
-    glm::vec3 catPartScale[CAT_PART_COUNT];
-
-    StaticModel fallingPrototype; // e.g. crate model
-    StaticModel floorModel;       // detailed floor model
-    StaticModel fallingModels[3]; // optional multiple falling models
+    // Models live in the ResourceManager: the floor and the player are pinned and loaded at
+    // startup, falling prototypes load the first time SpawnObject picks them and are evicted once
+    // no instance has used them for a while.
+    ResourceHandle floorHandle;       // detailed floor model
+    ResourceHandle fallingHandles[3]; // falling object prototypes
     std::vector<Collectible> collectibles;
     float floorTop = -0.5f; // 可在 LoadResources 后用 floorModel bbox 覆盖
     float floorYOffset;
@@ -82,42 +80,64 @@ public:
     static constexpr unsigned int SHADOW_SIZE = 2048;
 
     // shadow shader program id
-    unsigned int shadowShader = 0;
+    const Shader *shadowShader = nullptr;
+    // collectible.vs + phong.fs
+    const Shader *collectibleShader = nullptr;
 
     Game();
     void InitShadowMap();
     void Reset();
     void Update(float dt, const bool keys[1024], const glm::vec3 &cameraFront, const glm::vec3 &cameraUp);
-    void Render(unsigned int shader3D, float dt, const glm::vec3 &cameraPos);
-    void SetCubeVAO(unsigned int vao) { cubeVAO = vao; }
+    // cube mesh and instance buffer for the collectibles (GL thread)
+    void InitCollectibles();
+    // submits the frame's draws to queue and executes its shadow and main passes
+    void Render(const Shader &shader3D, float dt, const glm::vec3 &cameraPos);
+    RenderQueue queue;
+    // camera projection, for picking model LODs by projected size
+    void SetProjection(float fovyRadians, int viewportHeight);
 
-    StaticModel playerModel;
+    ResourceHandle playerHandle;
 
-    void LoadCatParts(const std::string &assetDir);
-
-    // Draw function using models
-    void DrawAnimatedCatWithModels(const glm::vec3 &pos, float speedFactor,
-                                   unsigned int shader3D, unsigned int cubeVAO /*optional*/);
-
-    void LoadPlayerModel(const std::string &path)
-    {
-        if (!playerModel.LoadFromFile(path))
-        {
-            std::cerr << "Failed to load player model: " << path << std::endl;
-        }
-        else
-        {
-
-            // 可选：设置默认缩放来匹配原来 cube 大小
-            playerModel.modelScale = glm::vec3(0.6f);
-        }
-        // std::cout << "scene->mNumMeshes: " << this->scene->mNumMeshes << ", scene->mRootNode->mNumChildren: " << this->scene->mRootNode->mNumChildren << std::endl;
-    }
+    void LoadPlayerModel(const std::string &path);
 
     bool LoadResources(const std::string &assetsDir);
 
+    // Parallel variants: queue the CPU (import/decode) and GL (upload) phases on loader,
+    // the models become usable after loader.Finish().
+    void QueueResources(AssetLoader &loader, const std::string &assetsDir);
+    void QueuePlayerModel(AssetLoader &loader, const std::string &path);
+
 private:
+    // collectibles: unit cube (position + normal) and the Collectible instances, drawn in one call
     unsigned int cubeVAO = 0;
+    unsigned int cubeVBO = 0;
+    unsigned int collectibleVBO = 0;
+    size_t collectibleCapacity = 0; // Collectible entries
+    bool collectiblesDirty = true;  // spawned or picked up since the last upload
+
+    // Falling objects are drawn instanced: each frame their InstanceData is written to instanceVBO
+    // grouped by (prototype, level of detail), once for the main pass and once for the shadow pass
+    // (whose levels can differ), and every group is one instanced RenderItem.
+    struct InstanceBatch
+    {
+        int modelIndex;
+        int lod;
+        size_t first; // InstanceData entries into instanceVBO
+        GLsizei count;
+        float depth; // camera distance of the nearest instance, for the queue's ordering
+    };
+    unsigned int instanceVBO = 0;
+    size_t instanceCapacity = 0; // InstanceData entries
+    std::vector<InstanceData> instanceData;
+    std::vector<InstanceBatch> viewBatches;
+    std::vector<InstanceBatch> shadowBatches;
+    void BuildFallingBatches(const glm::vec3 &cameraPos);
+
+    // the resident model, or an empty stand-in while it is loading or failed to load
+    StaticModel &Model(ResourceHandle h);
+    float lodProjScale = 1.0f; // viewport height / (2 tan(fovy / 2))
+    LodState floorLod;
+    LodState playerLod;
     void SpawnObject();
 };
 #endif
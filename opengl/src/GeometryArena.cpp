@@ -0,0 +1,447 @@
+// src/GeometryArena.cpp
+#include "GeometryArena.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+
+static const size_t kInitialVertices = 64 * 1024;
+static const size_t kInitialIndexBytes = 512 * 1024;
+
+// ---- free list ----
+bool GeometryArena::FreeList::Allocate(size_t size, size_t &outOffset)
+{
+    if (size == 0)
+    {
+        outOffset = 0;
+        return true;
+    }
+    for (auto it = blocks.begin(); it != blocks.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        outOffset = it->first;
+        size_t rest = it->second - size;
+        blocks.erase(it);
+        if (rest)
+            blocks[outOffset + size] = rest;
+        return true;
+    }
+    return false;
+}
+
+void GeometryArena::FreeList::Free(size_t offset, size_t size)
+{
+    if (size == 0)
+        return;
+    auto next = blocks.lower_bound(offset);
+    if (next != blocks.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            blocks.erase(prev);
+        }
+    }
+    if (next != blocks.end() && offset + size == next->first)
+    {
+        size += next->second;
+        blocks.erase(next);
+    }
+    blocks[offset] = size;
+}
+
+void GeometryArena::FreeList::Grow(size_t newCapacity)
+{
+    size_t old = capacity;
+    capacity = newCapacity;
+    Free(old, newCapacity - old);
+}
+
+size_t GeometryArena::FreeList::FreeTotal() const
+{
+    size_t total = 0;
+    for (const auto &b : blocks)
+        total += b.second;
+    return total;
+}
+
+size_t GeometryArena::FreeList::LargestFree() const
+{
+    size_t largest = 0;
+    for (const auto &b : blocks)
+        largest = std::max(largest, b.second);
+    return largest;
+}
+
+// ---- arena ----
+GeometryArena &GeometryArena::Get(VertexFormat fmt)
+{
+    static GeometryArena floatArena(VertexFormat::Float);
+    static GeometryArena packedArena(VertexFormat::Packed);
+    return fmt == VertexFormat::Packed ? packedArena : floatArena;
+}
+
+GeometryArena::GeometryArena(VertexFormat fmt)
+    : format(fmt), stride(fmt == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(SimpleVertex))
+{
+    ranges.resize(1); // handle 0 means "no geometry"
+}
+
+void GeometryArena::CreateBuffers(size_t vertexCapacity, size_t indexCapacity)
+{
+    glGenVertexArrays(1, &vao);
+    glGenVertexArrays(1, &instancedVao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * stride, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    vertexFree.Grow(vertexCapacity);
+    indexFree.Grow(indexCapacity);
+    SetupVertexArray();
+}
+
+void GeometryArena::SetupVertexArray()
+{
+    SetupVertexAttributes(vao);
+    SetupVertexAttributes(instancedVao);
+    // per-instance attributes: pointed at the instance data by BindInstanced
+    glBindVertexArray(instancedVao);
+    for (GLuint loc = 3; loc <= 7; ++loc)
+    {
+        glEnableVertexAttribArray(loc);
+        glVertexAttribDivisor(loc, 1);
+    }
+    glBindVertexArray(0);
+}
+
+void GeometryArena::SetupVertexAttributes(GLuint array)
+{
+    glBindVertexArray(array);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    // attribs: location 0 = pos, 1 = normal, 2 = uv
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    GLsizei s = (GLsizei)stride;
+    if (format == VertexFormat::Float)
+    {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, s, (void *)offsetof(SimpleVertex, pos));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, s, (void *)offsetof(SimpleVertex, normal));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, s, (void *)offsetof(SimpleVertex, uv));
+    }
+    else
+    {
+        // normalized integer attributes arrive in the shader as floats, so phong.vs/shadow_depth.vs are unchanged
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, s, (void *)offsetof(PackedVertex, pos));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, s, (void *)offsetof(PackedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, s, (void *)offsetof(PackedVertex, uv));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::BindInstanced(GLuint instanceBuffer, size_t byteOffset) const
+{
+    glBindVertexArray(instancedVao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    GLsizei s = (GLsizei)sizeof(InstanceData);
+    for (GLuint col = 0; col < 4; ++col)
+        glVertexAttribPointer(3 + col, 4, GL_FLOAT, GL_FALSE, s,
+                              (void *)(byteOffset + offsetof(InstanceData, model) + col * sizeof(glm::vec4)));
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, s, (void *)(byteOffset + offsetof(InstanceData, color)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// replace buffer with a new one of newBytes, keeping the first keepBytes
+static GLuint ReallocBuffer(GLuint buffer, size_t keepBytes, size_t newBytes)
+{
+    GLuint nb;
+    glGenBuffers(1, &nb);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, nb);
+    glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_STATIC_DRAW);
+    if (keepBytes)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    return nb;
+}
+
+void GeometryArena::GrowVertices(size_t minExtra)
+{
+    size_t newCap = std::max(vertexFree.capacity * 2, vertexFree.capacity + minExtra);
+    vbo = ReallocBuffer(vbo, vertexFree.capacity * stride, newCap * stride);
+    vertexFree.Grow(newCap);
+    SetupVertexArray();
+    ++grows;
+}
+
+void GeometryArena::GrowIndices(size_t minExtra)
+{
+    size_t newCap = std::max(indexFree.capacity * 2, indexFree.capacity + minExtra);
+    ebo = ReallocBuffer(ebo, indexFree.capacity, newCap);
+    indexFree.Grow(newCap);
+    SetupVertexArray();
+    ++grows;
+}
+
+bool GeometryArena::AllocateVertices(uint32_t count, size_t &outOffset)
+{
+    if (vertexFree.Allocate(count, outOffset))
+        return true;
+    if (vertexFree.FreeTotal() >= count)
+    {
+        Defragment();
+        if (vertexFree.Allocate(count, outOffset))
+            return true;
+    }
+    GrowVertices(count);
+    return vertexFree.Allocate(count, outOffset);
+}
+
+bool GeometryArena::AllocateIndices(size_t bytes, size_t &outOffset)
+{
+    if (indexFree.Allocate(bytes, outOffset))
+        return true;
+    if (indexFree.FreeTotal() >= bytes)
+    {
+        Defragment();
+        if (indexFree.Allocate(bytes, outOffset))
+            return true;
+    }
+    GrowIndices(bytes);
+    return indexFree.Allocate(bytes, outOffset);
+}
+
+uint32_t GeometryArena::Reserve(uint32_t vertexCount, size_t indexBytes)
+{
+    if (!vao)
+        CreateBuffers(kInitialVertices, kInitialIndexBytes);
+
+    size_t vertexOffset;
+    if (!AllocateVertices(vertexCount, vertexOffset))
+    {
+        std::cerr << "GeometryArena: out of vertex space for " << vertexCount << " vertices\n";
+        return 0;
+    }
+
+    uint32_t handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = (uint32_t)ranges.size();
+        ranges.emplace_back();
+    }
+    // registered before the index allocation: a defragment there must move this range too
+    Range &r = ranges[handle];
+    r = Range();
+    r.baseVertex = (uint32_t)vertexOffset;
+    r.vertexCount = vertexCount;
+    r.live = true;
+
+    // keep every index range 4-byte aligned whatever the index type
+    size_t paddedBytes = (indexBytes + 3) & ~(size_t)3;
+    size_t indexOffset;
+    if (!AllocateIndices(paddedBytes, indexOffset))
+    {
+        std::cerr << "GeometryArena: out of index space for " << indexBytes << " bytes\n";
+        Free(handle);
+        return 0;
+    }
+    Range &ri = ranges[handle];
+    ri.indexOffset = indexOffset;
+    ri.indexBytes = paddedBytes;
+    return handle;
+}
+
+uint32_t GeometryArena::Allocate(const void *vertices, uint32_t vertexCount, const void *indices, size_t indexBytes)
+{
+    uint32_t handle = Reserve(vertexCount, indexBytes);
+    if (!handle)
+        return 0;
+    const Range &r = ranges[handle];
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, r.baseVertex * stride, vertexCount * stride, vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, r.indexOffset, indexBytes, indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return handle;
+}
+
+uint32_t GeometryArena::AllocateMapped(uint32_t vertexCount, size_t indexBytes, void *&vertices, void *&indices)
+{
+    vertices = indices = nullptr;
+    uint32_t handle = Reserve(vertexCount, indexBytes);
+    if (!handle)
+        return 0;
+    // the vertex buffer stays mapped on the read target, the index buffer on the write target;
+    // the range was never drawn from, so invalidating it cannot stall on the GPU
+    const Range &r = ranges[handle];
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+    if (vertexCount)
+        vertices = glMapBufferRange(GL_COPY_READ_BUFFER, r.baseVertex * stride, vertexCount * stride, access);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    if (indexBytes)
+        indices = glMapBufferRange(GL_COPY_WRITE_BUFFER, r.indexOffset, indexBytes, access);
+    if ((vertexCount && !vertices) || (indexBytes && !indices))
+    {
+        std::cerr << "GeometryArena: glMapBufferRange failed\n";
+        Unmap(handle);
+        Free(handle);
+        vertices = indices = nullptr;
+        return 0;
+    }
+    return handle;
+}
+
+bool GeometryArena::Unmap(uint32_t handle)
+{
+    bool ok = true;
+    GLint mapped = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_MAPPED, &mapped);
+    if (mapped)
+        ok = glUnmapBuffer(GL_COPY_READ_BUFFER) == GL_TRUE;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glGetBufferParameteriv(GL_COPY_WRITE_BUFFER, GL_BUFFER_MAPPED, &mapped);
+    if (mapped)
+        ok = (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE) && ok;
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (!ok)
+    {
+        // the data store was corrupted (e.g. a display mode change); the caller retries or drops the mesh
+        std::cerr << "GeometryArena: buffer contents lost while mapped\n";
+        Free(handle);
+    }
+    return ok;
+}
+
+void GeometryArena::Free(uint32_t handle)
+{
+    if (handle == 0 || handle >= ranges.size() || !ranges[handle].live)
+        return;
+    Range &r = ranges[handle];
+    vertexFree.Free(r.baseVertex, r.vertexCount);
+    indexFree.Free(r.indexOffset, r.indexBytes);
+    r = Range();
+    freeHandles.push_back(handle);
+}
+
+void GeometryArena::Defragment()
+{
+    if (!vao)
+        return;
+
+    std::vector<uint32_t> live;
+    for (uint32_t h = 1; h < ranges.size(); ++h)
+        if (ranges[h].live)
+            live.push_back(h);
+
+    // vertices: copy live ranges in offset order into a fresh buffer
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b)
+              { return ranges[a].baseVertex < ranges[b].baseVertex; });
+    GLuint nvbo;
+    glGenBuffers(1, &nvbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, nvbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexFree.capacity * stride, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+    size_t vertexEnd = 0;
+    for (uint32_t h : live)
+    {
+        Range &r = ranges[h];
+        if (r.vertexCount)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, r.baseVertex * stride, vertexEnd * stride,
+                                r.vertexCount * stride);
+        r.baseVertex = (uint32_t)vertexEnd;
+        vertexEnd += r.vertexCount;
+    }
+    glDeleteBuffers(1, &vbo);
+    vbo = nvbo;
+
+    // indices: same in index offset order
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b)
+              { return ranges[a].indexOffset < ranges[b].indexOffset; });
+    GLuint nebo;
+    glGenBuffers(1, &nebo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, nebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexFree.capacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, ebo);
+    size_t indexEnd = 0;
+    for (uint32_t h : live)
+    {
+        Range &r = ranges[h];
+        if (r.indexBytes)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, r.indexOffset, indexEnd, r.indexBytes);
+        r.indexOffset = indexEnd;
+        indexEnd += r.indexBytes;
+    }
+    glDeleteBuffers(1, &ebo);
+    ebo = nebo;
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    vertexFree.blocks.clear();
+    if (vertexEnd < vertexFree.capacity)
+        vertexFree.blocks[vertexEnd] = vertexFree.capacity - vertexEnd;
+    indexFree.blocks.clear();
+    if (indexEnd < indexFree.capacity)
+        indexFree.blocks[indexEnd] = indexFree.capacity - indexEnd;
+
+    SetupVertexArray();
+    ++defrags;
+}
+
+GeometryArena::Stats GeometryArena::GetStats() const
+{
+    Stats s;
+    s.vertexCapacity = vertexFree.capacity;
+    s.verticesUsed = vertexFree.capacity - vertexFree.FreeTotal();
+    s.indexCapacity = indexFree.capacity;
+    s.indexBytesUsed = indexFree.capacity - indexFree.FreeTotal();
+    s.allocations = ranges.size() - 1 - freeHandles.size();
+    size_t vfree = vertexFree.FreeTotal(), ifree = indexFree.FreeTotal();
+    s.vertexFragmentation = vfree ? 1.0f - (float)vertexFree.LargestFree() / (float)vfree : 0.0f;
+    s.indexFragmentation = ifree ? 1.0f - (float)indexFree.LargestFree() / (float)ifree : 0.0f;
+    s.grows = grows;
+    s.defrags = defrags;
+    return s;
+}
+
+void GeometryArena::PrintStats()
+{
+    const VertexFormat formats[2] = {VertexFormat::Float, VertexFormat::Packed};
+    for (VertexFormat fmt : formats)
+    {
+        const GeometryArena &a = Get(fmt);
+        if (!a.vao)
+            continue;
+        Stats s = a.GetStats();
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "GeometryArena %s: %zu ranges, vertices %zu/%zu (%.2f MB), indices %.1f/%.1f KB, "
+                 "fragmentation %.2f/%.2f, %u grows, %u defrags",
+                 fmt == VertexFormat::Packed ? "packed" : "float", s.allocations, s.verticesUsed, s.vertexCapacity,
+                 s.vertexCapacity * a.stride / (1024.0 * 1024.0), s.indexBytesUsed / 1024.0, s.indexCapacity / 1024.0,
+                 s.vertexFragmentation, s.indexFragmentation, s.grows, s.defrags);
+        std::cout << line << std::endl;
+    }
+}
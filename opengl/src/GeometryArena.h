@@ -0,0 +1,104 @@
+// src/GeometryArena.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <glad/glad.h>
+#include "StaticModel.h"
+
+// One shared vertex buffer + index buffer (and one VAO) per vertex format. Meshes get a handle
+// to a (baseVertex, indexOffset) range and are drawn with glDrawElementsBaseVertex, so a whole
+// model only binds a single VAO. Ranges come from first-fit free lists; when a request does not fit
+// the arena defragments (if enough space is free in total) or grows, and handles stay valid
+// because ranges are looked up at draw time. A second VAO over the same buffers adds the per-instance
+// attributes (InstanceData) for instanced draws. All functions must run on the GL thread.
+class GeometryArena
+{
+public:
+    struct Range
+    {
+        uint32_t baseVertex = 0;
+        uint32_t vertexCount = 0;
+        size_t indexOffset = 0; // bytes into the index buffer
+        size_t indexBytes = 0;
+        bool live = false;
+    };
+
+    struct Stats
+    {
+        size_t vertexCapacity = 0; // vertices
+        size_t verticesUsed = 0;
+        size_t indexCapacity = 0; // bytes
+        size_t indexBytesUsed = 0;
+        size_t allocations = 0;
+        // 1 - largest free block / total free space, 0 when the free space is one block
+        float vertexFragmentation = 0.0f;
+        float indexFragmentation = 0.0f;
+        unsigned int grows = 0;
+        unsigned int defrags = 0;
+    };
+
+    static GeometryArena &Get(VertexFormat fmt);
+
+    // Copies the data into the arena; returns a handle, 0 on failure.
+    // indices may be 16 or 32 bit, the caller keeps track of the type.
+    uint32_t Allocate(const void *vertices, uint32_t vertexCount, const void *indices, size_t indexBytes);
+    // Reserves a range and maps it write-only so the caller can decode straight into the buffers
+    // (no staging copy). vertices/indices are null for an empty part. Nothing else may use the
+    // arena until Unmap(); false from Unmap means the driver lost the contents, the range is freed.
+    uint32_t AllocateMapped(uint32_t vertexCount, size_t indexBytes, void *&vertices, void *&indices);
+    bool Unmap(uint32_t handle);
+    void Free(uint32_t handle);
+    const Range &GetRange(uint32_t handle) const { return ranges[handle]; }
+
+    void Bind() const { glBindVertexArray(vao); }
+    // binds the instanced VAO, its per-instance attributes reading InstanceData from instanceBuffer
+    // starting at byteOffset (instance 0 of the following draws)
+    void BindInstanced(GLuint instanceBuffer, size_t byteOffset) const;
+    // move every live range to the front of its buffer
+    void Defragment();
+
+    Stats GetStats() const;
+    static void PrintStats();
+
+private:
+    explicit GeometryArena(VertexFormat fmt);
+    GeometryArena(const GeometryArena &) = delete;
+    GeometryArena &operator=(const GeometryArena &) = delete;
+
+    // free blocks by offset, in allocation units (vertices or bytes)
+    struct FreeList
+    {
+        std::map<size_t, size_t> blocks;
+        size_t capacity = 0;
+
+        bool Allocate(size_t size, size_t &outOffset);
+        void Free(size_t offset, size_t size);
+        void Grow(size_t newCapacity);
+        size_t FreeTotal() const;
+        size_t LargestFree() const;
+    };
+
+    void CreateBuffers(size_t vertexCapacity, size_t indexCapacity);
+    void SetupVertexArray();
+    void SetupVertexAttributes(GLuint array);
+    void GrowVertices(size_t minExtra);
+    void GrowIndices(size_t minExtra);
+    bool AllocateVertices(uint32_t count, size_t &outOffset);
+    bool AllocateIndices(size_t bytes, size_t &outOffset);
+    uint32_t Reserve(uint32_t vertexCount, size_t indexBytes);
+
+    VertexFormat format;
+    size_t stride;
+    GLuint vao = 0;
+    GLuint instancedVao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    FreeList vertexFree;
+    FreeList indexFree;
+    std::vector<Range> ranges; // indexed by handle, slot 0 unused
+    std::vector<uint32_t> freeHandles;
+    unsigned int grows = 0;
+    unsigned int defrags = 0;
+};
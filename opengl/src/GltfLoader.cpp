@@ -0,0 +1,678 @@
+// src/GltfLoader.cpp
+#include "GltfLoader.h"
+#include "Json.h"
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+static const uint32_t kGlbMagic = 0x46546C67; // "glTF"
+static const uint32_t kChunkJson = 0x4E4F534A;
+static const uint32_t kChunkBin = 0x004E4942;
+
+enum GltfComponent
+{
+    kByte = 5120,
+    kUnsignedByte = 5121,
+    kShort = 5122,
+    kUnsignedShort = 5123,
+    kUnsignedInt = 5125,
+    kFloat = 5126
+};
+
+struct GltfBuffer
+{
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+};
+
+// typed view of one accessor, already bounds checked
+struct AccessorView
+{
+    const unsigned char *data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int componentType = 0;
+    int components = 0;
+    bool normalized = false;
+};
+
+struct GltfContext
+{
+    std::string path;
+    std::string directory;
+    JsonValue doc;
+    std::vector<GltfBuffer> buffers;
+    GltfScene *scene = nullptr;
+};
+
+// non-negative integer member (byte offsets, lengths, counts)
+static size_t GetSize(const JsonValue &v, const std::string &key)
+{
+    double d = v.GetNumber(key, 0.0);
+    return d > 0.0 ? (size_t)d : 0;
+}
+
+static size_t ComponentSize(int type)
+{
+    switch (type)
+    {
+    case kByte:
+    case kUnsignedByte:
+        return 1;
+    case kShort:
+    case kUnsignedShort:
+        return 2;
+    case kUnsignedInt:
+    case kFloat:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static int ComponentCount(const std::string &type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    return 0;
+}
+
+// one component as float, normalized integers mapped to [0,1] / [-1,1]
+static float ReadComponent(const unsigned char *p, int type, bool normalized)
+{
+    switch (type)
+    {
+    case kFloat:
+    {
+        float f;
+        std::memcpy(&f, p, 4);
+        return f;
+    }
+    case kUnsignedByte:
+        return normalized ? p[0] / 255.0f : (float)p[0];
+    case kByte:
+    {
+        float v = (float)(int8_t)p[0];
+        return normalized ? glm::max(v / 127.0f, -1.0f) : v;
+    }
+    case kUnsignedShort:
+    {
+        uint16_t v;
+        std::memcpy(&v, p, 2);
+        return normalized ? v / 65535.0f : (float)v;
+    }
+    case kShort:
+    {
+        int16_t v;
+        std::memcpy(&v, p, 2);
+        return normalized ? glm::max(v / 32767.0f, -1.0f) : (float)v;
+    }
+    case kUnsignedInt:
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return (float)v;
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+static uint32_t ReadIndex(const unsigned char *p, int type)
+{
+    switch (type)
+    {
+    case kUnsignedByte:
+        return p[0];
+    case kUnsignedShort:
+    {
+        uint16_t v;
+        std::memcpy(&v, p, 2);
+        return v;
+    }
+    default:
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    }
+}
+
+static bool DecodeBase64(const char *s, size_t n, std::vector<unsigned char> &out)
+{
+    auto value = [](char c) -> int
+    {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '+' || c == '-')
+            return 62;
+        if (c == '/' || c == '_')
+            return 63;
+        return -1;
+    };
+    out.clear();
+    out.reserve(n / 4 * 3);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (s[i] == '=')
+            break;
+        int v = value(s[i]);
+        if (v < 0)
+            return false;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((unsigned char)(acc >> bits));
+        }
+    }
+    return true;
+}
+
+static std::string DecodeUri(const std::string &uri)
+{
+    std::string out;
+    for (size_t i = 0; i < uri.size(); ++i)
+    {
+        if (uri[i] == '%' && i + 2 < uri.size())
+        {
+            out += (char)std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        }
+        else
+            out += uri[i];
+    }
+    return out;
+}
+
+// data: URI or a file next to the .gltf
+static bool LoadUri(GltfContext &ctx, const std::string &uri, GltfBuffer &out)
+{
+    if (uri.compare(0, 5, "data:") == 0)
+    {
+        size_t comma = uri.find(',');
+        if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+            return false;
+        ctx.scene->ownedBuffers.emplace_back();
+        std::vector<unsigned char> &bytes = ctx.scene->ownedBuffers.back();
+        if (!DecodeBase64(uri.data() + comma + 1, uri.size() - comma - 1, bytes))
+            return false;
+        out.data = bytes.data();
+        out.size = bytes.size();
+        return true;
+    }
+    std::unique_ptr<AssetData> file(new AssetData());
+    if (!ReadAsset(ctx.directory + "/" + DecodeUri(uri), *file))
+        return false;
+    out.data = file->Data();
+    out.size = file->Size();
+    ctx.scene->files.push_back(std::move(file));
+    return true;
+}
+
+static bool LoadBuffers(GltfContext &ctx, const GltfBuffer &glbChunk)
+{
+    const JsonValue &buffers = ctx.doc["buffers"];
+    for (size_t i = 0; i < buffers.Size(); ++i)
+    {
+        const JsonValue &b = buffers[i];
+        GltfBuffer buf;
+        const JsonValue *uri = b.Find("uri");
+        if (!uri)
+        {
+            // only the first buffer of a GLB may omit the uri: it is the binary chunk
+            if (i != 0 || !glbChunk.data)
+            {
+                std::cerr << "GltfLoader: buffer " << i << " has no data in " << ctx.path << "\n";
+                return false;
+            }
+            buf = glbChunk;
+        }
+        else if (!LoadUri(ctx, uri->AsString(), buf))
+        {
+            std::cerr << "GltfLoader: cannot load buffer " << uri->AsString() << " of " << ctx.path << "\n";
+            return false;
+        }
+        size_t declared = GetSize(b, "byteLength");
+        if (declared > buf.size)
+        {
+            std::cerr << "GltfLoader: buffer " << i << " is shorter than declared in " << ctx.path << "\n";
+            return false;
+        }
+        ctx.buffers.push_back(buf);
+    }
+    return true;
+}
+
+// byte range of a buffer view
+static bool GetBufferView(const GltfContext &ctx, int index, const unsigned char *&data, size_t &size, size_t &stride)
+{
+    const JsonValue &view = ctx.doc["bufferViews"][(size_t)index];
+    if (!view.IsObject())
+        return false;
+    int buffer = view.GetInt("buffer", -1);
+    if (buffer < 0 || (size_t)buffer >= ctx.buffers.size())
+        return false;
+    size_t offset = GetSize(view, "byteOffset");
+    size = GetSize(view, "byteLength");
+    stride = GetSize(view, "byteStride");
+    const GltfBuffer &buf = ctx.buffers[buffer];
+    if (offset > buf.size || size > buf.size - offset)
+        return false;
+    data = buf.data + offset;
+    return true;
+}
+
+static bool GetAccessor(const GltfContext &ctx, int index, AccessorView &out)
+{
+    const JsonValue &acc = ctx.doc["accessors"][(size_t)index];
+    if (!acc.IsObject())
+        return false;
+    if (acc.Find("sparse"))
+    {
+        std::cerr << "GltfLoader: sparse accessors are not supported (" << ctx.path << ")\n";
+        return false;
+    }
+    out.componentType = acc.GetInt("componentType", 0);
+    out.components = ComponentCount(acc.GetString("type"));
+    out.count = GetSize(acc, "count");
+    out.normalized = acc["normalized"].AsBool(false);
+    size_t elemSize = ComponentSize(out.componentType) * (size_t)out.components;
+    if (elemSize == 0)
+        return false;
+
+    const unsigned char *viewData;
+    size_t viewSize, viewStride;
+    if (!GetBufferView(ctx, acc.GetInt("bufferView", -1), viewData, viewSize, viewStride))
+        return false;
+    size_t offset = GetSize(acc, "byteOffset");
+    out.stride = viewStride ? viewStride : elemSize;
+    if (out.count > 0 && (offset > viewSize || (out.count - 1) * out.stride + elemSize > viewSize - offset))
+        return false;
+    out.data = viewData + offset;
+    return true;
+}
+
+// area weighted normals for primitives that come without NORMAL
+static void GenerateNormals(std::vector<SimpleVertex> &verts, const std::vector<unsigned int> &inds)
+{
+    for (auto &v : verts)
+        v.normal = glm::vec3(0.0f);
+    for (size_t i = 0; i + 2 < inds.size(); i += 3)
+    {
+        SimpleVertex &a = verts[inds[i]], &b = verts[inds[i + 1]], &c = verts[inds[i + 2]];
+        glm::vec3 n = glm::cross(b.pos - a.pos, c.pos - a.pos);
+        a.normal += n;
+        b.normal += n;
+        c.normal += n;
+    }
+    for (auto &v : verts)
+    {
+        float len = glm::length(v.normal);
+        v.normal = len > 0.0f ? v.normal / len : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+static bool LoadPrimitive(const GltfContext &ctx, const JsonValue &prim, GltfPrimitive &out)
+{
+    if (prim.GetInt("mode", 4) != 4)
+    {
+        std::cerr << "GltfLoader: skipping non-triangle primitive in " << ctx.path << "\n";
+        return false;
+    }
+    const JsonValue &attrs = prim["attributes"];
+    AccessorView pos, nrm, uv;
+    if (!GetAccessor(ctx, attrs.GetInt("POSITION", -1), pos) || pos.components != 3)
+    {
+        std::cerr << "GltfLoader: primitive without usable POSITION in " << ctx.path << "\n";
+        return false;
+    }
+    bool hasNormal = attrs.Find("NORMAL") && GetAccessor(ctx, attrs.GetInt("NORMAL", -1), nrm) &&
+                     nrm.components == 3 && nrm.count == pos.count;
+    bool hasUV = attrs.Find("TEXCOORD_0") && GetAccessor(ctx, attrs.GetInt("TEXCOORD_0", -1), uv) &&
+                 uv.components == 2 && uv.count == pos.count;
+    out.material = prim.GetInt("material", -1);
+    out.vertexCount = (uint32_t)pos.count;
+
+    // already interleaved exactly like SimpleVertex: use the mapped bytes as they are
+    out.vertexZeroCopy = hasNormal && hasUV && pos.componentType == kFloat && nrm.componentType == kFloat &&
+                         uv.componentType == kFloat && pos.stride == sizeof(SimpleVertex) &&
+                         nrm.stride == sizeof(SimpleVertex) && uv.stride == sizeof(SimpleVertex) &&
+                         nrm.data == pos.data + offsetof(SimpleVertex, normal) &&
+                         uv.data == pos.data + offsetof(SimpleVertex, uv) &&
+                         reinterpret_cast<uintptr_t>(pos.data) % alignof(SimpleVertex) == 0;
+    if (out.vertexZeroCopy)
+        out.vertices = reinterpret_cast<const SimpleVertex *>(pos.data);
+    else
+    {
+        out.ownedVertices.resize(pos.count);
+        for (size_t i = 0; i < pos.count; ++i)
+        {
+            SimpleVertex &v = out.ownedVertices[i];
+            const unsigned char *p = pos.data + i * pos.stride;
+            size_t cs = ComponentSize(pos.componentType);
+            v.pos = glm::vec3(ReadComponent(p, pos.componentType, pos.normalized),
+                              ReadComponent(p + cs, pos.componentType, pos.normalized),
+                              ReadComponent(p + 2 * cs, pos.componentType, pos.normalized));
+            if (hasNormal)
+            {
+                p = nrm.data + i * nrm.stride;
+                cs = ComponentSize(nrm.componentType);
+                v.normal = glm::vec3(ReadComponent(p, nrm.componentType, nrm.normalized),
+                                     ReadComponent(p + cs, nrm.componentType, nrm.normalized),
+                                     ReadComponent(p + 2 * cs, nrm.componentType, nrm.normalized));
+            }
+            if (hasUV)
+            {
+                p = uv.data + i * uv.stride;
+                cs = ComponentSize(uv.componentType);
+                // glTF UVs have their origin top-left like the decoded images, no flip needed
+                v.uv = glm::vec2(ReadComponent(p, uv.componentType, uv.normalized),
+                                 ReadComponent(p + cs, uv.componentType, uv.normalized));
+            }
+            else
+                v.uv = glm::vec2(0.0f);
+        }
+    }
+
+    const JsonValue *indicesIdx = prim.Find("indices");
+    if (indicesIdx)
+    {
+        AccessorView idx;
+        if (!GetAccessor(ctx, (int)indicesIdx->AsNumber(-1), idx) || idx.components != 1 ||
+            (idx.componentType != kUnsignedByte && idx.componentType != kUnsignedShort &&
+             idx.componentType != kUnsignedInt))
+        {
+            std::cerr << "GltfLoader: bad index accessor in " << ctx.path << "\n";
+            return false;
+        }
+        size_t is = ComponentSize(idx.componentType);
+        out.ownedIndices.resize(idx.count);
+        for (size_t i = 0; i < idx.count; ++i)
+        {
+            uint32_t v = ReadIndex(idx.data + i * idx.stride, idx.componentType);
+            if (v >= out.vertexCount)
+            {
+                std::cerr << "GltfLoader: index out of range in " << ctx.path << "\n";
+                return false;
+            }
+            out.ownedIndices[i] = v;
+        }
+        if (idx.componentType == kUnsignedShort && idx.stride == is &&
+            reinterpret_cast<uintptr_t>(idx.data) % alignof(uint16_t) == 0)
+            out.shortIndices = reinterpret_cast<const uint16_t *>(idx.data);
+    }
+    else
+    {
+        out.ownedIndices.resize(pos.count);
+        for (size_t i = 0; i < pos.count; ++i)
+            out.ownedIndices[i] = (unsigned int)i;
+    }
+    out.ownedIndices.resize(out.ownedIndices.size() / 3 * 3);
+    out.indexCount = (uint32_t)out.ownedIndices.size();
+    if (out.shortIndices && out.indexCount == 0)
+        out.shortIndices = nullptr;
+
+    if (!hasNormal)
+        GenerateNormals(out.ownedVertices, out.ownedIndices);
+    return true;
+}
+
+static glm::mat4 NodeTransform(const JsonValue &node)
+{
+    const JsonValue &m = node["matrix"];
+    if (m.Size() == 16)
+    {
+        float f[16];
+        for (size_t i = 0; i < 16; ++i)
+            f[i] = (float)m[i].AsNumber(0.0);
+        return glm::make_mat4(f); // column-major, same as glTF
+    }
+    glm::vec3 t(0.0f), s(1.0f);
+    glm::quat r(1.0f, 0.0f, 0.0f, 0.0f);
+    const JsonValue &jt = node["translation"];
+    if (jt.Size() == 3)
+        t = glm::vec3(jt[0].AsNumber(), jt[1].AsNumber(), jt[2].AsNumber());
+    const JsonValue &jr = node["rotation"];
+    if (jr.Size() == 4) // x, y, z, w
+        r = glm::quat((float)jr[3].AsNumber(1.0), (float)jr[0].AsNumber(), (float)jr[1].AsNumber(), (float)jr[2].AsNumber());
+    const JsonValue &js = node["scale"];
+    if (js.Size() == 3)
+        s = glm::vec3(js[0].AsNumber(1.0), js[1].AsNumber(1.0), js[2].AsNumber(1.0));
+    return glm::translate(glm::mat4(1.0f), t) * glm::mat4_cast(r) * glm::scale(glm::mat4(1.0f), s);
+}
+
+// depth-first so parents always precede their children
+static void AppendNode(const GltfContext &ctx, int index, int32_t parent,
+                       const std::vector<std::pair<uint32_t, uint32_t>> &meshPrims,
+                       std::vector<char> &visited, GltfScene &out)
+{
+    const JsonValue &node = ctx.doc["nodes"][(size_t)index];
+    if (!node.IsObject() || visited[index])
+        return; // invalid or cyclic reference
+    visited[index] = 1;
+
+    int32_t self = (int32_t)out.nodes.size();
+    GltfNode nd;
+    nd.name = node.GetString("name", "node" + std::to_string(index));
+    nd.parent = parent;
+    nd.transform = NodeTransform(node);
+    int mesh = node.GetInt("mesh", -1);
+    if (mesh >= 0 && (size_t)mesh < meshPrims.size())
+    {
+        for (uint32_t p = 0; p < meshPrims[mesh].second; ++p)
+            nd.primitives.push_back(meshPrims[mesh].first + p);
+    }
+    out.nodes.push_back(nd);
+
+    const JsonValue &children = node["children"];
+    for (size_t c = 0; c < children.Size(); ++c)
+        AppendNode(ctx, (int)children[c].AsNumber(-1), self, meshPrims, visited, out);
+}
+
+bool LoadGltf(const std::string &path, GltfScene &out)
+{
+    out = GltfScene();
+    GltfContext ctx;
+    ctx.path = path;
+    ctx.scene = &out;
+    size_t slash = path.find_last_of("/\\");
+    ctx.directory = (slash == std::string::npos) ? "." : path.substr(0, slash);
+
+    std::unique_ptr<AssetData> file(new AssetData());
+    if (!ReadAsset(path, *file))
+    {
+        std::cerr << "GltfLoader: cannot open " << path << "\n";
+        return false;
+    }
+    const unsigned char *bytes = file->Data();
+    size_t size = file->Size();
+
+    const char *json = (const char *)bytes;
+    size_t jsonSize = size;
+    GltfBuffer glbChunk;
+    uint32_t magic = 0;
+    if (size >= 12)
+        std::memcpy(&magic, bytes, 4);
+    if (magic == kGlbMagic)
+    {
+        // 12 byte header, then JSON chunk, then an optional BIN chunk
+        json = nullptr;
+        size_t off = 12;
+        while (off + 8 <= size)
+        {
+            uint32_t chunkLen, chunkType;
+            std::memcpy(&chunkLen, bytes + off, 4);
+            std::memcpy(&chunkType, bytes + off + 4, 4);
+            off += 8;
+            if (chunkLen > size - off)
+                break;
+            if (chunkType == kChunkJson && !json)
+            {
+                json = (const char *)bytes + off;
+                jsonSize = chunkLen;
+            }
+            else if (chunkType == kChunkBin && !glbChunk.data)
+            {
+                glbChunk.data = bytes + off;
+                glbChunk.size = chunkLen;
+            }
+            off += (chunkLen + 3) & ~(size_t)3;
+        }
+        if (!json)
+        {
+            std::cerr << "GltfLoader: GLB without JSON chunk: " << path << "\n";
+            return false;
+        }
+    }
+    out.files.push_back(std::move(file));
+
+    std::string error;
+    if (!JsonValue::Parse(json, jsonSize, ctx.doc, error))
+    {
+        std::cerr << "GltfLoader: " << path << ": " << error << "\n";
+        return false;
+    }
+    if (!LoadBuffers(ctx, glbChunk))
+        return false;
+
+    // images and materials
+    const JsonValue &images = ctx.doc["images"];
+    for (size_t i = 0; i < images.Size(); ++i)
+    {
+        GltfImage img;
+        const JsonValue *uri = images[i].Find("uri");
+        if (uri && uri->AsString().compare(0, 5, "data:") == 0)
+        {
+            GltfBuffer buf;
+            if (LoadUri(ctx, uri->AsString(), buf))
+            {
+                img.data = buf.data;
+                img.size = buf.size;
+            }
+        }
+        else if (uri)
+            img.uri = DecodeUri(uri->AsString());
+        else
+        {
+            size_t stride;
+            if (!GetBufferView(ctx, images[i].GetInt("bufferView", -1), img.data, img.size, stride))
+                img.data = nullptr;
+        }
+        out.images.push_back(img);
+    }
+    const JsonValue &textures = ctx.doc["textures"];
+    const JsonValue &materials = ctx.doc["materials"];
+    for (size_t i = 0; i < materials.Size(); ++i)
+    {
+        const JsonValue &m = materials[i];
+        GltfMaterial mat;
+        mat.name = m.GetString("name", "material" + std::to_string(i));
+        const JsonValue &pbr = m["pbrMetallicRoughness"];
+        const JsonValue &factor = pbr["baseColorFactor"];
+        if (factor.Size() == 4)
+            mat.baseColor = glm::vec4(factor[0].AsNumber(1.0), factor[1].AsNumber(1.0), factor[2].AsNumber(1.0),
+                                      factor[3].AsNumber(1.0));
+        const JsonValue *tex = pbr["baseColorTexture"].Find("index");
+        if (tex)
+        {
+            int source = textures[(size_t)(int)tex->AsNumber(-1)].GetInt("source", -1);
+            if (source >= 0 && (size_t)source < out.images.size())
+                mat.image = source;
+        }
+        std::string alphaMode = m.GetString("alphaMode", "OPAQUE");
+        mat.blend = alphaMode == "BLEND";
+        mat.mask = alphaMode == "MASK";
+        mat.alphaCutoff = (float)m.GetNumber("alphaCutoff", 0.5);
+        out.materials.push_back(mat);
+    }
+
+    // primitives of every mesh, as (first, count) ranges per mesh
+    const JsonValue &meshes = ctx.doc["meshes"];
+    std::vector<std::pair<uint32_t, uint32_t>> meshPrims(meshes.Size());
+    for (size_t m = 0; m < meshes.Size(); ++m)
+    {
+        meshPrims[m].first = (uint32_t)out.primitives.size();
+        const JsonValue &prims = meshes[m]["primitives"];
+        for (size_t p = 0; p < prims.Size(); ++p)
+        {
+            GltfPrimitive prim;
+            if (!LoadPrimitive(ctx, prims[p], prim))
+                continue;
+            if (prim.material >= (int)out.materials.size())
+                prim.material = -1;
+            out.primitives.push_back(std::move(prim));
+        }
+        meshPrims[m].second = (uint32_t)out.primitives.size() - meshPrims[m].first;
+    }
+    if (out.primitives.empty())
+    {
+        std::cerr << "GltfLoader: no triangle primitives in " << path << "\n";
+        return false;
+    }
+    // pointers into the owned vectors, now that the primitives no longer move
+    for (auto &prim : out.primitives)
+    {
+        if (!prim.vertexZeroCopy)
+            prim.vertices = prim.ownedVertices.data();
+        prim.indices = prim.ownedIndices.data();
+    }
+
+    // node hierarchy of the default scene under one root named after the file
+    const JsonValue &nodes = ctx.doc["nodes"];
+    GltfNode root;
+    root.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    out.nodes.push_back(root);
+    std::vector<char> visited(nodes.Size(), 0);
+    const JsonValue &scenes = ctx.doc["scenes"];
+    const JsonValue &sceneNodes = scenes[(size_t)ctx.doc.GetInt("scene", 0)]["nodes"];
+    if (sceneNodes.Size() > 0)
+    {
+        for (size_t i = 0; i < sceneNodes.Size(); ++i)
+            AppendNode(ctx, (int)sceneNodes[i].AsNumber(-1), 0, meshPrims, visited, out);
+    }
+    else
+    {
+        // no scene: every node that is nobody's child is a root
+        std::vector<char> isChild(nodes.Size(), 0);
+        for (size_t i = 0; i < nodes.Size(); ++i)
+        {
+            const JsonValue &children = nodes[i]["children"];
+            for (size_t c = 0; c < children.Size(); ++c)
+            {
+                int child = (int)children[c].AsNumber(-1);
+                if (child >= 0 && (size_t)child < nodes.Size())
+                    isChild[child] = 1;
+            }
+        }
+        for (size_t i = 0; i < nodes.Size(); ++i)
+        {
+            if (!isChild[i])
+                AppendNode(ctx, (int)i, 0, meshPrims, visited, out);
+        }
+    }
+    if (nodes.Size() == 0)
+    {
+        // meshes without nodes: hang every primitive off the root
+        for (uint32_t p = 0; p < out.primitives.size(); ++p)
+            out.nodes[0].primitives.push_back(p);
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+// src/GltfLoader.h
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "AssetPack.h"
+#include "StaticModel.h"
+
+struct GltfMaterial
+{
+    std::string name;
+    glm::vec4 baseColor = glm::vec4(1.0f); // pbrMetallicRoughness.baseColorFactor
+    int image = -1;                        // base colour texture, index into GltfScene::images
+    bool blend = false;                    // alphaMode BLEND
+    bool mask = false;                     // alphaMode MASK
+    float alphaCutoff = 0.5f;
+};
+
+// Encoded image: an external file, or bytes inside a buffer (GLB chunk or data: URI)
+struct GltfImage
+{
+    std::string uri; // relative to the .gltf, empty when embedded
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+};
+
+// One triangle primitive. vertices / shortIndices point into the mapped file when the accessors
+// already have the GPU layout (interleaved SimpleVertex floats, 16-bit indices) and into the
+// owned vectors otherwise. indices is always valid for CPU-side users.
+struct GltfPrimitive
+{
+    const SimpleVertex *vertices = nullptr;
+    uint32_t vertexCount = 0;
+    const unsigned int *indices = nullptr;
+    uint32_t indexCount = 0;
+    const uint16_t *shortIndices = nullptr; // 16-bit indices straight from the buffer, or nullptr
+    int material = -1;
+    bool vertexZeroCopy = false;
+
+    std::vector<SimpleVertex> ownedVertices;
+    std::vector<unsigned int> ownedIndices;
+};
+
+// Flattened node hierarchy of the default scene, parents before children.
+struct GltfNode
+{
+    std::string name;
+    int32_t parent = -1;
+    glm::mat4 transform = glm::mat4(1.0f);
+    std::vector<uint32_t> primitives;
+};
+
+struct GltfScene
+{
+    std::vector<GltfMaterial> materials;
+    std::vector<GltfImage> images;
+    std::vector<GltfPrimitive> primitives;
+    std::vector<GltfNode> nodes; // nodes[0] is the root
+
+    // keep the .glb / .bin bytes (and decoded data: URIs) alive for the pointers above
+    std::vector<std::unique_ptr<AssetData>> files;
+    std::vector<std::vector<unsigned char>> ownedBuffers;
+};
+
+// Native glTF 2.0 reader for .gltf (JSON + external or data: buffers) and .glb (binary chunk is
+// mapped, not copied). Only what StaticModel draws is read: triangle primitives with POSITION,
+// NORMAL, TEXCOORD_0 and indices, the base colour of each material and the node hierarchy.
+bool LoadGltf(const std::string &path, GltfScene &out);
@@ -0,0 +1,198 @@
+// src/HotReload.cpp
+#include "HotReload.h"
+#include "AssetPack.h"
+#include <filesystem>
+#include <iostream>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static std::string Normalize(const std::string &path)
+{
+    std::error_code ec;
+    fs::path p = fs::absolute(fs::path(path), ec);
+    if (ec)
+        p = fs::path(path);
+    p = p.lexically_normal();
+    if (!p.has_filename() && p.has_parent_path())
+        p = p.parent_path(); // "dir/" -> "dir"
+    return p.generic_string();
+}
+
+// hidden, backup and temporary files (editors' swap files, the bakers' .tmp before the rename) and
+// the cooked artifacts the reloads themselves write
+static bool IgnoredName(const std::string &name)
+{
+    if (name.empty() || name[0] == '.' || name.back() == '~')
+        return true;
+    size_t dot = name.find_last_of('.');
+    std::string ext = (dot == std::string::npos) ? "" : name.substr(dot);
+    return ext == ".tmp" || ext == ".swp" || ext == ".swx" || ext == ".smc" || ext == ".btx" || ext == ".pcm" ||
+           ext == ".atlas";
+}
+
+HotReload &HotReload::Instance()
+{
+    static HotReload watcher;
+    return watcher;
+}
+
+void HotReload::AddListener(Listener listener)
+{
+    listeners.push_back(std::move(listener));
+}
+
+bool HotReload::AddDirectory(const std::string &path, const std::string &mirror)
+{
+#ifdef __linux__
+    int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (wd < 0)
+    {
+        std::cerr << "HotReload: cannot watch " << path << " (" << strerror(errno) << ")\n";
+        return false;
+    }
+    dirs[wd] = WatchedDir{path, mirror};
+    return true;
+#else
+    (void)path;
+    (void)mirror;
+    return false;
+#endif
+}
+
+bool HotReload::Watch(const std::string &dir, const std::string &mirrorDir)
+{
+#ifdef __linux__
+    if (fd < 0)
+    {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+        {
+            std::cerr << "HotReload: inotify unavailable (" << strerror(errno) << ")\n";
+            return false;
+        }
+    }
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec))
+        return false;
+    std::string root = Normalize(dir);
+    std::string mirrorRoot = mirrorDir.empty() ? "" : Normalize(mirrorDir);
+    size_t before = dirs.size();
+    bool ok = AddDirectory(root, mirrorRoot);
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         it != end && !ec; it.increment(ec))
+    {
+        if (!it->is_directory(ec))
+            continue;
+        std::string sub = Normalize(it->path().string());
+        ok = AddDirectory(sub, mirrorRoot.empty() ? "" : mirrorRoot + sub.substr(root.size())) && ok;
+    }
+    std::cout << "HotReload: watching " << dirs.size() - before << " directories under " << root
+              << (mirrorRoot.empty() ? "" : " (copied to " + mirrorRoot + ")") << std::endl;
+    return ok;
+#else
+    (void)dir;
+    (void)mirrorDir;
+    std::cerr << "HotReload: file watching needs inotify, assets will not reload\n";
+    return false;
+#endif
+}
+
+void HotReload::Poll()
+{
+#ifdef __linux__
+    if (fd < 0)
+        return;
+    Clock::time_point now = Clock::now();
+    alignas(inotify_event) char buf[4096];
+    for (;;)
+    {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0)
+            break; // EAGAIN: nothing more to read
+        for (char *p = buf; p < buf + n;)
+        {
+            const inotify_event *ev = (const inotify_event *)p;
+            p += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                std::cerr << "HotReload: event queue overflowed, some changes were missed\n";
+                continue;
+            }
+            if (ev->mask & IN_IGNORED)
+            {
+                dirs.erase(ev->wd); // directory deleted
+                continue;
+            }
+            auto it = dirs.find(ev->wd);
+            if (it == dirs.end() || ev->len == 0)
+                continue;
+            std::string name = ev->name;
+            if (IgnoredName(name))
+                continue;
+            WatchedDir dir = it->second; // copied: AddDirectory may rehash dirs
+            std::string path = dir.path + "/" + name;
+            std::string mirror = dir.mirror.empty() ? "" : dir.mirror + "/" + name;
+            if (ev->mask & IN_ISDIR)
+            {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddDirectory(path, mirror);
+                continue;
+            }
+            if (ev->mask & IN_CREATE)
+                continue; // the write that follows is what counts
+            Change &c = changed[path];
+            c.last = now;
+            c.mirror = mirror;
+        }
+    }
+
+    for (auto it = changed.begin(); it != changed.end();)
+    {
+        if (now - it->second.last < std::chrono::milliseconds(kSettleMs))
+        {
+            ++it;
+            continue;
+        }
+        std::string path = it->first;
+        std::string mirror = it->second.mirror;
+        it = changed.erase(it);
+        Settled(path, mirror);
+    }
+#endif
+}
+
+void HotReload::Settled(const std::string &path, const std::string &mirror)
+{
+    if (!mirror.empty())
+    {
+        // the build tree copy is watched too and reported from there
+        std::error_code ec;
+        fs::create_directories(fs::path(mirror).parent_path(), ec);
+        fs::copy_file(path, mirror, fs::copy_options::overwrite_existing, ec);
+        if (ec)
+            std::cerr << "HotReload: cannot copy " << path << " to " << mirror << " (" << ec.message() << ")\n";
+        return;
+    }
+    std::cout << "HotReload: " << path << " changed" << std::endl;
+    AssetPack::Instance().Override(path);
+    for (const auto &listener : listeners)
+        listener(path);
+}
+
+void HotReload::Shutdown()
+{
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+    fd = -1;
+    dirs.clear();
+    changed.clear();
+    listeners.clear();
+}
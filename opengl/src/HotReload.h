@@ -0,0 +1,62 @@
+// src/HotReload.h
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Development-time file watcher (inotify; on other platforms Watch() fails and nothing is ever
+// reported). When a watched file is saved, Poll() hands its path to the listeners at the next frame
+// boundary, which reload just that asset: ResourceManager the models, TextureCache the textures,
+// main the shader programs. Everything else stays as it is.
+//
+// Editors save in several steps (truncate and write, or write a temporary file and rename it over),
+// so a path is reported once it has been quiet for kSettleMs. Before the listeners run, the file
+// stops being served from assets.pak, whose copy is now stale.
+// A directory can mirror another one: a file saved under the source tree is copied over the build
+// tree copy the game reads (watched as well), and that copy is what gets reported.
+class HotReload
+{
+public:
+    using Listener = std::function<void(const std::string &path)>;
+
+    static HotReload &Instance();
+
+    // watch dir and every directory below it (new ones included); with mirrorDir, changed files are
+    // copied to the same relative path under mirrorDir instead of being reported
+    bool Watch(const std::string &dir, const std::string &mirrorDir = "");
+    void AddListener(Listener listener);
+    // GL thread, once per frame: read the notifications (never blocks) and report settled files
+    void Poll();
+    void Shutdown();
+
+    static const int kSettleMs = 150;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    HotReload() = default;
+    HotReload(const HotReload &) = delete;
+    HotReload &operator=(const HotReload &) = delete;
+
+    struct WatchedDir
+    {
+        std::string path;   // normalized, '/' separators
+        std::string mirror; // same directory under the mirror root, empty if none
+    };
+
+    struct Change
+    {
+        Clock::time_point last; // last write seen
+        std::string mirror;     // where to copy the file, empty: report it
+    };
+
+    bool AddDirectory(const std::string &path, const std::string &mirror);
+    void Settled(const std::string &path, const std::string &mirror);
+
+    int fd = -1;
+    std::unordered_map<int, WatchedDir> dirs;        // inotify watch descriptor -> directory
+    std::unordered_map<std::string, Change> changed; // files waiting to settle
+    std::vector<Listener> listeners;
+};
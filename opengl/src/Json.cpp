@@ -0,0 +1,334 @@
+// src/Json.cpp
+#include "Json.h"
+#include <cstdlib>
+#include <cstring>
+
+// nesting limit so a hostile file cannot overflow the stack
+static const int kMaxDepth = 256;
+
+class JsonParser
+{
+public:
+    JsonParser(const char *text, size_t size) : p(text), begin(text), end(text + size) {}
+
+    bool Document(JsonValue &out)
+    {
+        SkipSpace();
+        if (!Value(out, 0))
+            return false;
+        SkipSpace();
+        if (p != end)
+            return Fail("trailing characters");
+        return true;
+    }
+
+    std::string error;
+
+private:
+    const char *p;
+    const char *begin;
+    const char *end;
+
+    bool Fail(const char *what)
+    {
+        if (error.empty())
+            error = std::string(what) + " at offset " + std::to_string(p - begin);
+        return false;
+    }
+
+    void SkipSpace()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    }
+
+    bool Literal(const char *word)
+    {
+        size_t n = std::strlen(word);
+        if ((size_t)(end - p) < n || std::memcmp(p, word, n) != 0)
+            return Fail("invalid literal");
+        p += n;
+        return true;
+    }
+
+    bool Value(JsonValue &out, int depth)
+    {
+        if (depth > kMaxDepth)
+            return Fail("nesting too deep");
+        if (p >= end)
+            return Fail("unexpected end");
+        switch (*p)
+        {
+        case '{':
+            return Object(out, depth);
+        case '[':
+            return Array(out, depth);
+        case '"':
+            out.type = JsonValue::Type::String;
+            return String(out.str);
+        case 't':
+            out.type = JsonValue::Type::Bool;
+            out.boolean = true;
+            return Literal("true");
+        case 'f':
+            out.type = JsonValue::Type::Bool;
+            out.boolean = false;
+            return Literal("false");
+        case 'n':
+            out.type = JsonValue::Type::Null;
+            return Literal("null");
+        default:
+            return Number(out);
+        }
+    }
+
+    bool Number(JsonValue &out)
+    {
+        // strtod needs a terminated buffer; numbers are short, copy the token
+        const char *start = p;
+        while (p < end && (std::strchr("+-0123456789.eE", *p) != nullptr))
+            ++p;
+        if (p == start || p - start > 64)
+            return Fail("invalid number");
+        char buf[72];
+        std::memcpy(buf, start, (size_t)(p - start));
+        buf[p - start] = '\0';
+        char *stop = nullptr;
+        out.type = JsonValue::Type::Number;
+        out.number = std::strtod(buf, &stop);
+        if (stop != buf + (p - start))
+            return Fail("invalid number");
+        return true;
+    }
+
+    static void AppendUtf8(std::string &s, unsigned long cp)
+    {
+        if (cp < 0x80)
+            s += (char)cp;
+        else if (cp < 0x800)
+        {
+            s += (char)(0xC0 | (cp >> 6));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            s += (char)(0xE0 | (cp >> 12));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            s += (char)(0xF0 | (cp >> 18));
+            s += (char)(0x80 | ((cp >> 12) & 0x3F));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool Hex4(unsigned long &out)
+    {
+        if (end - p < 4)
+            return Fail("bad escape");
+        out = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = *p++;
+            out <<= 4;
+            if (c >= '0' && c <= '9')
+                out |= (unsigned long)(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                out |= (unsigned long)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                out |= (unsigned long)(c - 'A' + 10);
+            else
+                return Fail("bad escape");
+        }
+        return true;
+    }
+
+    bool String(std::string &out)
+    {
+        ++p; // opening quote
+        out.clear();
+        for (;;)
+        {
+            const char *run = p;
+            while (p < end && *p != '"' && *p != '\\')
+                ++p;
+            out.append(run, p);
+            if (p >= end)
+                return Fail("unterminated string");
+            if (*p++ == '"')
+                return true;
+            if (p >= end)
+                return Fail("unterminated string");
+            char c = *p++;
+            switch (c)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                out += c;
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u':
+            {
+                unsigned long cp;
+                if (!Hex4(cp))
+                    return false;
+                // surrogate pair
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                {
+                    p += 2;
+                    unsigned long lo;
+                    if (!Hex4(lo))
+                        return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                AppendUtf8(out, cp);
+                break;
+            }
+            default:
+                return Fail("bad escape");
+            }
+        }
+    }
+
+    bool Array(JsonValue &out, int depth)
+    {
+        ++p;
+        out.type = JsonValue::Type::Array;
+        SkipSpace();
+        if (p < end && *p == ']')
+        {
+            ++p;
+            return true;
+        }
+        for (;;)
+        {
+            SkipSpace();
+            out.items.emplace_back();
+            if (!Value(out.items.back(), depth + 1))
+                return false;
+            SkipSpace();
+            if (p < end && *p == ',')
+            {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == ']')
+            {
+                ++p;
+                return true;
+            }
+            return Fail("expected , or ]");
+        }
+    }
+
+    bool Object(JsonValue &out, int depth)
+    {
+        ++p;
+        out.type = JsonValue::Type::Object;
+        SkipSpace();
+        if (p < end && *p == '}')
+        {
+            ++p;
+            return true;
+        }
+        for (;;)
+        {
+            SkipSpace();
+            if (p >= end || *p != '"')
+                return Fail("expected member name");
+            out.members.emplace_back();
+            if (!String(out.members.back().first))
+                return false;
+            SkipSpace();
+            if (p >= end || *p != ':')
+                return Fail("expected :");
+            ++p;
+            SkipSpace();
+            if (!Value(out.members.back().second, depth + 1))
+                return false;
+            SkipSpace();
+            if (p < end && *p == ',')
+            {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == '}')
+            {
+                ++p;
+                return true;
+            }
+            return Fail("expected , or }");
+        }
+    }
+};
+
+bool JsonValue::Parse(const char *text, size_t size, JsonValue &out, std::string &error)
+{
+    out = JsonValue();
+    JsonParser parser(text, size);
+    if (!parser.Document(out))
+    {
+        error = parser.error;
+        out = JsonValue();
+        return false;
+    }
+    return true;
+}
+
+const JsonValue &JsonValue::Empty()
+{
+    static const JsonValue empty;
+    return empty;
+}
+
+const JsonValue *JsonValue::Find(const std::string &key) const
+{
+    for (const auto &m : members)
+    {
+        if (m.first == key)
+            return &m.second;
+    }
+    return nullptr;
+}
+
+const JsonValue &JsonValue::operator[](const std::string &key) const
+{
+    const JsonValue *v = Find(key);
+    return v ? *v : Empty();
+}
+
+double JsonValue::GetNumber(const std::string &key, double fallback) const
+{
+    const JsonValue *v = Find(key);
+    return v ? v->AsNumber(fallback) : fallback;
+}
+
+int JsonValue::GetInt(const std::string &key, int fallback) const
+{
+    const JsonValue *v = Find(key);
+    return (v && v->IsNumber()) ? (int)v->number : fallback;
+}
+
+std::string JsonValue::GetString(const std::string &key, const std::string &fallback) const
+{
+    const JsonValue *v = Find(key);
+    return (v && v->IsString()) ? v->str : fallback;
+}
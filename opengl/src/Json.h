@@ -0,0 +1,61 @@
+// src/Json.h
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small read-only JSON DOM, enough for glTF and the asset manifests. Object members keep file order.
+// Accessors never throw: a missing member or wrong type yields the fallback / an empty value.
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    // parse a whole document; on failure error describes the problem and its byte offset
+    static bool Parse(const char *text, size_t size, JsonValue &out, std::string &error);
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Type::Null; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsString() const { return type == Type::String; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    double AsNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    bool AsBool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+    const std::string &AsString() const { return str; }
+
+    // array elements (empty unless IsArray())
+    size_t Size() const { return items.size(); }
+    const JsonValue &operator[](size_t i) const { return i < items.size() ? items[i] : Empty(); }
+    const std::vector<JsonValue> &Items() const { return items; }
+
+    // object members; Find returns nullptr when the key is missing
+    const JsonValue *Find(const std::string &key) const;
+    const JsonValue &operator[](const std::string &key) const;
+    const std::vector<std::pair<std::string, JsonValue>> &Members() const { return members; }
+
+    double GetNumber(const std::string &key, double fallback) const;
+    int GetInt(const std::string &key, int fallback) const;
+    std::string GetString(const std::string &key, const std::string &fallback = std::string()) const;
+
+private:
+    friend class JsonParser;
+    static const JsonValue &Empty();
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string str;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
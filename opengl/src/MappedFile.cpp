@@ -0,0 +1,80 @@
+// src/MappedFile.cpp
+#include "MappedFile.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart == 0)
+    {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m)
+    {
+        CloseHandle(f);
+        return false;
+    }
+    void *view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    fileHandle = f;
+    mappingHandle = m;
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(sz.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (p == MAP_FAILED)
+        return false;
+    data = static_cast<const unsigned char *>(p);
+    size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,31 @@
+// src/MappedFile.h
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only mapping of a whole file into memory (mmap on Unix/Mac, MapViewOfFile on Windows).
+// The pointer returned by Data() stays valid until Close() or destruction.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // returns false if the file is missing, empty or cannot be mapped
+    bool Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char *Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,362 @@
+// src/MeshCache.cpp
+#include "MeshCache.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char kMagic[8] = {'S', 'M', 'C', 'A', 'C', 'H', 'E', '\0'};
+// 2: meshes stored in MeshOptimizer order, 3: flat node table, 4: simplified LOD index ranges,
+// 5: MeshCodec-compressed vertex/index streams, 6: UV density per mesh
+static const uint32_t kVersion = 6;
+
+static uint64_t Fnv1a(const unsigned char *p, size_t n, uint64_t h)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::string MeshCache::CachePathFor(const std::string &modelPath)
+{
+    return modelPath + ".smc";
+}
+
+// mtllib references of an .obj, resolved against its directory
+static std::vector<std::string> MaterialLibraries(const std::string &modelPath, const AssetData &src)
+{
+    std::vector<std::string> libs;
+    size_t dot = modelPath.find_last_of('.');
+    std::string ext = (dot == std::string::npos) ? "" : modelPath.substr(dot + 1);
+    for (auto &c : ext)
+        c = (char)tolower(c);
+    if (ext != "obj")
+        return libs;
+
+    size_t slash = modelPath.find_last_of("/\\");
+    std::string dir = (slash == std::string::npos) ? "." : modelPath.substr(0, slash);
+    const char *text = (const char *)src.Data();
+    size_t n = src.Size();
+    for (size_t i = 0; i + 7 < n; ++i)
+    {
+        bool lineStart = (i == 0 || text[i - 1] == '\n');
+        if (!lineStart || strncmp(text + i, "mtllib ", 7) != 0)
+            continue;
+        size_t b = i + 7, e = b;
+        while (e < n && text[e] != '\n' && text[e] != '\r')
+            ++e;
+        std::string lib(text + b, e - b);
+        while (!lib.empty() && lib.back() == ' ')
+            lib.pop_back();
+        libs.push_back(dir + "/" + lib);
+        i = e;
+    }
+    return libs;
+}
+
+uint64_t MeshCache::HashSource(const std::string &modelPath)
+{
+    AssetData src;
+    if (!ReadAsset(modelPath, src))
+        return 0;
+    uint64_t h = Fnv1a(src.Data(), src.Size(), 14695981039346656037ull);
+
+    // material libraries change textures/colours without touching the .obj itself
+    for (const auto &lib : MaterialLibraries(modelPath, src))
+    {
+        AssetData mtl;
+        if (ReadAsset(lib, mtl))
+            h = Fnv1a(mtl.Data(), mtl.Size(), h);
+    }
+    return h;
+}
+
+std::vector<std::string> MeshCache::Dependencies(const std::string &modelPath)
+{
+    AssetData src;
+    if (!ReadAsset(modelPath, src))
+        return {};
+    return MaterialLibraries(modelPath, src);
+}
+
+// ---- writer helpers ----
+template <typename T>
+static void Put(std::vector<unsigned char> &buf, const T &v)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(&v);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+static void PutBytes(std::vector<unsigned char> &buf, const void *p, size_t n)
+{
+    const unsigned char *b = static_cast<const unsigned char *>(p);
+    buf.insert(buf.end(), b, b + n);
+}
+
+static void PutString(std::vector<unsigned char> &buf, const std::string &s)
+{
+    Put(buf, (uint32_t)s.size());
+    PutBytes(buf, s.data(), s.size());
+}
+
+// blobs are 16-byte aligned so the decoder reads aligned blocks straight from the mapping
+static void Align(std::vector<unsigned char> &buf)
+{
+    while (buf.size() % 16)
+        buf.push_back(0);
+}
+
+bool MeshCache::Write(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, const MeshCacheData &data)
+{
+    std::vector<unsigned char> buf;
+    PutBytes(buf, kMagic, sizeof(kMagic));
+    Put(buf, kVersion);
+    Put(buf, importFlags);
+    Put(buf, sourceHash);
+    Put(buf, (uint32_t)data.meshes.size());
+    Put(buf, (uint32_t)data.nodes.size());
+    Put(buf, (uint32_t)data.nodeMeshes.size());
+    Put(buf, (uint32_t)data.nodeNames.size());
+    Put(buf, (uint32_t)(data.bboxInitialized ? 1 : 0));
+    Put(buf, data.bboxMin);
+    Put(buf, data.bboxMax);
+
+    // one quantization box for the whole model, so meshes keep sharing StaticModel's dequant matrix
+    std::vector<const SimpleVertex *> meshVertices;
+    std::vector<size_t> meshVertexCounts;
+    for (const auto &m : data.meshes)
+    {
+        meshVertices.push_back(m.vertices);
+        meshVertexCounts.push_back(m.vertexCount);
+    }
+    MeshQuantization quant = MeshQuantization::Compute(meshVertices, meshVertexCounts);
+    Put(buf, quant.posMin);
+    Put(buf, quant.posExtent);
+    Put(buf, quant.uvMin);
+    Put(buf, quant.uvExtent);
+
+    std::vector<unsigned char> encodedVertices, encodedIndices;
+    for (const auto &m : data.meshes)
+    {
+        Put(buf, m.vertexCount);
+        Put(buf, m.indexCount);
+        Put(buf, (uint8_t)m.hasAlpha);
+        Put(buf, (uint8_t)m.isHair);
+        Put(buf, (uint16_t)0);
+        Put(buf, m.alphaCutoff);
+        Put(buf, m.diffuseColor);
+        PutString(buf, m.diffusePath);
+        Put(buf, m.uvDensity);
+        Put(buf, m.lodCount);
+        for (uint32_t l = 0; l < m.lodCount; ++l)
+        {
+            Put(buf, m.lods[l].firstIndex);
+            Put(buf, m.lods[l].indexCount);
+            Put(buf, m.lods[l].error);
+        }
+        encodedVertices.clear();
+        encodedIndices.clear();
+        EncodeVertexBuffer(m.vertices, m.vertexCount, quant, encodedVertices);
+        EncodeIndexBuffer(m.indices, m.indexCount, encodedIndices);
+        Put(buf, (uint64_t)encodedVertices.size());
+        Put(buf, (uint64_t)encodedIndices.size());
+        Align(buf);
+        PutBytes(buf, encodedVertices.data(), encodedVertices.size());
+        Align(buf);
+        PutBytes(buf, encodedIndices.data(), encodedIndices.size());
+    }
+
+    for (const auto &nd : data.nodes)
+    {
+        Put(buf, nd.parent);
+        Put(buf, nd.transform);
+        Put(buf, nd.firstMesh);
+        Put(buf, nd.meshCount);
+        Put(buf, nd.nameId);
+        Put(buf, nd.pivot);
+    }
+    for (uint32_t mi : data.nodeMeshes)
+        Put(buf, mi);
+    for (const auto &name : data.nodeNames)
+        PutString(buf, name);
+
+    // write to a temp name first so a crash never leaves a truncated cache behind
+    std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "MeshCache: cannot write " << cachePath << "\n";
+            return false;
+        }
+        out.write((const char *)buf.data(), (std::streamsize)buf.size());
+        if (!out.good())
+        {
+            std::cerr << "MeshCache: write failed " << cachePath << "\n";
+            return false;
+        }
+    }
+    std::remove(cachePath.c_str());
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    AssetPack::Instance().Override(cachePath); // rewritten after the pack was built (hot reload)
+    return true;
+}
+
+// ---- reader ----
+namespace
+{
+    struct Reader
+    {
+        const unsigned char *base;
+        size_t size;
+        size_t pos = 0;
+        bool ok = true;
+
+        const unsigned char *Take(size_t n)
+        {
+            if (!ok || pos + n > size)
+            {
+                ok = false;
+                return nullptr;
+            }
+            const unsigned char *p = base + pos;
+            pos += n;
+            return p;
+        }
+        template <typename T>
+        T Get()
+        {
+            T v{};
+            if (const unsigned char *p = Take(sizeof(T)))
+                memcpy(&v, p, sizeof(T));
+            return v;
+        }
+        std::string GetString()
+        {
+            uint32_t n = Get<uint32_t>();
+            const unsigned char *p = Take(n);
+            return p ? std::string((const char *)p, n) : std::string();
+        }
+        void Align()
+        {
+            pos = (pos + 15) & ~(size_t)15;
+        }
+    };
+}
+
+bool MeshCache::Open(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, MeshCacheData &out)
+{
+    if (!ReadAsset(cachePath, file))
+        return false;
+
+    Reader r{file.Data(), file.Size()};
+    const unsigned char *magic = r.Take(sizeof(kMagic));
+    if (!magic || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        r.Get<uint32_t>() != kVersion ||
+        r.Get<uint32_t>() != importFlags ||
+        r.Get<uint64_t>() != sourceHash)
+    {
+        file.Close();
+        return false; // stale or foreign file
+    }
+
+    uint32_t meshCount = r.Get<uint32_t>();
+    uint32_t nodeCount = r.Get<uint32_t>();
+    uint32_t nodeMeshCount = r.Get<uint32_t>();
+    uint32_t nameCount = r.Get<uint32_t>();
+    out.bboxInitialized = r.Get<uint32_t>() != 0;
+    out.bboxMin = r.Get<glm::vec3>();
+    out.bboxMax = r.Get<glm::vec3>();
+    out.quant.posMin = r.Get<glm::vec3>();
+    out.quant.posExtent = r.Get<glm::vec3>();
+    out.quant.uvMin = r.Get<glm::vec2>();
+    out.quant.uvExtent = r.Get<glm::vec2>();
+    if (!r.ok || meshCount > file.Size() || nodeCount > file.Size() || nodeMeshCount > file.Size() ||
+        nameCount > file.Size())
+    {
+        file.Close();
+        return false;
+    }
+
+    out.meshes.assign(meshCount, MeshCacheMesh());
+    for (auto &m : out.meshes)
+    {
+        m.vertexCount = r.Get<uint32_t>();
+        m.indexCount = r.Get<uint32_t>();
+        m.hasAlpha = r.Get<uint8_t>() != 0;
+        m.isHair = r.Get<uint8_t>() != 0;
+        r.Get<uint16_t>();
+        m.alphaCutoff = r.Get<float>();
+        m.diffuseColor = r.Get<glm::vec3>();
+        m.diffusePath = r.GetString();
+        m.uvDensity = r.Get<float>();
+        m.lodCount = r.Get<uint32_t>();
+        r.ok = r.ok && m.lodCount <= kMaxMeshLods;
+        for (uint32_t l = 0; l < m.lodCount && r.ok; ++l)
+        {
+            MeshLod &lod = m.lods[l];
+            lod.firstIndex = r.Get<uint32_t>();
+            lod.indexCount = r.Get<uint32_t>();
+            lod.error = r.Get<float>();
+            r.ok = (uint64_t)lod.firstIndex + lod.indexCount <= m.indexCount;
+        }
+        uint64_t vertexBytes = r.Get<uint64_t>();
+        uint64_t indexBytes = r.Get<uint64_t>();
+        r.ok = r.ok && vertexBytes <= file.Size() && indexBytes <= file.Size();
+        if (!r.ok)
+            break;
+        // the streams are validated while decoding, on upload
+        r.Align();
+        m.encodedVertexBytes = (size_t)vertexBytes;
+        m.encodedVertices = r.Take(m.encodedVertexBytes);
+        r.Align();
+        m.encodedIndexBytes = (size_t)indexBytes;
+        m.encodedIndices = r.Take(m.encodedIndexBytes);
+    }
+
+    out.nodes.assign(nodeCount, ModelNode());
+    for (auto &nd : out.nodes)
+    {
+        nd.parent = r.Get<int32_t>();
+        nd.transform = r.Get<glm::mat4>();
+        nd.firstMesh = r.Get<uint32_t>();
+        nd.meshCount = r.Get<uint32_t>();
+        nd.nameId = r.Get<uint32_t>();
+        nd.pivot = r.Get<glm::vec3>();
+        if (!r.ok)
+            break;
+    }
+    out.nodeMeshes.resize(r.ok ? nodeMeshCount : 0);
+    for (auto &mi : out.nodeMeshes)
+        mi = r.Get<uint32_t>();
+    out.nodeNames.resize(r.ok ? nameCount : 0);
+    for (auto &name : out.nodeNames)
+        name = r.GetString();
+
+    // reject references that point outside the tables or break the parent-first order
+    // (truncated / corrupted file)
+    for (uint32_t i = 0; i < nodeCount && r.ok; ++i)
+    {
+        const ModelNode &nd = out.nodes[i];
+        r.ok = (i == 0 ? nd.parent == -1 : (nd.parent >= 0 && (uint32_t)nd.parent < i)) &&
+               (uint64_t)nd.firstMesh + nd.meshCount <= nodeMeshCount && nd.nameId < nameCount;
+    }
+    for (uint32_t mi : out.nodeMeshes)
+        r.ok = r.ok && mi < meshCount;
+    if (!r.ok || nodeCount == 0)
+    {
+        std::cerr << "MeshCache: corrupted cache " << cachePath << ", re-importing\n";
+        out = MeshCacheData();
+        file.Close();
+        return false;
+    }
+    return true;
+}
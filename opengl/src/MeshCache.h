@@ -0,0 +1,67 @@
+// src/MeshCache.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "AssetPack.h"
+#include "MeshCodec.h"
+#include "StaticModel.h"
+
+// One mesh of a baked model. When writing, vertex/index pointers reference caller-owned vectors.
+// When reading they are null and the encoded streams point straight into the mapped cache file;
+// UploadMeshes decodes them into the GL buffers (MeshCodec.h).
+struct MeshCacheMesh
+{
+    const SimpleVertex *vertices = nullptr;
+    uint32_t vertexCount = 0;
+    const unsigned int *indices = nullptr;
+    uint32_t indexCount = 0; // every level of detail
+    const unsigned char *encodedVertices = nullptr;
+    size_t encodedVertexBytes = 0;
+    const unsigned char *encodedIndices = nullptr;
+    size_t encodedIndexBytes = 0;
+    MeshLod lods[kMaxMeshLods];
+    uint32_t lodCount = 0; // 0: the index data is a single level
+    float uvDensity = 0.0f; // texture coordinate units per mesh space unit, for texture streaming
+
+    // material fields copied to MeshRenderData
+    bool hasAlpha = false; // from material opacity; texture alpha is re-checked on upload
+    bool isHair = false;
+    float alphaCutoff = 0.5f;
+    glm::vec3 diffuseColor = glm::vec3(1.0f);
+    std::string diffusePath; // resolved texture path, empty if the material has none
+};
+
+struct MeshCacheData
+{
+    std::vector<MeshCacheMesh> meshes;
+    std::vector<ModelNode> nodes;       // nodes[0] is the root, parents before children
+    std::vector<uint32_t> nodeMeshes;   // sliced by ModelNode::firstMesh/meshCount
+    std::vector<std::string> nodeNames; // interned, indexed by ModelNode::nameId
+    glm::vec3 bboxMin = glm::vec3(0.0f);
+    glm::vec3 bboxMax = glm::vec3(0.0f);
+    bool bboxInitialized = false;
+    MeshQuantization quant; // boxes of the encoded vertices (read side only)
+};
+
+// Baked binary form of an Assimp import, stored next to the source as "<model>.smc".
+// The file is keyed by a hash of the source content (plus its .mtl files) and the import flags;
+// a mismatch on either makes Open() fail so the caller falls back to Assimp and rewrites it.
+class MeshCache
+{
+public:
+    static std::string CachePathFor(const std::string &modelPath);
+    // FNV-1a over the model file and, for .obj, every mtllib it references. 0 if unreadable.
+    static uint64_t HashSource(const std::string &modelPath);
+    // files besides modelPath that HashSource covers (the .obj's material libraries)
+    static std::vector<std::string> Dependencies(const std::string &modelPath);
+    static bool Write(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, const MeshCacheData &data);
+
+    // Maps the cache and fills out. Vertex/index pointers stay valid while this object is open.
+    bool Open(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, MeshCacheData &out);
+    void Close() { file.Close(); }
+
+private:
+    AssetData file;
+};
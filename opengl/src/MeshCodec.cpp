@@ -0,0 +1,530 @@
+// src/MeshCodec.cpp
+#include "MeshCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHCODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Stored vertex record, eight 16-bit lanes: position (unorm16 in the position box), normal
+// components (snorm10 as in PackedVertex, one per lane so the deltas stay small) and uv (unorm16
+// in the UV box)
+struct VertexRecord
+{
+    uint16_t pos[3];
+    int16_t normal[3];
+    uint16_t uv[2];
+};
+static_assert(sizeof(VertexRecord) == 16, "one record fills an SSE2 register");
+
+// ---- quantization ----
+MeshQuantization MeshQuantization::Compute(const std::vector<const SimpleVertex *> &vertices,
+                                           const std::vector<size_t> &counts)
+{
+    glm::vec3 pmin(std::numeric_limits<float>::max()), pmax(-std::numeric_limits<float>::max());
+    glm::vec2 tmin(std::numeric_limits<float>::max()), tmax(-std::numeric_limits<float>::max());
+    for (size_t m = 0; m < vertices.size(); ++m)
+    {
+        for (size_t i = 0; i < counts[m]; ++i)
+        {
+            const SimpleVertex &v = vertices[m][i];
+            pmin = glm::min(pmin, v.pos);
+            pmax = glm::max(pmax, v.pos);
+            tmin = glm::min(tmin, v.uv);
+            tmax = glm::max(tmax, v.uv);
+        }
+    }
+    if (pmin.x > pmax.x)
+    {
+        pmin = pmax = glm::vec3(0.0f);
+        tmin = tmax = glm::vec2(0.0f);
+    }
+    MeshQuantization q;
+    q.posMin = pmin;
+    q.posExtent = glm::max(pmax - pmin, glm::vec3(1e-6f));
+    q.uvMin = tmin;
+    q.uvExtent = glm::max(tmax - tmin, glm::vec2(1e-6f));
+    return q;
+}
+
+glm::mat4 MeshQuantization::DequantMatrix() const
+{
+    return glm::scale(glm::translate(glm::mat4(1.0f), posMin), posExtent);
+}
+
+uint16_t MeshQuantization::QuantizePos(float v, int axis) const
+{
+    return (uint16_t)(glm::clamp((v - posMin[axis]) / posExtent[axis], 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+static void QuantizeRecord(const SimpleVertex &v, const MeshQuantization &q, uint16_t lanes[8])
+{
+    VertexRecord r;
+    uint32_t n = glm::packSnorm3x10_1x2(glm::vec4(v.normal, 0.0f));
+    for (int a = 0; a < 3; ++a)
+    {
+        r.pos[a] = q.QuantizePos(v.pos[a], a);
+        r.normal[a] = (int16_t)((int32_t)((n >> (10 * a)) << 22) >> 22); // sign-extend the 10-bit field
+    }
+    for (int a = 0; a < 2; ++a)
+        r.uv[a] = (uint16_t)(glm::clamp((v.uv[a] - q.uvMin[a]) / q.uvExtent[a], 0.0f, 1.0f) * 65535.0f + 0.5f);
+    memcpy(lanes, &r, sizeof(r));
+}
+
+// float -> half without the generic path's special cases: UVs are finite, values below the half
+// normal range flush to zero
+static uint16_t UvToHalf(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, 4);
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t e = (int32_t)((x >> 23) & 0xFF) - 127 + 15;
+    if (e <= 0)
+        return (uint16_t)sign;
+    if (e >= 31)
+        return (uint16_t)(sign | 0x7C00);
+    return (uint16_t)(sign | (((uint32_t)e << 10) + (((x & 0x7FFFFF) + 0x1000) >> 13)));
+}
+
+// records -> final vertices, one store each (the destination is usually a write-combined mapping)
+static void EmitRecords(const unsigned char (*records)[16], size_t n, VertexFormat format, const MeshQuantization &q,
+                        unsigned char *dst)
+{
+    glm::vec2 uvScale = q.uvExtent / 65535.0f;
+    if (format == VertexFormat::Packed)
+    {
+        for (size_t i = 0; i < n; ++i, dst += sizeof(PackedVertex))
+        {
+            VertexRecord r;
+            memcpy(&r, records[i], sizeof(r));
+            PackedVertex v;
+            v.pos[0] = r.pos[0];
+            v.pos[1] = r.pos[1];
+            v.pos[2] = r.pos[2];
+            v.pos[3] = 0;
+            v.normal = ((uint32_t)r.normal[0] & 1023) | (((uint32_t)r.normal[1] & 1023) << 10) |
+                       (((uint32_t)r.normal[2] & 1023) << 20);
+            v.uv[0] = UvToHalf(q.uvMin.x + r.uv[0] * uvScale.x);
+            v.uv[1] = UvToHalf(q.uvMin.y + r.uv[1] * uvScale.y);
+            memcpy(dst, &v, sizeof(v));
+        }
+        return;
+    }
+    glm::vec3 posScale = q.posExtent / 65535.0f;
+    for (size_t i = 0; i < n; ++i, dst += sizeof(SimpleVertex))
+    {
+        VertexRecord r;
+        memcpy(&r, records[i], sizeof(r));
+        SimpleVertex v;
+        for (int a = 0; a < 3; ++a)
+        {
+            v.pos[a] = q.posMin[a] + r.pos[a] * posScale[a];
+            v.normal[a] = std::max(r.normal[a] / 511.0f, -1.0f);
+        }
+        v.uv = glm::vec2(q.uvMin.x + r.uv[0] * uvScale.x, q.uvMin.y + r.uv[1] * uvScale.y);
+        memcpy(dst, &v, sizeof(v));
+    }
+}
+
+// ---- vertex stream ----
+static const size_t kBlockVertices = 16;
+static const size_t kPlaneBytes[5] = {0, 2, 4, 8, 16}; // per width code: 0, 1, 2, 4, 8 bits
+static const unsigned int kWidthBits[5] = {0, 1, 2, 4, 8};
+
+static int WidthCode(const unsigned char *plane)
+{
+    unsigned char maxv = 0;
+    for (size_t i = 0; i < kBlockVertices; ++i)
+        maxv = std::max(maxv, plane[i]);
+    return maxv == 0 ? 0 : maxv < 2 ? 1 : maxv < 4 ? 2 : maxv < 16 ? 3 : 4;
+}
+
+void EncodeVertexBuffer(const SimpleVertex *vertices, size_t count, const MeshQuantization &q,
+                        std::vector<unsigned char> &out)
+{
+    uint16_t last[8] = {};
+    for (size_t base = 0; base < count; base += kBlockVertices)
+    {
+        // planes[k][i]: byte k of vertex i's zigzagged delta record; the tail of the last block
+        // repeats the last vertex (zero deltas)
+        unsigned char planes[16][kBlockVertices];
+        for (size_t i = 0; i < kBlockVertices; ++i)
+        {
+            uint16_t lanes[8];
+            if (base + i < count)
+                QuantizeRecord(vertices[base + i], q, lanes);
+            else
+                memcpy(lanes, last, sizeof(lanes));
+            for (int l = 0; l < 8; ++l)
+            {
+                uint16_t d = (uint16_t)(lanes[l] - last[l]);
+                uint16_t z = (uint16_t)((d << 1) ^ (uint16_t)((int16_t)d >> 15));
+                planes[2 * l][i] = (unsigned char)(z & 0xFF);
+                planes[2 * l + 1][i] = (unsigned char)(z >> 8);
+                last[l] = lanes[l];
+            }
+        }
+
+        int codes[16];
+        unsigned char header[8] = {};
+        for (int k = 0; k < 16; ++k)
+        {
+            codes[k] = WidthCode(planes[k]);
+            header[k >> 1] |= (unsigned char)(codes[k] << ((k & 1) * 4));
+        }
+        out.insert(out.end(), header, header + 8);
+        for (int k = 0; k < 16; ++k)
+        {
+            unsigned int bits = kWidthBits[codes[k]];
+            size_t at = out.size();
+            out.resize(at + kPlaneBytes[codes[k]], 0);
+            // value j lands in byte j*bits/8 at bit j*bits%8: the layout the SSE2 unpack expects
+            for (size_t j = 0; bits && j < kBlockVertices; ++j)
+                out[at + j * bits / 8] |= (unsigned char)(planes[k][j] << (j * bits % 8));
+        }
+    }
+}
+
+#ifdef MESHCODEC_SSE2
+static __m128i UnpackPlane(const unsigned char *p, int code)
+{
+    switch (code)
+    {
+    case 0:
+        return _mm_setzero_si128();
+    case 1:
+    {
+        uint16_t x;
+        memcpy(&x, p, 2);
+        // each byte broadcast to 8 lanes, then one bit tested per lane
+        __m128i t = _mm_cvtsi32_si128(x);
+        t = _mm_unpacklo_epi8(t, t);
+        t = _mm_unpacklo_epi16(t, t);
+        t = _mm_unpacklo_epi32(t, t);
+        const __m128i bit = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        return _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(t, bit), bit), _mm_set1_epi8(1));
+    }
+    case 2:
+    {
+        uint32_t x;
+        memcpy(&x, p, 4);
+        __m128i t = _mm_cvtsi32_si128((int)x);
+        const __m128i mask = _mm_set1_epi8(3);
+        __m128i a0 = _mm_and_si128(t, mask);
+        __m128i a1 = _mm_and_si128(_mm_srli_epi16(t, 2), mask);
+        __m128i a2 = _mm_and_si128(_mm_srli_epi16(t, 4), mask);
+        __m128i a3 = _mm_and_si128(_mm_srli_epi16(t, 6), mask);
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(a0, a1), _mm_unpacklo_epi8(a2, a3));
+    }
+    case 3:
+    {
+        __m128i t = _mm_loadl_epi64((const __m128i *)p);
+        const __m128i mask = _mm_set1_epi8(15);
+        return _mm_unpacklo_epi8(_mm_and_si128(t, mask), _mm_and_si128(_mm_srli_epi16(t, 4), mask));
+    }
+    default:
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+}
+
+// 16x16 byte transpose: four rounds of the same perfect shuffle
+static void Transpose16(__m128i r[16])
+{
+    for (int round = 0; round < 4; ++round)
+    {
+        __m128i t[16];
+        for (int i = 0; i < 8; ++i)
+        {
+            t[2 * i] = _mm_unpacklo_epi8(r[i], r[i + 8]);
+            t[2 * i + 1] = _mm_unpackhi_epi8(r[i], r[i + 8]);
+        }
+        for (int i = 0; i < 16; ++i)
+            r[i] = t[i];
+    }
+}
+#endif
+
+bool DecodeVertexBuffer(void *out, VertexFormat format, size_t count, const MeshQuantization &q,
+                        const unsigned char *data, size_t size)
+{
+    const unsigned char *p = data, *end = data + size;
+    unsigned char *dst = static_cast<unsigned char *>(out);
+    size_t stride = format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(SimpleVertex);
+    alignas(16) unsigned char records[kBlockVertices][16];
+#ifdef MESHCODEC_SSE2
+    __m128i last = _mm_setzero_si128();
+#else
+    uint16_t last[8] = {};
+#endif
+    for (size_t base = 0; base < count; base += kBlockVertices)
+    {
+        if (end - p < 8)
+            return false;
+        const unsigned char *header = p;
+        p += 8;
+#ifdef MESHCODEC_SSE2
+        __m128i r[16];
+        for (int k = 0; k < 16; ++k)
+        {
+            int code = (header[k >> 1] >> ((k & 1) * 4)) & 15;
+            if (code > 4 || (size_t)(end - p) < kPlaneBytes[code])
+                return false;
+            r[k] = UnpackPlane(p, code);
+            p += kPlaneBytes[code];
+        }
+        Transpose16(r);
+        const __m128i one = _mm_set1_epi16(1);
+        for (size_t i = 0; i < kBlockVertices; ++i)
+        {
+            // zigzag back to a signed delta, then running sum per 16-bit lane
+            __m128i z = r[i];
+            __m128i d = _mm_xor_si128(_mm_srli_epi16(z, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(z, one)));
+            last = _mm_add_epi16(last, d);
+            _mm_store_si128((__m128i *)records[i], last);
+        }
+#else
+        unsigned char planes[16][kBlockVertices];
+        for (int k = 0; k < 16; ++k)
+        {
+            int code = (header[k >> 1] >> ((k & 1) * 4)) & 15;
+            if (code > 4 || (size_t)(end - p) < kPlaneBytes[code])
+                return false;
+            unsigned int bits = kWidthBits[code];
+            for (size_t j = 0; j < kBlockVertices; ++j)
+                planes[k][j] = bits ? (unsigned char)((p[j * bits / 8] >> (j * bits % 8)) & ((1u << bits) - 1)) : 0;
+            p += kPlaneBytes[code];
+        }
+        for (size_t i = 0; i < kBlockVertices; ++i)
+        {
+            for (int l = 0; l < 8; ++l)
+            {
+                uint16_t z = (uint16_t)(planes[2 * l][i] | (planes[2 * l + 1][i] << 8));
+                last[l] = (uint16_t)(last[l] + ((z >> 1) ^ (uint16_t)-(int)(z & 1)));
+            }
+            memcpy(records[i], last, 16);
+        }
+#endif
+        EmitRecords(records, std::min(kBlockVertices, count - base), format, q, dst + base * stride);
+    }
+    return true;
+}
+
+// ---- index stream ----
+static const unsigned int kInvalid = ~0u;
+static const int kExplicit = 15; // vertex code: varint delta follows
+static const int kFullTriangle = 15; // edge code: no edge hit, three vertex codes follow
+static const int kEdgeSearch = 15;   // edge FIFO entries that fit a nibble next to kFullTriangle
+static const int kVertexSearch = 14; // vertex codes 1..14
+
+namespace
+{
+    // identical on both sides: every decoded vertex and triangle updates it the same way
+    struct IndexCoderState
+    {
+        unsigned int edges[16][2];
+        unsigned int edgeHead = 0;
+        unsigned int verts[16];
+        unsigned int vertHead = 0;
+        unsigned int next = 0; // lowest vertex index not seen yet, if vertices come in first-use order
+        unsigned int last = 0; // previous vertex, base of the explicit deltas
+
+        IndexCoderState()
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                edges[i][0] = edges[i][1] = kInvalid;
+                verts[i] = kInvalid;
+            }
+        }
+        // i = 0 is the most recent entry
+        const unsigned int *Edge(int i) const { return edges[(edgeHead - 1 - i) & 15]; }
+        unsigned int Vertex(int i) const { return verts[(vertHead - 1 - i) & 15]; }
+        void PushEdge(unsigned int a, unsigned int b)
+        {
+            edges[edgeHead & 15][0] = a;
+            edges[edgeHead & 15][1] = b;
+            edgeHead++;
+        }
+        int Code(unsigned int v) const
+        {
+            if (v == next)
+                return 0;
+            for (int i = 0; i < kVertexSearch; ++i)
+            {
+                if (Vertex(i) == v)
+                    return i + 1;
+            }
+            return kExplicit;
+        }
+        // after vertex v was coded with code
+        void Use(unsigned int v, int code)
+        {
+            if (code == 0 || code == kExplicit)
+            {
+                verts[vertHead & 15] = v;
+                vertHead++;
+            }
+            if (v >= next)
+                next = v + 1;
+            last = v;
+        }
+    };
+}
+
+static void PutVarint(std::vector<unsigned char> &out, unsigned int v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((unsigned char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((unsigned char)v);
+}
+
+static bool GetVarint(const unsigned char *&p, const unsigned char *end, unsigned int &v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (p == end)
+            return false;
+        unsigned char b = *p++;
+        v |= (unsigned int)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static unsigned int Zigzag(unsigned int v, unsigned int base)
+{
+    int d = (int)(v - base);
+    return ((unsigned int)d << 1) ^ (unsigned int)(d >> 31);
+}
+
+void EncodeIndexBuffer(const unsigned int *indices, size_t count, std::vector<unsigned char> &out)
+{
+    IndexCoderState s;
+    std::vector<unsigned int> explicitDeltas;
+    for (size_t t = 0; t + 2 < count; t += 3)
+    {
+        unsigned int tri[3] = {indices[t], indices[t + 1], indices[t + 2]};
+        int edge = -1, rot = 0;
+        for (int i = 0; i < kEdgeSearch && edge < 0; ++i)
+        {
+            const unsigned int *e = s.Edge(i);
+            for (int r = 0; r < 3; ++r)
+            {
+                if (e[0] == tri[r] && e[1] == tri[(r + 1) % 3])
+                {
+                    edge = i;
+                    rot = r;
+                    break;
+                }
+            }
+        }
+
+        if (edge >= 0)
+        {
+            unsigned int x = tri[rot], y = tri[(rot + 1) % 3], z = tri[(rot + 2) % 3];
+            int code = s.Code(z);
+            out.push_back((unsigned char)((edge << 4) | code));
+            if (code == kExplicit)
+                PutVarint(out, Zigzag(z, s.last));
+            s.Use(z, code);
+            s.PushEdge(z, y);
+            s.PushEdge(x, z);
+            continue;
+        }
+
+        int codes[3];
+        explicitDeltas.clear();
+        for (int c = 0; c < 3; ++c)
+        {
+            codes[c] = s.Code(tri[c]);
+            if (codes[c] == kExplicit)
+                explicitDeltas.push_back(Zigzag(tri[c], s.last));
+            s.Use(tri[c], codes[c]);
+        }
+        out.push_back((unsigned char)((kFullTriangle << 4) | codes[0]));
+        out.push_back((unsigned char)(codes[1] | (codes[2] << 4)));
+        for (unsigned int d : explicitDeltas)
+            PutVarint(out, d);
+        s.PushEdge(tri[1], tri[0]);
+        s.PushEdge(tri[2], tri[1]);
+        s.PushEdge(tri[0], tri[2]);
+    }
+}
+
+bool DecodeIndexBuffer(void *out, size_t indexSize, size_t count, size_t vertexCount, const unsigned char *data,
+                       size_t size)
+{
+    if (count % 3 != 0 || (indexSize != 2 && indexSize != 4))
+        return false;
+    const unsigned char *p = data, *end = data + size;
+    unsigned char *dst = static_cast<unsigned char *>(out);
+    IndexCoderState s;
+
+    auto vertex = [&](int code, unsigned int &v)
+    {
+        if (code == 0)
+            v = s.next;
+        else if (code == kExplicit)
+        {
+            unsigned int z;
+            if (!GetVarint(p, end, z))
+                return false;
+            v = s.last + (unsigned int)((int)(z >> 1) ^ -(int)(z & 1));
+        }
+        else
+            v = s.Vertex(code - 1);
+        if (v >= vertexCount)
+            return false; // also catches never-filled FIFO slots
+        s.Use(v, code);
+        return true;
+    };
+
+    for (size_t t = 0; t < count; t += 3)
+    {
+        if (p == end)
+            return false;
+        unsigned char b = *p++;
+        int high = b >> 4, low = b & 15;
+        unsigned int tri[3];
+        if (high != kFullTriangle)
+        {
+            const unsigned int *e = s.Edge(high);
+            tri[0] = e[0];
+            tri[1] = e[1];
+            if (tri[0] >= vertexCount || tri[1] >= vertexCount || !vertex(low, tri[2]))
+                return false;
+            s.PushEdge(tri[2], tri[1]);
+            s.PushEdge(tri[0], tri[2]);
+        }
+        else
+        {
+            if (p == end)
+                return false;
+            unsigned char b2 = *p++;
+            if (!vertex(low, tri[0]) || !vertex(b2 & 15, tri[1]) || !vertex(b2 >> 4, tri[2]))
+                return false;
+            s.PushEdge(tri[1], tri[0]);
+            s.PushEdge(tri[2], tri[1]);
+            s.PushEdge(tri[0], tri[2]);
+        }
+
+        if (indexSize == 2)
+        {
+            uint16_t v[3] = {(uint16_t)tri[0], (uint16_t)tri[1], (uint16_t)tri[2]};
+            memcpy(dst + t * 2, v, sizeof(v));
+        }
+        else
+            memcpy(dst + t * 4, tri, sizeof(tri));
+    }
+    return true;
+}
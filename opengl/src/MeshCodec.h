@@ -0,0 +1,47 @@
+// src/MeshCodec.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "StaticModel.h"
+
+// Quantization boxes shared by every mesh of a model: positions as in PackedVertex, plus a UV box
+// so texture coordinates can be stored as 16-bit unorm (half floats lose too much on tiled UVs).
+struct MeshQuantization
+{
+    glm::vec3 posMin = glm::vec3(0.0f);
+    glm::vec3 posExtent = glm::vec3(1.0f);
+    glm::vec2 uvMin = glm::vec2(0.0f);
+    glm::vec2 uvExtent = glm::vec2(1.0f);
+
+    // boxes over every vertex of every mesh (count pairs with vertices)
+    static MeshQuantization Compute(const std::vector<const SimpleVertex *> &vertices,
+                                    const std::vector<size_t> &counts);
+    // quantized model space -> model space, what StaticModel::DequantMatrix() returns for packed vertices
+    glm::mat4 DequantMatrix() const;
+    uint16_t QuantizePos(float v, int axis) const;
+};
+
+// Compressed vertex/index streams for the mesh cache.
+//
+// Vertices: one 16 byte record per vertex, quantized like PackedVertex except that uv holds
+// unorm16 inside the UV box. Records are delta coded against the previous vertex per 16-bit lane and
+// zigzagged; every block of 16 vertices is split into 16 byte planes, each bit packed at 0, 1, 2,
+// 4 or 8 bits. Decoding unpacks, transposes and prefix-sums a block in SSE2 registers and writes
+// PackedVertex or SimpleVertex records straight to the destination (a mapped GL buffer).
+//
+// Indices: triangles are coded against a FIFO of recent edges and one of recent vertices. A
+// triangle that shares an edge with a recent one costs a single byte when its third vertex is the
+// next unused index (the common case after MeshOptimizer's fetch reorder) or a recent one.
+// Decoded triangles may be rotated; winding and triangle order are kept.
+void EncodeVertexBuffer(const SimpleVertex *vertices, size_t count, const MeshQuantization &q,
+                        std::vector<unsigned char> &out);
+// false if data is truncated or corrupt; out receives count vertices of format
+bool DecodeVertexBuffer(void *out, VertexFormat format, size_t count, const MeshQuantization &q,
+                        const unsigned char *data, size_t size);
+
+void EncodeIndexBuffer(const unsigned int *indices, size_t count, std::vector<unsigned char> &out);
+// indexSize is 2 or 4. false if data is truncated, corrupt or references a vertex >= vertexCount
+bool DecodeIndexBuffer(void *out, size_t indexSize, size_t count, size_t vertexCount, const unsigned char *data,
+                       size_t size);
@@ -0,0 +1,268 @@
+// src/MeshOptimizer.cpp
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <numeric>
+
+// post-transform cache size assumed for ordering and for the reported ACMR
+static const unsigned int kCacheSize = 16;
+// dead ends can be close together; tiny clusters only cost cache misses without hiding anything
+static const size_t kMinClusterTriangles = 16;
+// how much worse than the pure cache order the overdraw order may be
+static const float kOverdrawAcmrThreshold = 1.05f;
+
+float ComputeACMR(const unsigned int *indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+    if (indexCount < 3)
+        return 0.0f;
+    // FIFO: every miss pushes one entry, a vertex is evicted cacheSize misses after it was inserted
+    std::vector<long long> insertedAt(vertexCount, -1);
+    long long misses = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        unsigned int v = indices[i];
+        if (insertedAt[v] >= 0 && misses - insertedAt[v] < (long long)cacheSize)
+            continue;
+        insertedAt[v] = misses++;
+    }
+    return (float)misses / (float)(indexCount / 3);
+}
+
+// Tipsify: fan around the most recently used vertex that still has triangles left. clusterStarts
+// receives the first triangle of every run that began from a dead end.
+static void Tipsify(const std::vector<unsigned int> &in, size_t vertexCount, unsigned int k,
+                    std::vector<unsigned int> &out, std::vector<size_t> &clusterStarts)
+{
+    size_t triCount = in.size() / 3;
+
+    // vertex -> triangle adjacency
+    std::vector<unsigned int> live(vertexCount, 0);
+    for (unsigned int v : in)
+        live[v]++;
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + live[v];
+    std::vector<unsigned int> adjacency(in.size());
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triCount; ++t)
+        for (int c = 0; c < 3; ++c)
+            adjacency[fill[in[t * 3 + c]]++] = (unsigned int)t;
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triCount, 0);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    unsigned int timestamp = k + 1;
+    size_t cursor = 0;
+
+    out.clear();
+    out.reserve(in.size());
+    clusterStarts.clear();
+
+    auto skipDeadEnd = [&]() -> long long
+    {
+        while (!deadEnd.empty())
+        {
+            unsigned int d = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[d] > 0)
+                return d;
+        }
+        while (cursor < vertexCount)
+        {
+            if (live[cursor] > 0)
+                return (long long)cursor;
+            ++cursor;
+        }
+        return -1;
+    };
+
+    long long fan = skipDeadEnd();
+    if (fan >= 0)
+        clusterStarts.push_back(0);
+    while (fan >= 0)
+    {
+        candidates.clear();
+        for (size_t a = offsets[fan]; a < offsets[fan + 1]; ++a)
+        {
+            unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            for (int c = 0; c < 3; ++c)
+            {
+                unsigned int v = in[t * 3 + c];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (timestamp - cacheTime[v] > k)
+                    cacheTime[v] = timestamp++;
+            }
+            emitted[t] = 1;
+        }
+
+        // prefer the oldest candidate that will still be cached after its own fan is emitted
+        long long next = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= k)
+                priority = (int)(timestamp - cacheTime[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if (next < 0)
+        {
+            next = skipDeadEnd();
+            if (next >= 0)
+                clusterStarts.push_back(out.size() / 3);
+        }
+        fan = next;
+    }
+}
+
+// Draw clusters that face away from the mesh centre first: they tend to occlude the rest.
+static void SortClusters(std::vector<unsigned int> &indices, const std::vector<SimpleVertex> &vertices,
+                         const std::vector<size_t> &hardStarts, size_t &outClusters)
+{
+    size_t triCount = indices.size() / 3;
+
+    std::vector<size_t> starts;
+    for (size_t s : hardStarts)
+    {
+        if (starts.empty() || s - starts.back() >= kMinClusterTriangles)
+            starts.push_back(s);
+    }
+    outClusters = starts.size();
+    if (starts.size() < 2)
+        return;
+    starts.push_back(triCount);
+
+    auto triangle = [&](size_t t, glm::vec3 &centroid, glm::vec3 &areaNormal)
+    {
+        const glm::vec3 &a = vertices[indices[t * 3 + 0]].pos;
+        const glm::vec3 &b = vertices[indices[t * 3 + 1]].pos;
+        const glm::vec3 &c = vertices[indices[t * 3 + 2]].pos;
+        centroid = (a + b + c) / 3.0f;
+        areaNormal = glm::cross(b - a, c - a);
+    };
+
+    // area weighted mesh centroid
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        glm::vec3 c, n;
+        triangle(t, c, n);
+        float area = glm::length(n);
+        meshCentroid += c * area;
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    size_t clusterCount = starts.size() - 1;
+    std::vector<float> sortKey(clusterCount, 0.0f);
+    for (size_t ci = 0; ci < clusterCount; ++ci)
+    {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = starts[ci]; t < starts[ci + 1]; ++t)
+        {
+            glm::vec3 c, n;
+            triangle(t, c, n);
+            float a = glm::length(n);
+            centroid += c * a;
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f)
+            centroid /= area;
+        float len = glm::length(normal);
+        if (len > 0.0f)
+            normal /= len;
+        sortKey[ci] = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                     { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(indices.size());
+    for (size_t ci : order)
+        sorted.insert(sorted.end(), indices.begin() + starts[ci] * 3, indices.begin() + starts[ci + 1] * 3);
+    indices.swap(sorted);
+}
+
+// renumber vertices in the order the index buffer first touches them, dropping unused ones
+static size_t OptimizeVertexFetch(std::vector<SimpleVertex> &vertices, std::vector<unsigned int> &indices)
+{
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<SimpleVertex> reordered;
+    reordered.reserve(vertices.size());
+    for (auto &idx : indices)
+    {
+        if (remap[idx] == unused)
+        {
+            remap[idx] = (unsigned int)reordered.size();
+            reordered.push_back(vertices[idx]);
+        }
+        idx = remap[idx];
+    }
+    size_t removed = vertices.size() - reordered.size();
+    vertices.swap(reordered);
+    return removed;
+}
+
+MeshOptimizeStats OptimizeMesh(std::vector<SimpleVertex> &vertices, std::vector<unsigned int> &indices)
+{
+    MeshOptimizeStats stats;
+    if (indices.size() < 3 || vertices.empty())
+        return stats;
+    stats.acmrBefore = ComputeACMR(indices.data(), indices.size(), vertices.size(), kCacheSize);
+
+    std::vector<unsigned int> cacheOrder;
+    std::vector<size_t> clusterStarts;
+    Tipsify(indices, vertices.size(), kCacheSize, cacheOrder, clusterStarts);
+    float acmrCache = ComputeACMR(cacheOrder.data(), cacheOrder.size(), vertices.size(), kCacheSize);
+
+    std::vector<unsigned int> overdrawOrder = cacheOrder;
+    SortClusters(overdrawOrder, vertices, clusterStarts, stats.clusters);
+    float acmrOverdraw = ComputeACMR(overdrawOrder.data(), overdrawOrder.size(), vertices.size(), kCacheSize);
+
+    if (acmrOverdraw <= acmrCache * kOverdrawAcmrThreshold)
+    {
+        stats.overdrawOrder = true;
+        cacheOrder.swap(overdrawOrder);
+        acmrCache = acmrOverdraw;
+    }
+    // never make an already well ordered mesh worse
+    if (acmrCache < stats.acmrBefore)
+        indices.swap(cacheOrder);
+    else
+        stats.overdrawOrder = false;
+
+    stats.verticesRemoved = OptimizeVertexFetch(vertices, indices);
+    stats.acmrAfter = ComputeACMR(indices.data(), indices.size(), vertices.size(), kCacheSize);
+    return stats;
+}
+
+void OptimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount)
+{
+    if (indices.size() < 3)
+        return;
+    std::vector<unsigned int> cacheOrder;
+    std::vector<size_t> clusterStarts;
+    Tipsify(indices, vertexCount, kCacheSize, cacheOrder, clusterStarts);
+    if (ComputeACMR(cacheOrder.data(), cacheOrder.size(), vertexCount, kCacheSize) <
+        ComputeACMR(indices.data(), indices.size(), vertexCount, kCacheSize))
+        indices.swap(cacheOrder);
+}
@@ -0,0 +1,28 @@
+// src/MeshOptimizer.h
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "StaticModel.h"
+
+struct MeshOptimizeStats
+{
+    float acmrBefore = 0.0f; // average cache miss ratio: transformed vertices per triangle
+    float acmrAfter = 0.0f;
+    size_t clusters = 0;        // triangle clusters considered for overdraw ordering
+    bool overdrawOrder = false; // false if the cluster order was rejected for costing too many cache misses
+    size_t verticesRemoved = 0; // unreferenced vertices dropped by the fetch reorder
+};
+
+// Load-time triangle/vertex reordering, run once per mesh before it is baked into the mesh cache:
+//   1. Tipsify post-transform vertex cache ordering (Sander et al. 2007), which also yields
+//      cluster boundaries wherever it has to restart from a dead end
+//   2. those clusters sorted front-facing-outward first to cut overdraw, kept only while the
+//      ACMR stays within a few percent of step 1
+//   3. vertices renumbered in first-use order so vertex fetch walks the buffer linearly
+MeshOptimizeStats OptimizeMesh(std::vector<SimpleVertex> &vertices, std::vector<unsigned int> &indices);
+
+// step 1 alone, for index lists that share an already ordered vertex buffer (simplified LODs)
+void OptimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount);
+
+// ACMR of indices under a FIFO cache of cacheSize entries
+float ComputeACMR(const unsigned int *indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize);
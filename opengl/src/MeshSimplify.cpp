@@ -0,0 +1,337 @@
+// src/MeshSimplify.cpp
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_set>
+
+static const unsigned int kNone = ~0u;
+static const unsigned int kMany = ~0u - 1; // more than one seam edge in that direction
+
+enum class VertexKind : unsigned char
+{
+    Manifold, // collapses onto any neighbour
+    Seam,     // collapses along the seam, together with its twin on the other side
+    Locked
+};
+
+// sum of the squared distances to the planes of the surrounding triangles, area weighted
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0;
+    double w = 0;
+};
+
+static void AddPlane(Quadric &q, const glm::dvec3 &n, double d, double weight)
+{
+    q.a00 += weight * n.x * n.x;
+    q.a01 += weight * n.x * n.y;
+    q.a02 += weight * n.x * n.z;
+    q.a11 += weight * n.y * n.y;
+    q.a12 += weight * n.y * n.z;
+    q.a22 += weight * n.z * n.z;
+    q.b0 += weight * n.x * d;
+    q.b1 += weight * n.y * d;
+    q.b2 += weight * n.z * d;
+    q.c += weight * d * d;
+    q.w += weight;
+}
+
+static void Accumulate(Quadric &q, const Quadric &r)
+{
+    q.a00 += r.a00;
+    q.a01 += r.a01;
+    q.a02 += r.a02;
+    q.a11 += r.a11;
+    q.a12 += r.a12;
+    q.a22 += r.a22;
+    q.b0 += r.b0;
+    q.b1 += r.b1;
+    q.b2 += r.b2;
+    q.c += r.c;
+    q.w += r.w;
+}
+
+// mean squared distance of p to the planes of q
+static double Evaluate(const Quadric &q, const glm::vec3 &p)
+{
+    double x = p.x, y = p.y, z = p.z;
+    double e = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+               2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+               2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return q.w > 0.0 ? std::fabs(e) / q.w : 0.0;
+}
+
+static uint64_t EdgeKey(unsigned int a, unsigned int b)
+{
+    return ((uint64_t)a << 32) | b;
+}
+
+// vertex -> triangle lists of the current index buffer
+static void BuildAdjacency(const std::vector<unsigned int> &indices, size_t vertexCount,
+                           std::vector<unsigned int> &offsets, std::vector<unsigned int> &adjacency)
+{
+    offsets.assign(vertexCount + 1, 0);
+    for (unsigned int v : indices)
+        offsets[v + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+    adjacency.resize(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+        adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+}
+
+float SimplifyMesh(const std::vector<SimpleVertex> &vertices, const std::vector<unsigned int> &indices,
+                   size_t targetIndexCount, float targetError, std::vector<unsigned int> &out)
+{
+    out = indices;
+    size_t vertexCount = vertices.size();
+    if (out.size() <= targetIndexCount || vertexCount == 0)
+        return 0.0f;
+
+    // weld by position: vertices split only by UV/normal share a position id and form a ring
+    // (unreferenced vertices stay out, they would look like extra wedges)
+    std::vector<unsigned char> referenced(vertexCount, 0);
+    for (unsigned int v : out)
+        referenced[v] = 1;
+    std::vector<unsigned int> order;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        if (referenced[v])
+            order.push_back(v);
+    }
+    auto less = [&](unsigned int a, unsigned int b)
+    {
+        const glm::vec3 &pa = vertices[a].pos, &pb = vertices[b].pos;
+        if (pa.x != pb.x)
+            return pa.x < pb.x;
+        if (pa.y != pb.y)
+            return pa.y < pb.y;
+        return pa.z < pb.z;
+    };
+    std::sort(order.begin(), order.end(), less);
+    std::vector<unsigned int> posOf(vertexCount, 0), wedgeNext(vertexCount, 0);
+    std::vector<unsigned int> wedgeCount;
+    for (size_t i = 0; i < order.size();)
+    {
+        size_t j = i + 1;
+        while (j < order.size() && vertices[order[j]].pos == vertices[order[i]].pos)
+            ++j;
+        for (size_t k = i; k < j; ++k)
+        {
+            posOf[order[k]] = (unsigned int)wedgeCount.size();
+            wedgeNext[order[k]] = order[k + 1 < j ? k + 1 : i];
+        }
+        wedgeCount.push_back((unsigned int)(j - i));
+        i = j;
+    }
+    size_t posCount = wedgeCount.size();
+
+    // classify: an edge without a reverse edge between the same positions is an open border, one
+    // whose reverse only exists between other vertices of those positions is a seam
+    std::unordered_set<uint64_t> vertexEdges, positionEdges;
+    vertexEdges.reserve(out.size());
+    positionEdges.reserve(out.size());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        unsigned int a = out[i], b = out[i % 3 == 2 ? i - 2 : i + 1];
+        vertexEdges.insert(EdgeKey(a, b));
+        positionEdges.insert(EdgeKey(posOf[a], posOf[b]));
+    }
+    std::vector<unsigned char> border(posCount, 0);
+    std::vector<unsigned int> seamNext(vertexCount, kNone), seamPrev(vertexCount, kNone);
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        unsigned int a = out[i], b = out[i % 3 == 2 ? i - 2 : i + 1];
+        if (!positionEdges.count(EdgeKey(posOf[b], posOf[a])))
+            border[posOf[a]] = border[posOf[b]] = 1;
+        else if (!vertexEdges.count(EdgeKey(b, a)))
+        {
+            seamNext[a] = (seamNext[a] == kNone || seamNext[a] == b) ? b : kMany;
+            seamPrev[b] = (seamPrev[b] == kNone || seamPrev[b] == a) ? a : kMany;
+        }
+    }
+    auto onSeam = [&](unsigned int v)
+    {
+        return v < kMany;
+    };
+    std::vector<VertexKind> kind(vertexCount, VertexKind::Locked);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        unsigned int p = posOf[v];
+        if (border[p] || wedgeCount[p] > 2)
+            continue;
+        if (wedgeCount[p] == 1)
+        {
+            if (seamNext[v] == kNone && seamPrev[v] == kNone)
+                kind[v] = VertexKind::Manifold;
+            continue;
+        }
+        // two wedges: a seam passing through, the twin runs the same seam in the other direction
+        unsigned int twin = wedgeNext[v];
+        if (onSeam(seamNext[v]) && onSeam(seamPrev[v]) && onSeam(seamNext[twin]) && onSeam(seamPrev[twin]) &&
+            posOf[seamNext[v]] == posOf[seamPrev[twin]] && posOf[seamPrev[v]] == posOf[seamNext[twin]])
+            kind[v] = VertexKind::Seam;
+    }
+
+    std::vector<Quadric> quadrics(posCount);
+    for (size_t t = 0; t + 2 < out.size(); t += 3)
+    {
+        glm::dvec3 p0 = vertices[out[t]].pos, p1 = vertices[out[t + 1]].pos, p2 = vertices[out[t + 2]].pos;
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double len = glm::length(n);
+        if (len <= 0.0)
+            continue;
+        n /= len;
+        double d = -glm::dot(n, p0);
+        for (int c = 0; c < 3; ++c)
+            AddPlane(quadrics[posOf[out[t + c]]], n, d, len * 0.5);
+    }
+
+    struct Collapse
+    {
+        unsigned int v, t;
+        double cost;
+    };
+    std::vector<Collapse> candidates;
+    std::vector<unsigned int> offsets, adjacency, remap(vertexCount);
+    std::vector<unsigned char> touched(posCount);
+    double limit = (double)targetError * targetError;
+    double worst = 0.0;
+
+    // would moving v onto t turn one of v's remaining triangles over (or make it degenerate)?
+    auto flips = [&](unsigned int v, unsigned int t)
+    {
+        const glm::vec3 &target = vertices[t].pos;
+        for (unsigned int k = offsets[v]; k < offsets[v + 1]; ++k)
+        {
+            const unsigned int *tri = &out[adjacency[k] * 3];
+            if (tri[0] == t || tri[1] == t || tri[2] == t)
+                continue; // collapses away
+            glm::vec3 p[3], q[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                p[c] = vertices[tri[c]].pos;
+                q[c] = tri[c] == v ? target : p[c];
+            }
+            glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 n1 = glm::cross(q[1] - q[0], q[2] - q[0]);
+            if (glm::dot(n0, n1) <= 0.0f)
+                return true;
+        }
+        return false;
+    };
+    auto trianglesRemoved = [&](unsigned int v, unsigned int t)
+    {
+        size_t n = 0;
+        for (unsigned int k = offsets[v]; k < offsets[v + 1]; ++k)
+        {
+            const unsigned int *tri = &out[adjacency[k] * 3];
+            n += (tri[0] == t || tri[1] == t || tri[2] == t) ? 1 : 0;
+        }
+        return n;
+    };
+    // t takes v's place in the seam chain
+    auto unlinkSeam = [&](unsigned int v, unsigned int t)
+    {
+        if (t == seamNext[v])
+        {
+            seamPrev[t] = seamPrev[v];
+            if (onSeam(seamPrev[v]))
+                seamNext[seamPrev[v]] = t;
+        }
+        else
+        {
+            seamNext[t] = seamNext[v];
+            if (onSeam(seamNext[v]))
+                seamPrev[seamNext[v]] = t;
+        }
+    };
+
+    // batched passes: cheapest collapses first, each touching a disjoint neighbourhood
+    while (out.size() > targetIndexCount)
+    {
+        BuildAdjacency(out, vertexCount, offsets, adjacency);
+        candidates.clear();
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            unsigned int a = out[i], b = out[i % 3 == 2 ? i - 2 : i + 1];
+            for (int dir = 0; dir < 2; ++dir, std::swap(a, b))
+            {
+                if (kind[a] == VertexKind::Locked ||
+                    (kind[a] == VertexKind::Seam && b != seamNext[a] && b != seamPrev[a]))
+                    continue;
+                double cost = Evaluate(quadrics[posOf[a]], vertices[b].pos);
+                if (cost <= limit)
+                    candidates.push_back({a, b, cost});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse &x, const Collapse &y)
+                  { return x.cost < y.cost; });
+
+        size_t budget = (out.size() - targetIndexCount + 2) / 3; // triangles still to remove
+        size_t removed = 0, applied = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        std::iota(remap.begin(), remap.end(), 0u);
+        for (const Collapse &c : candidates)
+        {
+            if (removed >= budget)
+                break;
+            unsigned int pv = posOf[c.v], pt = posOf[c.t];
+            if (touched[pv] || touched[pt])
+                continue;
+            unsigned int twin = kNone, twinTarget = kNone;
+            if (kind[c.v] == VertexKind::Seam)
+            {
+                twin = wedgeNext[c.v];
+                twinTarget = c.t == seamNext[c.v] ? seamPrev[twin] : seamNext[twin];
+                if (!onSeam(twinTarget) || posOf[twinTarget] != pt)
+                    continue;
+            }
+            if (flips(c.v, c.t) || (twin != kNone && flips(twin, twinTarget)))
+                continue;
+
+            remap[c.v] = c.t;
+            removed += trianglesRemoved(c.v, c.t);
+            if (twin != kNone)
+            {
+                remap[twin] = twinTarget;
+                removed += trianglesRemoved(twin, twinTarget);
+                unlinkSeam(c.v, c.t);
+                unlinkSeam(twin, twinTarget);
+            }
+            Accumulate(quadrics[pt], quadrics[pv]);
+            worst = std::max(worst, c.cost);
+            applied++;
+
+            // the flip tests above assumed v's neighbourhood fixed: freeze it for this pass
+            for (unsigned int w : {c.v, twin})
+            {
+                if (w == kNone)
+                    continue;
+                for (unsigned int k = offsets[w]; k < offsets[w + 1]; ++k)
+                {
+                    const unsigned int *tri = &out[adjacency[k] * 3];
+                    touched[posOf[tri[0]]] = touched[posOf[tri[1]]] = touched[posOf[tri[2]]] = 1;
+                }
+            }
+        }
+        if (applied == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t t = 0; t + 2 < out.size(); t += 3)
+        {
+            unsigned int a = remap[out[t]], b = remap[out[t + 1]], c = remap[out[t + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            out[write++] = a;
+            out[write++] = b;
+            out[write++] = c;
+        }
+        out.resize(write);
+    }
+    return (float)std::sqrt(worst);
+}
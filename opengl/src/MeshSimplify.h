@@ -0,0 +1,19 @@
+// src/MeshSimplify.h
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "StaticModel.h"
+
+// Quadric error metric edge collapse (Garland & Heckbert 1997) for the import-time LOD chain.
+// Every collapse moves a vertex onto one of its neighbours, so a simplified level references the
+// vertices of the full mesh and only needs an index list of its own. Restrictions that keep the
+// levels crack-free and the texturing intact:
+//   - open borders are locked. Models are split into one mesh per material, so every material
+//     border is an open border of both meshes and stays where it is.
+//   - a UV/normal seam (one position, two vertices) only collapses along the seam, both sides at once
+//   - positions with more than two vertices and seam endpoints are locked
+//   - collapses that would flip a triangle are rejected
+// Stops at targetIndexCount or once the next collapse would cost more than targetError (object
+// space distance). Returns the error actually reached.
+float SimplifyMesh(const std::vector<SimpleVertex> &vertices, const std::vector<unsigned int> &indices,
+                   size_t targetIndexCount, float targetError, std::vector<unsigned int> &out);
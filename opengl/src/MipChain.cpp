@@ -0,0 +1,251 @@
+// src/MipChain.cpp
+#include "MipChain.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPCHAIN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static const int kEncodeSteps = 8192;            // linear -> sRGB table resolution, < 0.5 LSB error
+static const int kBandRows = 32;                 // destination rows per helper thread job
+static const size_t kParallelPixels = 64 * 1024; // smaller levels run on the calling thread
+static const int kCoverageIterations = 12;
+
+// ---- conversion tables ----
+namespace
+{
+    struct Tables
+    {
+        float srgbToLinear[256];
+        float unormToFloat[256];
+        unsigned char linearToSrgb[kEncodeSteps + 1];
+
+        Tables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                float c = i / 255.0f;
+                srgbToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                unormToFloat[i] = c;
+            }
+            for (int i = 0; i <= kEncodeSteps; ++i)
+            {
+                float l = (float)i / kEncodeSteps;
+                float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                linearToSrgb[i] = (unsigned char)std::min(255.0f, c * 255.0f + 0.5f);
+            }
+        }
+    };
+}
+
+static const Tables &GetTables()
+{
+    static Tables tables;
+    return tables;
+}
+
+// ---- one RGBA float pixel ----
+#ifdef MIPCHAIN_SSE2
+typedef __m128 Pixel;
+static inline Pixel PixelSet(float r, float g, float b, float a) { return _mm_set_ps(a, b, g, r); }
+static inline Pixel PixelLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline void PixelStore(float *p, Pixel v) { _mm_storeu_ps(p, v); }
+static inline Pixel PixelAverage(Pixel a, Pixel b, Pixel c, Pixel d)
+{
+    return _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), _mm_set1_ps(0.25f));
+}
+#else
+struct Pixel
+{
+    float v[4];
+};
+static inline Pixel PixelSet(float r, float g, float b, float a) { return Pixel{{r, g, b, a}}; }
+static inline Pixel PixelLoad(const float *p) { return Pixel{{p[0], p[1], p[2], p[3]}}; }
+static inline void PixelStore(float *p, Pixel v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline Pixel PixelAverage(Pixel a, Pixel b, Pixel c, Pixel d)
+{
+    Pixel r;
+    for (int k = 0; k < 4; ++k)
+        r.v[k] = (a.v[k] + b.v[k] + c.v[k] + d.v[k]) * 0.25f;
+    return r;
+}
+#endif
+
+// ---- filtering ----
+// level 0 (RGBA8) -> level 1 (premultiplied linear floats), rows [y0, y1)
+static void DownsampleBytes(const unsigned char *src, int width, int height, const float *toLinear, bool premultiply,
+                            float *dst, int dw, int y0, int y1)
+{
+    auto texel = [&](int x, int y)
+    {
+        const unsigned char *p = src + ((size_t)y * width + x) * 4;
+        float a = p[3] / 255.0f;
+        float w = premultiply ? a : 1.0f;
+        return PixelSet(toLinear[p[0]] * w, toLinear[p[1]] * w, toLinear[p[2]] * w, a);
+    };
+    for (int y = y0; y < y1; ++y)
+    {
+        int sy0 = std::min(2 * y, height - 1), sy1 = std::min(2 * y + 1, height - 1);
+        float *o = dst + (size_t)y * dw * 4;
+        for (int x = 0; x < dw; ++x, o += 4)
+        {
+            int sx0 = std::min(2 * x, width - 1), sx1 = std::min(2 * x + 1, width - 1);
+            PixelStore(o, PixelAverage(texel(sx0, sy0), texel(sx1, sy0), texel(sx0, sy1), texel(sx1, sy1)));
+        }
+    }
+}
+
+// float level -> next float level, rows [y0, y1)
+static void DownsampleFloats(const float *src, int width, int height, float *dst, int dw, int y0, int y1)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        const float *r0 = src + (size_t)std::min(2 * y, height - 1) * width * 4;
+        const float *r1 = src + (size_t)std::min(2 * y + 1, height - 1) * width * 4;
+        float *o = dst + (size_t)y * dw * 4;
+        for (int x = 0; x < dw; ++x, o += 4)
+        {
+            int sx0 = std::min(2 * x, width - 1) * 4, sx1 = std::min(2 * x + 1, width - 1) * 4;
+            PixelStore(o, PixelAverage(PixelLoad(r0 + sx0), PixelLoad(r0 + sx1), PixelLoad(r1 + sx0),
+                                       PixelLoad(r1 + sx1)));
+        }
+    }
+}
+
+// float level -> RGBA8, rows [y0, y1). alphaScale is the coverage correction.
+static void EncodeRows(const float *src, int width, int y0, int y1, bool srgb, bool premultiplied,
+                       float alphaScale, unsigned char *dst)
+{
+    const unsigned char *toSrgb = GetTables().linearToSrgb;
+    const float steps = srgb ? (float)kEncodeSteps : 255.0f;
+    for (int y = y0; y < y1; ++y)
+    {
+        const float *p = src + (size_t)y * width * 4;
+        unsigned char *o = dst + (size_t)y * width * 4;
+        for (int x = 0; x < width; ++x, p += 4, o += 4)
+        {
+            float a = p[3];
+            float inv = premultiplied ? (a > 0.0f ? 1.0f / a : 0.0f) : 1.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                int i = (int)(std::min(std::max(p[k] * inv, 0.0f), 1.0f) * steps + 0.5f);
+                o[k] = srgb ? toSrgb[i] : (unsigned char)i;
+            }
+            o[3] = (unsigned char)(std::min(a * alphaScale, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+// split rows into bands for ParallelFor; small levels are not worth waking the helpers
+static void ForRowBands(int rows, size_t pixels, const std::function<void(int, int)> &body)
+{
+    if (pixels < kParallelPixels)
+    {
+        body(0, rows);
+        return;
+    }
+    size_t bands = (size_t)(rows + kBandRows - 1) / kBandRows;
+    ParallelFor(bands, [&](size_t b)
+                {
+                    int y0 = (int)b * kBandRows;
+                    body(y0, std::min(rows, y0 + kBandRows));
+                });
+}
+
+// ---- alpha coverage ----
+static float Coverage(const float *level, size_t pixels, float threshold)
+{
+    size_t passed = 0;
+    for (size_t i = 0; i < pixels; ++i)
+        passed += level[i * 4 + 3] >= threshold ? 1 : 0;
+    return (float)passed / (float)pixels;
+}
+
+// scale for this level's alpha so that the fraction of texels at or above cutoff is target:
+// search the threshold that gives the target coverage, then map it onto the cutoff
+static float CoverageScale(const float *level, size_t pixels, float cutoff, float target)
+{
+    float lo = 0.0f, hi = 1.0f;
+    for (int i = 0; i < kCoverageIterations; ++i)
+    {
+        float mid = 0.5f * (lo + hi);
+        if (Coverage(level, pixels, mid) > target)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    float threshold = 0.5f * (lo + hi);
+    return threshold > 0.0f ? cutoff / threshold : 1.0f;
+}
+
+void BuildMipChain(const unsigned char *rgba, int width, int height, bool hasAlpha, const MipSettings &settings,
+                   MipChain &out)
+{
+    out.levels.clear();
+    out.pixels.clear();
+    if (!rgba || width <= 0 || height <= 0)
+        return;
+
+    size_t total = 0;
+    for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        MipChain::Level lv;
+        lv.width = w;
+        lv.height = h;
+        lv.offset = total;
+        out.levels.push_back(lv);
+        total += (size_t)w * h * 4;
+        if (w == 1 && h == 1)
+            break;
+    }
+    out.pixels.resize(total);
+    memcpy(out.pixels.data(), rgba, out.Size(0));
+
+    const Tables &tables = GetTables();
+    const float *toLinear = settings.srgb ? tables.srgbToLinear : tables.unormToFloat;
+    // premultiplied filtering only matters (and only costs) when there is alpha
+    bool premultiplied = hasAlpha;
+    bool keepCoverage = hasAlpha && settings.alphaCutoff > 0.0f;
+    float targetCoverage = 0.0f;
+    if (keepCoverage)
+    {
+        size_t passed = 0, pixels = (size_t)width * height;
+        for (size_t i = 0; i < pixels; ++i)
+            passed += rgba[i * 4 + 3] / 255.0f >= settings.alphaCutoff ? 1 : 0;
+        targetCoverage = (float)passed / (float)pixels;
+    }
+
+    // every level is filtered from the float copy of the previous one, so only level 1 pays for
+    // the sRGB decode and rounding never accumulates
+    std::vector<float> cur, next;
+    for (size_t l = 1; l < out.levels.size(); ++l)
+    {
+        const MipChain::Level &src = out.levels[l - 1];
+        const MipChain::Level &dst = out.levels[l];
+        size_t pixels = (size_t)dst.width * dst.height;
+        next.resize(pixels * 4);
+        if (l == 1)
+        {
+            ForRowBands(dst.height, pixels, [&](int y0, int y1)
+                        { DownsampleBytes(rgba, src.width, src.height, toLinear, premultiplied, next.data(),
+                                          dst.width, y0, y1); });
+        }
+        else
+        {
+            ForRowBands(dst.height, pixels, [&](int y0, int y1)
+                        { DownsampleFloats(cur.data(), src.width, src.height, next.data(), dst.width, y0, y1); });
+        }
+
+        float alphaScale = keepCoverage ? CoverageScale(next.data(), pixels, settings.alphaCutoff, targetCoverage)
+                                        : 1.0f;
+        unsigned char *level = out.pixels.data() + dst.offset;
+        ForRowBands(dst.height, pixels, [&](int y0, int y1)
+                    { EncodeRows(next.data(), dst.width, y0, y1, settings.srgb, premultiplied, alphaScale, level); });
+        cur.swap(next);
+    }
+}
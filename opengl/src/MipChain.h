@@ -0,0 +1,38 @@
+// src/MipChain.h
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// How a texture's mip levels are filtered. Part of the baked .btx header, since a chain built
+// for one usage is wrong for another.
+struct MipSettings
+{
+    bool srgb = true;         // colour is sRGB encoded: filter in linear light
+    float alphaCutoff = 0.0f; // > 0: alpha tested at this value, keep the coverage of level 0
+};
+
+// Full RGBA8 mip chain down to 1x1 in one allocation, level 0 included.
+struct MipChain
+{
+    struct Level
+    {
+        int width = 0;
+        int height = 0;
+        size_t offset = 0; // bytes into pixels
+    };
+    std::vector<Level> levels;
+    std::vector<unsigned char> pixels;
+
+    const unsigned char *Data(size_t level) const { return pixels.data() + levels[level].offset; }
+    size_t Size(size_t level) const { return (size_t)levels[level].width * levels[level].height * 4; }
+};
+
+// Builds the chain with a 2x2 box filter (odd sizes repeat the last row/column). Filtering runs
+// on premultiplied linear floats in SSE2 registers, one pixel per register, so colour does not
+// darken towards the small levels and transparent texels do not bleed into opaque ones; large
+// levels are split into row bands on helper threads. With settings.alphaCutoff > 0 and an image
+// that has alpha, every level's alpha is scaled so the fraction of texels passing the alpha test
+// matches level 0 (Castano's coverage preservation), otherwise alpha-tested foliage and fur thin
+// out in the distance.
+void BuildMipChain(const unsigned char *rgba, int width, int height, bool hasAlpha, const MipSettings &settings,
+                   MipChain &out);
@@ -0,0 +1,650 @@
+// src/ObjLoader.cpp
+#include "ObjLoader.h"
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+// smaller files are parsed as one chunk, starting threads would cost more than it saves
+static const size_t kMinChunkBytes = 64 * 1024;
+// triangles per slice when accumulating smooth normals
+static const size_t kNormalSliceTriangles = 16 * 1024;
+
+enum CornerFlags : uint8_t
+{
+    kHasUV = 1,
+    kHasNormal = 2,
+    // negative (relative) indices are chunk-local until the chunk's base offsets are known
+    kRelPos = 4,
+    kRelUV = 8,
+    kRelNormal = 16
+};
+
+struct ObjCorner
+{
+    int32_t v = 0;
+    int32_t vt = 0;
+    int32_t vn = 0;
+    uint8_t flags = 0;
+};
+
+// o / g / usemtl, applying from firstTriangle of its chunk on
+struct ObjStatement
+{
+    enum Kind : uint8_t
+    {
+        Object,
+        Group,
+        Material
+    };
+    Kind kind;
+    uint32_t firstTriangle;
+    std::string name;
+};
+
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // three per triangle
+    std::vector<ObjStatement> statements;
+    std::vector<std::string> mtllibs;
+    size_t posBase = 0, uvBase = 0, normalBase = 0;
+    bool bad = false;
+};
+
+static inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static inline void SkipBlank(const char *&p, const char *end)
+{
+    while (p < end && IsBlank(*p))
+        ++p;
+}
+
+static inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+static const char *LineEnd(const char *p, const char *end)
+{
+    const void *nl = std::memchr(p, '\n', (size_t)(end - p));
+    return nl ? (const char *)nl : end;
+}
+
+// keyword followed by a blank (or the end of the line); advances p past it
+static bool Keyword(const char *&p, const char *eol, const char *kw)
+{
+    size_t n = std::strlen(kw);
+    if ((size_t)(eol - p) < n || std::memcmp(p, kw, n) != 0)
+        return false;
+    if (p + n < eol && !IsBlank(p[n]))
+        return false;
+    p += n;
+    return true;
+}
+
+// rest of the line without surrounding blanks
+static std::string RestOfLine(const char *p, const char *eol)
+{
+    SkipBlank(p, eol);
+    while (eol > p && IsBlank(eol[-1]))
+        --eol;
+    return std::string(p, eol);
+}
+
+// locale independent and much faster than strtof for the fixed notation exporters write
+static float ParseFloat(const char *&p, const char *end)
+{
+    SkipBlank(p, end);
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    double mantissa = 0.0;
+    while (p < end && IsDigit(*p))
+        mantissa = mantissa * 10.0 + (*p++ - '0');
+    int exponent = 0;
+    if (p < end && *p == '.')
+    {
+        ++p;
+        while (p < end && IsDigit(*p))
+        {
+            mantissa = mantissa * 10.0 + (*p++ - '0');
+            --exponent;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool eneg = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            eneg = *p++ == '-';
+        int e = 0;
+        while (p < end && IsDigit(*p))
+            e = e * 10 + (*p++ - '0');
+        exponent += eneg ? -e : e;
+    }
+    double value = exponent ? mantissa * std::pow(10.0, exponent) : mantissa;
+    return (float)(neg ? -value : value);
+}
+
+// 1-based or negative OBJ index; false if there are no digits
+static bool ParseIndex(const char *&p, const char *end, long long &out)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    if (p >= end || !IsDigit(*p))
+        return false;
+    long long v = 0;
+    while (p < end && IsDigit(*p))
+        v = v * 10 + (*p++ - '0');
+    out = neg ? -v : v;
+    return true;
+}
+
+// absolute indices become 0-based global ones, relative ones chunk-local (fixed up after the merge)
+static bool ResolveIndex(long long idx, size_t localCount, int32_t &out, uint8_t &flags, uint8_t relFlag)
+{
+    if (idx > 0)
+    {
+        out = (int32_t)(idx - 1);
+        return true;
+    }
+    if (idx < 0)
+    {
+        out = (int32_t)((long long)localCount + idx);
+        flags |= relFlag;
+        return true;
+    }
+    return false; // 0 is not a valid OBJ index
+}
+
+static void ParseFace(const char *p, const char *eol, ObjChunk &chunk, std::vector<ObjCorner> &poly)
+{
+    poly.clear();
+    for (;;)
+    {
+        SkipBlank(p, eol);
+        if (p >= eol)
+            break;
+        ObjCorner c;
+        long long idx;
+        bool ok = ParseIndex(p, eol, idx) && ResolveIndex(idx, chunk.positions.size(), c.v, c.flags, kRelPos);
+        if (ok && p < eol && *p == '/')
+        {
+            ++p;
+            if (p < eol && *p != '/')
+            {
+                ok = ParseIndex(p, eol, idx) && ResolveIndex(idx, chunk.texcoords.size(), c.vt, c.flags, kRelUV);
+                c.flags |= kHasUV;
+            }
+            if (ok && p < eol && *p == '/')
+            {
+                ++p;
+                ok = ParseIndex(p, eol, idx) && ResolveIndex(idx, chunk.normals.size(), c.vn, c.flags, kRelNormal);
+                c.flags |= kHasNormal;
+            }
+        }
+        if (!ok)
+        {
+            chunk.bad = true;
+            return;
+        }
+        poly.push_back(c);
+        while (p < eol && !IsBlank(*p))
+            ++p;
+    }
+    // triangulate as a fan (Assimp's aiProcess_Triangulate does the same for convex polygons)
+    for (size_t i = 1; i + 1 < poly.size(); ++i)
+    {
+        chunk.corners.push_back(poly[0]);
+        chunk.corners.push_back(poly[i]);
+        chunk.corners.push_back(poly[i + 1]);
+    }
+}
+
+static void ParseChunk(const char *p, const char *end, ObjChunk &chunk)
+{
+    std::vector<ObjCorner> poly;
+    while (p < end)
+    {
+        const char *eol = LineEnd(p, end);
+        SkipBlank(p, eol);
+        if (p < eol && *p != '#')
+        {
+            if (Keyword(p, eol, "v"))
+            {
+                float x = ParseFloat(p, eol);
+                float y = ParseFloat(p, eol);
+                float z = ParseFloat(p, eol);
+                chunk.positions.emplace_back(x, y, z);
+            }
+            else if (Keyword(p, eol, "vt"))
+            {
+                float u = ParseFloat(p, eol);
+                float v = ParseFloat(p, eol);
+                chunk.texcoords.emplace_back(u, 1.0f - v); // aiProcess_FlipUVs
+            }
+            else if (Keyword(p, eol, "vn"))
+            {
+                float x = ParseFloat(p, eol);
+                float y = ParseFloat(p, eol);
+                float z = ParseFloat(p, eol);
+                chunk.normals.emplace_back(x, y, z);
+            }
+            else if (Keyword(p, eol, "f"))
+                ParseFace(p, eol, chunk, poly);
+            else if (Keyword(p, eol, "o"))
+                chunk.statements.push_back({ObjStatement::Object, (uint32_t)(chunk.corners.size() / 3), RestOfLine(p, eol)});
+            else if (Keyword(p, eol, "g"))
+                chunk.statements.push_back({ObjStatement::Group, (uint32_t)(chunk.corners.size() / 3), RestOfLine(p, eol)});
+            else if (Keyword(p, eol, "usemtl"))
+                chunk.statements.push_back({ObjStatement::Material, (uint32_t)(chunk.corners.size() / 3), RestOfLine(p, eol)});
+            else if (Keyword(p, eol, "mtllib"))
+                chunk.mtllibs.push_back(RestOfLine(p, eol));
+            // s, l, p, vp and unknown statements are ignored
+        }
+        p = eol + 1;
+    }
+}
+
+// skip "-option value..." pairs in front of a map_* file name
+static void SkipTextureOptions(const char *&p, const char *eol)
+{
+    for (;;)
+    {
+        SkipBlank(p, eol);
+        if (p >= eol || *p != '-' || (p + 1 < eol && IsDigit(p[1])))
+            return;
+        while (p < eol && !IsBlank(*p))
+            ++p;
+        // option arguments: numbers or on/off
+        for (;;)
+        {
+            SkipBlank(p, eol);
+            const char *tok = p;
+            while (p < eol && !IsBlank(*p))
+                ++p;
+            std::string arg(tok, p);
+            bool numeric = !arg.empty() && (IsDigit(arg[0]) || arg[0] == '.' ||
+                                            (arg.size() > 1 && (arg[0] == '-' || arg[0] == '+') &&
+                                             (IsDigit(arg[1]) || arg[1] == '.')));
+            if (!numeric && arg != "on" && arg != "off")
+            {
+                p = tok;
+                break;
+            }
+        }
+    }
+}
+
+static void ParseMtl(const std::string &path, std::vector<ObjMaterial> &materials)
+{
+    AssetData file;
+    if (!ReadAsset(path, file))
+    {
+        std::cerr << "ObjLoader: cannot open material library " << path << "\n";
+        return;
+    }
+    const char *p = (const char *)file.Data();
+    const char *end = p + file.Size();
+    ObjMaterial *cur = nullptr;
+    while (p < end)
+    {
+        const char *eol = LineEnd(p, end);
+        SkipBlank(p, eol);
+        if (Keyword(p, eol, "newmtl"))
+        {
+            materials.emplace_back();
+            cur = &materials.back();
+            cur->name = RestOfLine(p, eol);
+        }
+        else if (cur && Keyword(p, eol, "Kd"))
+        {
+            float r = ParseFloat(p, eol);
+            float g = ParseFloat(p, eol);
+            float b = ParseFloat(p, eol);
+            cur->diffuse = glm::vec3(r, g, b);
+        }
+        else if (cur && Keyword(p, eol, "d"))
+            cur->opacity = ParseFloat(p, eol);
+        else if (cur && Keyword(p, eol, "Tr"))
+            cur->opacity = 1.0f - ParseFloat(p, eol);
+        else if (cur && Keyword(p, eol, "map_Kd"))
+        {
+            SkipTextureOptions(p, eol);
+            cur->diffuseMap = RestOfLine(p, eol);
+        }
+        p = eol + 1;
+    }
+}
+
+// chunk boundaries on line starts, roughly equal in size
+static std::vector<const char *> SplitChunks(const char *begin, const char *end)
+{
+    size_t size = (size_t)(end - begin);
+    size_t count = std::max<size_t>(1, std::min<size_t>(size / kMinChunkBytes, std::max(1u, std::thread::hardware_concurrency()) * 4));
+    std::vector<const char *> bounds;
+    bounds.push_back(begin);
+    for (size_t i = 1; i < count; ++i)
+    {
+        const char *p = std::max(begin + size * i / count, bounds.back());
+        p = LineEnd(p, end);
+        if (p < end)
+            ++p;
+        if (p > bounds.back() && p < end)
+            bounds.push_back(p);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+struct CornerKey
+{
+    int32_t v, vt, vn;
+    bool operator==(const CornerKey &o) const { return v == o.v && vt == o.vt && vn == o.vn; }
+};
+
+struct CornerKeyHash
+{
+    size_t operator()(const CornerKey &k) const
+    {
+        uint64_t h = (uint64_t)(uint32_t)k.v * 0x9E3779B97F4A7C15ull;
+        h ^= (uint64_t)(uint32_t)k.vt * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+        h ^= (uint64_t)(uint32_t)k.vn * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+        return (size_t)h;
+    }
+};
+
+// triangles [first, first + count) of one chunk
+struct TriangleRange
+{
+    uint32_t chunk;
+    uint32_t first;
+    uint32_t count;
+};
+
+// per mesh data only needed while generating normals
+struct MeshScratch
+{
+    std::vector<TriangleRange> ranges;
+    std::vector<uint32_t> vertexPos; // position slot of every vertex
+    std::vector<char> needsNormal;   // per vertex: no vn in the file
+    uint32_t positionSlots = 0;
+    bool anyMissingNormal = false;
+};
+
+// Area weighted face normals summed per position (so UV seams stay smooth, as with Assimp's
+// position matching), for the vertices that have no normal from the file.
+static void GenerateSmoothNormals(ObjMesh &mesh, const MeshScratch &scratch)
+{
+    size_t triCount = mesh.indices.size() / 3;
+    size_t slices = std::max<size_t>(1, (triCount + kNormalSliceTriangles - 1) / kNormalSliceTriangles);
+    std::vector<std::vector<glm::vec3>> partial(slices);
+    ParallelFor(slices, [&](size_t s)
+                {
+                    std::vector<glm::vec3> &acc = partial[s];
+                    acc.assign(scratch.positionSlots, glm::vec3(0.0f));
+                    size_t end = std::min(triCount, (s + 1) * kNormalSliceTriangles);
+                    for (size_t t = s * kNormalSliceTriangles; t < end; ++t)
+                    {
+                        unsigned int a = mesh.indices[t * 3 + 0];
+                        unsigned int b = mesh.indices[t * 3 + 1];
+                        unsigned int c = mesh.indices[t * 3 + 2];
+                        glm::vec3 n = glm::cross(mesh.vertices[b].pos - mesh.vertices[a].pos,
+                                                 mesh.vertices[c].pos - mesh.vertices[a].pos);
+                        acc[scratch.vertexPos[a]] += n;
+                        acc[scratch.vertexPos[b]] += n;
+                        acc[scratch.vertexPos[c]] += n;
+                    }
+                });
+
+    // reduce the slices into partial[0], split by position range
+    size_t stride = std::max<size_t>(1024, (scratch.positionSlots + slices - 1) / slices);
+    size_t ranges = (scratch.positionSlots + stride - 1) / stride;
+    ParallelFor(ranges, [&](size_t r)
+                {
+                    size_t end = std::min<size_t>(scratch.positionSlots, (r + 1) * stride);
+                    for (size_t i = r * stride; i < end; ++i)
+                    {
+                        glm::vec3 sum = partial[0][i];
+                        for (size_t s = 1; s < slices; ++s)
+                            sum += partial[s][i];
+                        float len = glm::length(sum);
+                        partial[0][i] = len > 0.0f ? sum / len : glm::vec3(0.0f, 1.0f, 0.0f);
+                    }
+                });
+
+    for (size_t v = 0; v < mesh.vertices.size(); ++v)
+    {
+        if (scratch.needsNormal[v])
+            mesh.vertices[v].normal = partial[0][scratch.vertexPos[v]];
+    }
+}
+
+bool LoadObj(const std::string &path, ObjScene &out, ObjLoadStats *stats)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    Clock::time_point t0 = Clock::now();
+
+    out = ObjScene();
+    AssetData file;
+    if (!ReadAsset(path, file))
+    {
+        std::cerr << "ObjLoader: cannot open " << path << "\n";
+        return false;
+    }
+    const char *begin = (const char *)file.Data();
+    std::vector<const char *> bounds = SplitChunks(begin, begin + file.Size());
+    size_t chunkCount = bounds.size() - 1;
+    std::vector<ObjChunk> chunks(chunkCount);
+    ParallelFor(chunkCount, [&](size_t c)
+                { ParseChunk(bounds[c], bounds[c + 1], chunks[c]); });
+
+    // global offsets of every chunk's v / vt / vn
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texcoords;
+    size_t posCount = 0, uvCount = 0, normalCount = 0;
+    for (auto &ch : chunks)
+    {
+        if (ch.bad)
+        {
+            std::cerr << "ObjLoader: malformed face in " << path << "\n";
+            return false;
+        }
+        ch.posBase = posCount;
+        ch.uvBase = uvCount;
+        ch.normalBase = normalCount;
+        posCount += ch.positions.size();
+        uvCount += ch.texcoords.size();
+        normalCount += ch.normals.size();
+    }
+    positions.resize(posCount);
+    texcoords.resize(uvCount);
+    normals.resize(normalCount);
+    ParallelFor(chunkCount, [&](size_t c)
+                {
+                    ObjChunk &ch = chunks[c];
+                    std::copy(ch.positions.begin(), ch.positions.end(), positions.begin() + ch.posBase);
+                    std::copy(ch.texcoords.begin(), ch.texcoords.end(), texcoords.begin() + ch.uvBase);
+                    std::copy(ch.normals.begin(), ch.normals.end(), normals.begin() + ch.normalBase);
+                    for (auto &cn : ch.corners)
+                    {
+                        if (cn.flags & kRelPos)
+                            cn.v += (int32_t)ch.posBase;
+                        if (cn.flags & kRelUV)
+                            cn.vt += (int32_t)ch.uvBase;
+                        if (cn.flags & kRelNormal)
+                            cn.vn += (int32_t)ch.normalBase;
+                        if (cn.v < 0 || (size_t)cn.v >= posCount ||
+                            ((cn.flags & kHasUV) && (cn.vt < 0 || (size_t)cn.vt >= uvCount)) ||
+                            ((cn.flags & kHasNormal) && (cn.vn < 0 || (size_t)cn.vn >= normalCount)))
+                            ch.bad = true;
+                    }
+                });
+    for (const auto &ch : chunks)
+    {
+        if (ch.bad)
+        {
+            std::cerr << "ObjLoader: index out of range in " << path << "\n";
+            return false;
+        }
+    }
+
+    // materials, in the order the libraries are referenced
+    size_t slash = path.find_last_of("/\\");
+    std::string directory = (slash == std::string::npos) ? "." : path.substr(0, slash);
+    for (const auto &ch : chunks)
+    {
+        for (const auto &lib : ch.mtllibs)
+            ParseMtl(directory + "/" + lib, out.materials);
+    }
+    std::unordered_map<std::string, uint32_t> materialIds;
+    for (size_t i = 0; i < out.materials.size(); ++i)
+        materialIds.emplace(out.materials[i].name, (uint32_t)i);
+    int64_t defaultMaterial = -1;
+
+    // walk the o/g/usemtl statements in file order and hand every triangle run to its mesh
+    std::vector<MeshScratch> scratch;
+    std::vector<std::unordered_map<uint32_t, uint32_t>> objectMeshes; // material -> mesh, per object
+    bool sawObject = false;
+    int64_t curObject = -1;
+    uint32_t curMaterial = 0;
+    bool materialSet = false;
+    auto newObject = [&](const std::string &name)
+    {
+        out.objects.push_back({name, {}});
+        objectMeshes.emplace_back();
+        curObject = (int64_t)out.objects.size() - 1;
+    };
+    auto emit = [&](uint32_t chunk, uint32_t first, uint32_t end)
+    {
+        if (end <= first)
+            return;
+        if (curObject < 0)
+            newObject("defaultobject");
+        if (!materialSet)
+        {
+            if (defaultMaterial < 0)
+            {
+                out.materials.emplace_back();
+                out.materials.back().name = "DefaultMaterial";
+                defaultMaterial = (int64_t)out.materials.size() - 1;
+            }
+            curMaterial = (uint32_t)defaultMaterial;
+            materialSet = true;
+        }
+        auto ins = objectMeshes[curObject].emplace(curMaterial, (uint32_t)out.meshes.size());
+        if (ins.second)
+        {
+            out.meshes.emplace_back();
+            out.meshes.back().material = curMaterial;
+            out.objects[curObject].meshes.push_back(ins.first->second);
+            scratch.emplace_back();
+        }
+        scratch[ins.first->second].ranges.push_back({chunk, first, end - first});
+    };
+    for (uint32_t c = 0; c < chunkCount; ++c)
+    {
+        const ObjChunk &ch = chunks[c];
+        uint32_t tri = 0;
+        for (const auto &st : ch.statements)
+        {
+            emit(c, tri, st.firstTriangle);
+            tri = st.firstTriangle;
+            if (st.kind == ObjStatement::Object)
+            {
+                sawObject = true;
+                newObject(st.name);
+            }
+            else if (st.kind == ObjStatement::Group)
+            {
+                // groups only split the file when it has no objects
+                if (!sawObject)
+                    newObject(st.name);
+            }
+            else
+            {
+                auto it = materialIds.find(st.name);
+                if (it != materialIds.end())
+                {
+                    curMaterial = it->second;
+                    materialSet = true;
+                }
+                else
+                {
+                    std::cerr << "ObjLoader: unknown material " << st.name << " in " << path << "\n";
+                    materialSet = false;
+                }
+            }
+        }
+        emit(c, tri, (uint32_t)(ch.corners.size() / 3));
+    }
+    Clock::time_point t1 = Clock::now();
+
+    // join identical v/vt/vn corners, one mesh per job
+    ParallelFor(out.meshes.size(), [&](size_t m)
+                {
+                    ObjMesh &mesh = out.meshes[m];
+                    MeshScratch &sc = scratch[m];
+                    size_t cornerCount = 0;
+                    for (const auto &r : sc.ranges)
+                        cornerCount += (size_t)r.count * 3;
+                    std::unordered_map<CornerKey, uint32_t, CornerKeyHash> vertexIds;
+                    std::unordered_map<int32_t, uint32_t> positionSlots;
+                    vertexIds.reserve(cornerCount / 2);
+                    mesh.indices.reserve(cornerCount);
+                    for (const auto &r : sc.ranges)
+                    {
+                        const ObjCorner *corners = chunks[r.chunk].corners.data() + (size_t)r.first * 3;
+                        for (size_t i = 0; i < (size_t)r.count * 3; ++i)
+                        {
+                            const ObjCorner &cn = corners[i];
+                            CornerKey key = {cn.v, (cn.flags & kHasUV) ? cn.vt : -1, (cn.flags & kHasNormal) ? cn.vn : -1};
+                            auto ins = vertexIds.emplace(key, (uint32_t)mesh.vertices.size());
+                            if (ins.second)
+                            {
+                                SimpleVertex v;
+                                v.pos = positions[cn.v];
+                                v.uv = key.vt >= 0 ? texcoords[key.vt] : glm::vec2(0.0f);
+                                v.normal = key.vn >= 0 ? normals[key.vn] : glm::vec3(0.0f);
+                                mesh.vertices.push_back(v);
+                                auto slot = positionSlots.emplace(cn.v, (uint32_t)positionSlots.size());
+                                sc.vertexPos.push_back(slot.first->second);
+                                sc.needsNormal.push_back(key.vn < 0);
+                                sc.anyMissingNormal |= key.vn < 0;
+                            }
+                            mesh.indices.push_back(ins.first->second);
+                        }
+                    }
+                    sc.positionSlots = (uint32_t)positionSlots.size();
+                });
+    Clock::time_point t2 = Clock::now();
+
+    for (size_t m = 0; m < out.meshes.size(); ++m)
+    {
+        if (scratch[m].anyMissingNormal)
+            GenerateSmoothNormals(out.meshes[m], scratch[m]);
+    }
+    Clock::time_point t3 = Clock::now();
+
+    if (out.meshes.empty())
+    {
+        std::cerr << "ObjLoader: no faces in " << path << "\n";
+        return false;
+    }
+    if (stats)
+    {
+        stats->chunks = (unsigned int)chunkCount;
+        stats->parseMs = ms(t0, t1);
+        stats->buildMs = ms(t1, t2);
+        stats->normalsMs = ms(t2, t3);
+    }
+    return true;
+}
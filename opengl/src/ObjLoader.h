@@ -0,0 +1,52 @@
+// src/ObjLoader.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "StaticModel.h"
+
+// Material fields StaticModel needs from a .mtl file
+struct ObjMaterial
+{
+    std::string name;
+    glm::vec3 diffuse = glm::vec3(0.6f); // Assimp's default when Kd is missing
+    float opacity = 1.0f;                // d (or 1 - Tr)
+    std::string diffuseMap;              // map_Kd as written, may be an absolute path from another machine
+};
+
+// Triangles of one object that share one material
+struct ObjMesh
+{
+    uint32_t material = 0;
+    std::vector<SimpleVertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+struct ObjObject
+{
+    std::string name;
+    std::vector<uint32_t> meshes;
+};
+
+struct ObjScene
+{
+    std::vector<ObjMaterial> materials;
+    std::vector<ObjMesh> meshes;
+    std::vector<ObjObject> objects; // in file order
+};
+
+struct ObjLoadStats
+{
+    unsigned int chunks = 0;
+    double parseMs = 0.0;   // parallel line parsing and index fix-up
+    double buildMs = 0.0;   // per-mesh vertex dedup
+    double normalsMs = 0.0; // smooth normals for faces without vn
+};
+
+// Native Wavefront OBJ/MTL reader that produces what Assimp does with StaticModel's import flags:
+// polygons fan-triangulated, V flipped, identical v/vt/vn corners joined, smooth normals generated
+// where the file has none, one mesh per (object, material) pair.
+// The file is mapped and split into line-aligned chunks that are parsed in parallel; meshes are then
+// built in parallel and normals are accumulated in parallel slices.
+bool LoadObj(const std::string &path, ObjScene &out, ObjLoadStats *stats = nullptr);
@@ -0,0 +1,259 @@
+// src/RenderQueue.cpp
+#include "RenderQueue.h"
+#include "GeometryArena.h"
+#include "StaticModel.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+static const uint64_t kDepthMask = 0xFFFFFF; // 24 bits
+
+static uint64_t QuantizeDepth(float depth)
+{
+    float d = glm::clamp(depth / RenderQueue::kMaxDepth, 0.0f, 1.0f);
+    return (uint64_t)(d * (float)kDepthMask);
+}
+
+// 16 bits standing for the material's uniform values: equal materials get equal bits, so they sort
+// next to each other (a collision only costs grouping, Execute still compares the values)
+static uint64_t MaterialBits(const RenderMaterial &m)
+{
+    float values[5] = {m.color.r, m.color.g, m.color.b, m.alphaCutoff, m.hasAlpha ? 1.0f : 0.0f};
+    uint32_t h = 2166136261u;
+    const unsigned char *bytes = (const unsigned char *)values;
+    for (size_t i = 0; i < sizeof(values); ++i)
+    {
+        h ^= bytes[i];
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 16)) & 0xFFFF;
+}
+
+// true when a cached uniform must be (re)sent: unknown this frame or a different value
+template <typename T>
+static bool Changed(bool known, T &cached, const T &value)
+{
+    if (known && cached == value)
+        return false;
+    cached = value;
+    return true;
+}
+
+void RenderQueue::Clear()
+{
+    items.clear();
+    order.clear();
+    programs.clear();
+    sorted = false;
+    stats = Stats();
+}
+
+uint32_t RenderQueue::ProgramSlot(const Shader *shader)
+{
+    for (uint32_t i = 0; i < programs.size(); ++i)
+        if (programs[i].shader == shader)
+            return i;
+    programs.push_back(ProgramState());
+    programs.back().shader = shader;
+    return (uint32_t)programs.size() - 1;
+}
+
+void RenderQueue::Submit(const RenderItem &item, float depth)
+{
+    if (!item.shader || (!item.model && !item.vao))
+        return;
+    uint32_t slot = ProgramSlot(item.shader);
+    const RenderMaterial &m = item.material;
+    uint64_t program = slot & 0xF;
+    uint64_t texture = m.texture & 0xFFFF;
+    uint64_t key = (uint64_t)item.pass << 62;
+    if (m.blend)
+        key |= (uint64_t)1 << 61 | (kDepthMask - QuantizeDepth(depth)) << 37 | program << 33 | texture << 17 |
+               MaterialBits(m) << 1;
+    else
+        key |= program << 57 | (uint64_t)(m.alphaTest ? 1 : 0) << 56 | texture << 40 | MaterialBits(m) << 24 |
+               QuantizeDepth(depth);
+    order.push_back(Entry{key, (uint32_t)items.size(), slot});
+    items.push_back(item);
+    sorted = false;
+}
+
+void RenderQueue::UseProgram(ProgramState &ps)
+{
+    if (boundShader == ps.shader)
+        return;
+    ps.shader->use();
+    boundShader = ps.shader;
+    stats.programChanges++;
+    if (!ps.known)
+    {
+        // the texture units never change: diffuse maps on 0, the shadow map on 3
+        ps.shader->setInt(UniformId::DiffuseMap, 0);
+        ps.shader->setInt(UniformId::ShadowMap, 3);
+    }
+}
+
+void RenderQueue::ApplyMaterial(ProgramState &ps, const RenderMaterial &m)
+{
+    const Shader &sh = *ps.shader;
+    auto upload = [&](UniformId id) -> GLint
+    {
+        GLint loc = sh.location(id);
+        if (loc >= 0)
+            stats.uniformUploads++;
+        return loc;
+    };
+    int hasDiffuse = m.texture ? 1 : 0;
+    if (Changed(ps.known, ps.hasDiffuse, hasDiffuse))
+        glUniform1i(upload(UniformId::HasDiffuse), hasDiffuse);
+    int hasAlpha = m.hasAlpha ? 1 : 0;
+    if (Changed(ps.known, ps.hasAlpha, hasAlpha))
+        glUniform1i(upload(UniformId::HasAlpha), hasAlpha);
+    int useAlphaTest = m.alphaTest ? 1 : 0;
+    if (Changed(ps.known, ps.useAlphaTest, useAlphaTest))
+        glUniform1i(upload(UniformId::UseAlphaTest), useAlphaTest);
+    if (Changed(ps.known, ps.alphaCutoff, m.alphaCutoff))
+        glUniform1f(upload(UniformId::AlphaCutoff), m.alphaCutoff);
+    if (Changed(ps.known, ps.color, m.color))
+        glUniform3f(upload(UniformId::MatDiffuse), m.color.r, m.color.g, m.color.b);
+    ps.known = true;
+
+    // a program that does not sample uDiffuseMap (or a material without a map) leaves unit 0 alone
+    if (m.texture && m.texture != boundTexture && sh.location(UniformId::DiffuseMap) >= 0)
+    {
+        glBindTexture(GL_TEXTURE_2D, m.texture);
+        boundTexture = m.texture;
+        stats.textureBinds++;
+    }
+
+    if (m.blend != blendOn)
+    {
+        if (m.blend)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+        blendOn = m.blend;
+        stats.blendChanges++;
+    }
+    if (m.depthWrite != depthWriteOn)
+    {
+        glDepthMask(m.depthWrite ? GL_TRUE : GL_FALSE);
+        depthWriteOn = m.depthWrite;
+    }
+}
+
+void RenderQueue::ApplyTransform(ProgramState &ps, const RenderItem &item)
+{
+    if (!item.model)
+        return; // a caller's vertex array positions itself
+    const Shader &sh = *ps.shader;
+    int instanced = item.instances > 0 ? 1 : 0;
+    if (Changed(ps.modelKnown, ps.instanced, instanced) && sh.location(UniformId::Instanced) >= 0)
+    {
+        glUniform1i(sh.location(UniformId::Instanced), instanced);
+        stats.uniformUploads++;
+    }
+    // instances carry their own matrix, uModel is only the prototype's dequantization
+    glm::mat4 model = instanced ? item.model->DequantMatrix() : item.transform * item.model->DequantMatrix();
+    if (Changed(ps.modelKnown, ps.model, model) && sh.location(UniformId::Model) >= 0)
+    {
+        sh.setMat4(UniformId::Model, model);
+        stats.uniformUploads++;
+    }
+    ps.modelKnown = true;
+    if (instanced)
+        return;
+    glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(item.transform)));
+    if (Changed(ps.normalKnown, ps.normalMat, normalMat) && sh.location(UniformId::NormalMat) >= 0)
+    {
+        sh.setMat3(UniformId::NormalMat, normalMat);
+        stats.uniformUploads++;
+    }
+    ps.normalKnown = true;
+}
+
+void RenderQueue::BindGeometry(const RenderItem &item)
+{
+    if (!item.model)
+    {
+        if (boundArena || boundVao != item.vao)
+        {
+            glBindVertexArray(item.vao);
+            boundArena = nullptr;
+            boundVao = item.vao;
+            stats.geometryBinds++;
+        }
+        return;
+    }
+    const GeometryArena *arena = item.model->Arena();
+    GLuint instanceBuffer = item.instances > 0 ? item.instanceBuffer : 0;
+    size_t instanceOffset = item.instances > 0 ? item.instanceOffset : 0;
+    if (!arena || (arena == boundArena && instanceBuffer == boundInstanceBuffer && instanceOffset == boundInstanceOffset))
+        return;
+    if (instanceBuffer)
+        arena->BindInstanced(instanceBuffer, instanceOffset);
+    else
+        arena->Bind();
+    boundArena = arena;
+    boundVao = 0;
+    boundInstanceBuffer = instanceBuffer;
+    boundInstanceOffset = instanceOffset;
+    stats.geometryBinds++;
+}
+
+void RenderQueue::Execute(RenderPass pass)
+{
+    if (!sorted)
+    {
+        std::sort(order.begin(), order.end());
+        sorted = true;
+    }
+    auto first = std::lower_bound(order.begin(), order.end(), Entry{(uint64_t)pass << 62, 0, 0});
+    auto last = std::lower_bound(first, order.end(), Entry{((uint64_t)pass + 1) << 62, 0, 0});
+
+    // the caller may have touched any of it since the last pass; uniforms only change through here
+    boundShader = nullptr;
+    boundArena = nullptr;
+    boundVao = 0;
+    boundInstanceBuffer = 0;
+    boundInstanceOffset = 0;
+    glActiveTexture(GL_TEXTURE0);
+    boundTexture = 0;
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_BLEND);
+    blendOn = false;
+    glDepthMask(GL_TRUE);
+    depthWriteOn = true;
+
+    for (auto it = first; it != last; ++it)
+    {
+        const RenderItem &item = items[it->item];
+        ProgramState &ps = programs[it->program];
+        UseProgram(ps);
+        ApplyMaterial(ps, item.material);
+        ApplyTransform(ps, item);
+        BindGeometry(item);
+        if (item.model)
+            item.model->DrawMesh(item.mesh, item.lod, item.instances);
+        else if (item.instances > 0)
+            glDrawArraysInstanced(GL_TRIANGLES, 0, item.vertexCount, item.instances);
+        else
+            glDrawArrays(GL_TRIANGLES, 0, item.vertexCount);
+        stats.draws++;
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (blendOn)
+        glDisable(GL_BLEND);
+    if (!depthWriteOn)
+        glDepthMask(GL_TRUE);
+}
+
+void RenderQueue::PrintStats() const
+{
+    printf("RenderQueue: %u draws, %u program changes, %u geometry binds, %u texture binds, %u uniform uploads, "
+           "%u blend changes (last frame)\n",
+           stats.draws, stats.programChanges, stats.geometryBinds, stats.textureBinds, stats.uniformUploads,
+           stats.blendChanges);
+}
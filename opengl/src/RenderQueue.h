@@ -0,0 +1,136 @@
+// src/RenderQueue.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+class StaticModel;
+class GeometryArena;
+
+enum class RenderPass : uint8_t
+{
+    Shadow, // depth only, into the shadow map
+    Main
+};
+
+// the state a draw needs from its material; RenderQueue::Execute applies only what differs from
+// the previous draw with the same program
+struct RenderMaterial
+{
+    GLuint texture = 0; // diffuse map on unit 0, 0: uMatDiffuse alone
+    glm::vec3 color = glm::vec3(1.0f);
+    bool hasAlpha = false;
+    bool alphaTest = false;
+    float alphaCutoff = 0.5f;
+    bool blend = false; // alpha blended, drawn after everything opaque
+    bool depthWrite = true;
+};
+
+// One draw: a StaticModel mesh (optionally instanced from an InstanceData buffer) or a caller's
+// vertex array drawn with glDrawArrays (optionally instanced through attributes the VAO already has).
+struct RenderItem
+{
+    RenderPass pass = RenderPass::Main;
+    const Shader *shader = nullptr;
+    RenderMaterial material;
+
+    const StaticModel *model = nullptr;
+    uint32_t mesh = 0;
+    int lod = 0;
+    glm::mat4 transform = glm::mat4(1.0f); // world matrix without the model's DequantMatrix; not for instances
+
+    GLuint vao = 0;
+    GLsizei vertexCount = 0;
+
+    // instances > 0: an instanced draw; model meshes read their InstanceData from instanceBuffer
+    GLuint instanceBuffer = 0;
+    size_t instanceOffset = 0; // bytes
+    GLsizei instances = 0;
+};
+
+// Draws of a frame are submitted in any order and executed sorted by a 64-bit key, so draws that
+// share a program, material and texture run back to back:
+//   63-62 pass | 61 blended | opaque:  60-57 program | 56 alpha test | 55-40 texture | 39-24 material | 23-0 depth
+//                           | blended: 60-37 far-to-near depth | 36-33 program | 32-17 texture | 16-1 material
+// Opaque draws go front to back within their state group (early depth rejection), blended ones back
+// to front across programs, after every opaque draw of the pass. Execute tracks the bound program,
+// geometry, texture, blend state and each program's uniforms, and skips every call that would set
+// what is already set. Uniform values are assumed unknown at the start of the frame (Clear), so a
+// program relinked by a hot reload is set up again. GL thread only.
+class RenderQueue
+{
+public:
+    struct Stats
+    {
+        unsigned int draws = 0;
+        unsigned int programChanges = 0;
+        unsigned int geometryBinds = 0;
+        unsigned int textureBinds = 0;
+        unsigned int uniformUploads = 0;
+        unsigned int blendChanges = 0;
+    };
+
+    // start of the frame: drops last frame's items and forgets the cached state
+    void Clear();
+    // depth: distance from the camera, for the ordering inside a state group
+    void Submit(const RenderItem &item, float depth);
+    // sorts the items and runs those of one pass; the caller binds the pass's framebuffer
+    void Execute(RenderPass pass);
+
+    const Stats &GetStats() const { return stats; } // this frame so far
+    void PrintStats() const;
+
+    static constexpr float kMaxDepth = 256.0f; // distances beyond it share the last depth step
+
+private:
+    // what each program's uniforms are known to hold this frame
+    struct ProgramState
+    {
+        const Shader *shader = nullptr;
+        bool known = false; // false: nothing set yet this frame
+        int hasDiffuse = 0;
+        int hasAlpha = 0;
+        int useAlphaTest = 0;
+        float alphaCutoff = 0.0f;
+        glm::vec3 color = glm::vec3(0.0f);
+        int instanced = 0;
+        bool modelKnown = false;
+        glm::mat4 model = glm::mat4(1.0f);
+        bool normalKnown = false; // instanced draws leave uNormalMat as it was
+        glm::mat3 normalMat = glm::mat3(1.0f);
+    };
+
+    uint32_t ProgramSlot(const Shader *shader);
+    void UseProgram(ProgramState &ps);
+    void ApplyMaterial(ProgramState &ps, const RenderMaterial &material);
+    void ApplyTransform(ProgramState &ps, const RenderItem &item);
+    void BindGeometry(const RenderItem &item);
+
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t item;
+        uint32_t program; // index into programs
+        bool operator<(const Entry &o) const { return key < o.key; }
+    };
+
+    std::vector<RenderItem> items;
+    std::vector<Entry> order;
+    bool sorted = false;
+    std::vector<ProgramState> programs; // by first submission this frame
+
+    // bound state
+    const Shader *boundShader = nullptr;
+    const GeometryArena *boundArena = nullptr; // null: boundVao is a caller's vertex array
+    GLuint boundVao = 0;
+    GLuint boundInstanceBuffer = 0; // with boundArena: 0 for its plain VAO
+    size_t boundInstanceOffset = 0;
+    GLuint boundTexture = 0;
+    bool blendOn = false;
+    bool depthWriteOn = true;
+
+    Stats stats;
+};
@@ -0,0 +1,522 @@
+// src/ResourceManager.cpp
+#include "ResourceManager.h"
+#include "AssetLoader.h"
+#include "MeshCache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+static double MsSince(std::chrono::high_resolution_clock::time_point t0,
+                      std::chrono::high_resolution_clock::time_point t1)
+{
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+static std::string NormalizedPath(const std::string &path)
+{
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+static bool HasExtension(const std::string &path, const char *ext)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string e = path.substr(dot + 1);
+    for (auto &c : e)
+        c = (char)tolower(c);
+    return e == ext;
+}
+
+static const char *TypeName(ResourceType type)
+{
+    switch (type)
+    {
+    case ResourceType::Model:
+        return "model";
+    case ResourceType::Texture:
+        return "texture";
+    default:
+        return "sound";
+    }
+}
+
+static const char *StateName(ResourceState state)
+{
+    switch (state)
+    {
+    case ResourceState::Unloaded:
+        return "unloaded";
+    case ResourceState::Loading:
+        return "loading";
+    case ResourceState::Resident:
+        return "resident";
+    default:
+        return "FAILED";
+    }
+}
+
+ResourceManager &ResourceManager::Instance()
+{
+    static ResourceManager manager;
+    return manager;
+}
+
+void ResourceManager::SetBudgets(size_t cpuBytes, size_t gpuBytes)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    cpuBudget = cpuBytes;
+    gpuBudget = gpuBytes;
+}
+
+ResourceHandle ResourceManager::Add(ResourceType type, const std::string &path)
+{
+    std::string key = std::string(TypeName(type)) + "|" + path;
+    auto it = byPath.find(key);
+    if (it != byPath.end())
+        return ResourceHandle{it->second};
+    slots.emplace_back();
+    Slot &s = slots.back();
+    s.type = type;
+    s.path = path;
+    s.name = path.substr(path.find_last_of("/\\") + 1);
+    uint32_t id = (uint32_t)slots.size();
+    byPath[key] = id;
+    return ResourceHandle{id};
+}
+
+ResourceHandle ResourceManager::AddModel(const std::string &path, VertexFormat format, const glm::vec3 &scale)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    ResourceHandle h = Add(ResourceType::Model, path);
+    Slot &s = slots[h.id - 1];
+    s.format = format;
+    s.scale = scale;
+    return h;
+}
+
+ResourceHandle ResourceManager::AddTexture(const std::string &path, TextureColorSpace space)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    ResourceHandle h = Add(ResourceType::Texture, path);
+    slots[h.id - 1].space = space;
+    return h;
+}
+
+ResourceHandle ResourceManager::AddSound(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return Add(ResourceType::Sound, path);
+}
+
+ResourceManager::Slot *ResourceManager::Find(ResourceHandle h)
+{
+    return h.id > 0 && h.id <= slots.size() ? &slots[h.id - 1] : nullptr;
+}
+
+const ResourceManager::Slot *ResourceManager::Find(ResourceHandle h) const
+{
+    return h.id > 0 && h.id <= slots.size() ? &slots[h.id - 1] : nullptr;
+}
+
+void ResourceManager::SetPinned(ResourceHandle h, bool pinned)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (Slot *s = Find(h))
+        s->pinned = pinned;
+}
+
+void ResourceManager::SetModelScale(ResourceHandle h, const glm::vec3 &scale)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Slot *s = Find(h);
+    if (!s || s->type != ResourceType::Model)
+        return;
+    s->scale = scale;
+    if (s->state == ResourceState::Resident)
+        s->model->modelScale = scale;
+}
+
+bool ResourceManager::CpuPhase(Slot &s)
+{
+    switch (s.type)
+    {
+    case ResourceType::Model:
+    {
+        bool ok = s.model->Import(s.path);
+        if (!ok)
+            std::cerr << "ResourceManager: failed to load model " << s.path << "\n";
+        return ok;
+    }
+    case ResourceType::Texture:
+        TextureCache::Instance().Prefetch(s.path, s.space);
+        return true;
+    default:
+    {
+        bool ok = Audio::DecodeWAV(s.path, s.wav);
+        if (!ok)
+            std::cerr << "ResourceManager: failed to load sound " << s.path << "\n";
+        return ok;
+    }
+    }
+}
+
+bool ResourceManager::GlPhase(Slot &s)
+{
+    switch (s.type)
+    {
+    case ResourceType::Model:
+        if (!s.model->Upload())
+            return false;
+        s.model->modelScale = s.scale;
+        return true;
+    case ResourceType::Texture:
+        s.texture = TextureCache::Instance().Acquire(s.path, s.space);
+        return s.texture.id != 0;
+    default:
+    {
+        if (!audio)
+        {
+            std::cerr << "ResourceManager: no audio device for " << s.path << "\n";
+            return false;
+        }
+        s.sound = audio->CreateBuffer(s.wav);
+        size_t bytes = s.wav.pcm.size() * sizeof(int16_t);
+        s.wav = WavData();
+        s.cpuBytes = bytes;
+        return s.sound != 0;
+    }
+    }
+}
+
+void ResourceManager::StartLoad(Slot &s)
+{
+    s.state = ResourceState::Loading;
+    s.requested = Clock::now();
+    if (s.type == ResourceType::Model)
+    {
+        s.model.reset(new StaticModel());
+        s.model->vertexFormat = s.format;
+    }
+}
+
+void ResourceManager::FinishLoad(Slot &s, bool ok)
+{
+    s.latencyMs = MsSince(s.requested, Clock::now());
+    if (!ok)
+    {
+        s.state = ResourceState::Failed;
+        s.model.reset();
+        s.wav = WavData();
+        return;
+    }
+    s.state = ResourceState::Resident;
+    s.loads++;
+    totalLoads++;
+    RefreshBytes(s);
+}
+
+void ResourceManager::RefreshBytes(Slot &s)
+{
+    switch (s.type)
+    {
+    case ResourceType::Model:
+        s.cpuBytes = s.model->CpuBytes();
+        s.gpuBytes = s.model->GpuBytes();
+        break;
+    case ResourceType::Texture:
+        s.gpuBytes = TextureCache::Instance().ResidentBytes(s.texture.id); // changes with mip residency
+        break;
+    default:
+        break; // fixed when the buffer is created
+    }
+}
+
+void ResourceManager::Queue(AssetLoader &loader, ResourceHandle h)
+{
+    Slot *s;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        s = Find(h);
+        if (!s || s->state != ResourceState::Unloaded)
+            return;
+        StartLoad(*s);
+        s->lastUsed = frame;
+    }
+    loader.Add(s->name,
+               [this, s]()
+               {
+                   auto t0 = Clock::now();
+                   bool ok = CpuPhase(*s);
+                   std::lock_guard<std::mutex> lock(mtx);
+                   s->cpuMs = MsSince(t0, Clock::now());
+                   if (!ok)
+                       FinishLoad(*s, false);
+                   return ok;
+               },
+               [this, s]()
+               {
+                   std::lock_guard<std::mutex> lock(mtx);
+                   bool ok = GlPhase(*s);
+                   FinishLoad(*s, ok);
+                   return ok;
+               });
+}
+
+void ResourceManager::Request(ResourceHandle h)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Slot *s = Find(h);
+    if (!s)
+        return;
+    s->lastUsed = frame;
+    if (s->state != ResourceState::Unloaded)
+        return;
+    StartLoad(*s);
+    if (!workers)
+        workers.reset(new ThreadPool(1));
+    uint32_t id = h.id;
+    workers->Submit([this, s, id]()
+                    {
+                        auto t0 = Clock::now();
+                        bool ok = CpuPhase(*s);
+                        std::lock_guard<std::mutex> lock(mtx);
+                        s->cpuMs = MsSince(t0, Clock::now());
+                        if (ok)
+                            ready.push_back(id);
+                        else
+                            FinishLoad(*s, false);
+                    });
+}
+
+StaticModel *ResourceManager::GetModel(ResourceHandle h)
+{
+    Request(h);
+    std::lock_guard<std::mutex> lock(mtx);
+    const Slot *s = Find(h);
+    return s && s->type == ResourceType::Model && s->state == ResourceState::Resident ? s->model.get() : nullptr;
+}
+
+GLuint ResourceManager::GetTexture(ResourceHandle h)
+{
+    Request(h);
+    std::lock_guard<std::mutex> lock(mtx);
+    const Slot *s = Find(h);
+    return s && s->type == ResourceType::Texture && s->state == ResourceState::Resident ? s->texture.id : 0;
+}
+
+unsigned int ResourceManager::GetSound(ResourceHandle h)
+{
+    Request(h);
+    std::lock_guard<std::mutex> lock(mtx);
+    const Slot *s = Find(h);
+    return s && s->type == ResourceType::Sound && s->state == ResourceState::Resident ? s->sound : 0;
+}
+
+ResourceState ResourceManager::State(ResourceHandle h) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    const Slot *s = Find(h);
+    return s ? s->state : ResourceState::Failed;
+}
+
+void ResourceManager::Evict(Slot &s)
+{
+    switch (s.type)
+    {
+    case ResourceType::Model:
+        s.model.reset(); // frees the geometry and drops its texture references
+        break;
+    case ResourceType::Texture:
+        TextureCache::Instance().Release(s.texture.id);
+        s.texture = TextureHandle();
+        break;
+    default:
+        if (audio)
+            audio->DeleteBuffer(s.sound);
+        s.sound = 0;
+        break;
+    }
+    s.state = ResourceState::Unloaded;
+    s.cpuBytes = 0;
+    s.gpuBytes = 0;
+    s.evictions++;
+    totalEvictions++;
+}
+
+void ResourceManager::Reload(const std::string &path)
+{
+    std::string changed = NormalizedPath(path);
+    bool material = HasExtension(changed, "mtl");
+    std::lock_guard<std::mutex> lock(mtx);
+    for (uint32_t i = 0; i < slots.size(); ++i)
+    {
+        Slot &s = slots[i];
+        if (s.type != ResourceType::Model || s.state != ResourceState::Resident)
+            continue;
+        if (NormalizedPath(s.path) == changed)
+            StartReload(s, i + 1, "");
+        else if (material && HasExtension(s.path, "obj"))
+            StartReload(s, i + 1, changed); // the worker checks whether the .obj uses it
+    }
+}
+
+void ResourceManager::StartReload(Slot &s, uint32_t id, const std::string &material)
+{
+    if (s.next)
+    {
+        s.reloadAgain = true;
+        return;
+    }
+    s.next.reset(new StaticModel());
+    s.next->vertexFormat = s.format;
+    s.reloadStarted = Clock::now();
+    if (!workers)
+        workers.reset(new ThreadPool(1));
+    StaticModel *next = s.next.get();
+    std::string path = s.path;
+    workers->Submit([this, id, next, path, material]()
+                    {
+                        bool affected = material.empty();
+                        if (!affected)
+                        {
+                            for (const auto &lib : MeshCache::Dependencies(path))
+                                affected = affected || NormalizedPath(lib) == material;
+                        }
+                        bool ok = affected && next->Import(path);
+                        if (affected && !ok)
+                            std::cerr << "ResourceManager: failed to reload " << path << ", keeping the loaded version\n";
+                        std::lock_guard<std::mutex> lock(mtx);
+                        reloaded.emplace_back(id, ok);
+                    });
+}
+
+void ResourceManager::FinishReload(Slot &s, uint32_t id, bool ok)
+{
+    std::unique_ptr<StaticModel> next = std::move(s.next);
+    if (ok && s.state == ResourceState::Resident && next->Upload())
+    {
+        // what the game set on the loaded version
+        next->modelScale = s.scale;
+        next->modelMatrix = s.model->modelMatrix;
+        next->isMoving = s.model->isMoving;
+        next->animEnable = s.model->animEnable;
+        next->animBlend = s.model->animBlend;
+        s.model = std::move(next); // frees the old geometry and drops its texture references
+        RefreshBytes(s);
+        s.reloads++;
+        totalReloads++;
+        char line[160];
+        snprintf(line, sizeof(line), "ResourceManager: reloaded %s in %.2f ms", s.name.c_str(),
+                 MsSince(s.reloadStarted, Clock::now()));
+        std::cout << line << std::endl;
+    }
+    if (s.reloadAgain)
+    {
+        s.reloadAgain = false;
+        if (s.state == ResourceState::Resident)
+            StartReload(s, id, "");
+    }
+}
+
+void ResourceManager::Update()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (uint32_t id : ready)
+    {
+        Slot &s = slots[id - 1];
+        FinishLoad(s, GlPhase(s));
+    }
+    ready.clear();
+    std::vector<std::pair<uint32_t, bool>> imported;
+    imported.swap(reloaded);
+    for (const auto &r : imported)
+        FinishReload(slots[r.first - 1], r.first, r.second);
+
+    size_t cpu = 0, gpu = 0;
+    std::vector<Slot *> cold;
+    for (auto &s : slots)
+    {
+        if (s.state != ResourceState::Resident)
+            continue;
+        RefreshBytes(s);
+        cpu += s.cpuBytes;
+        gpu += s.gpuBytes;
+        if (!s.pinned && frame - s.lastUsed > kColdFrames)
+            cold.push_back(&s);
+    }
+    if (cpu > cpuBudget || gpu > gpuBudget)
+    {
+        std::sort(cold.begin(), cold.end(), [](const Slot *a, const Slot *b)
+                  { return a->lastUsed < b->lastUsed; });
+        for (size_t i = 0; i < cold.size() && (cpu > cpuBudget || gpu > gpuBudget); ++i)
+        {
+            cpu -= cold[i]->cpuBytes;
+            gpu -= cold[i]->gpuBytes;
+            std::cout << "ResourceManager: evicting " << cold[i]->name << " (unused for "
+                      << frame - cold[i]->lastUsed << " frames)" << std::endl;
+            Evict(*cold[i]);
+        }
+    }
+    frame++;
+}
+
+void ResourceManager::Shutdown()
+{
+    workers.reset(); // finishes the running CPU phases
+    std::lock_guard<std::mutex> lock(mtx);
+    ready.clear();
+    reloaded.clear();
+    for (auto &s : slots)
+    {
+        if (s.state == ResourceState::Resident)
+            Evict(s);
+        s.model.reset();
+        s.next.reset();
+    }
+}
+
+ResourceManager::Stats ResourceManager::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats st;
+    st.registered = (unsigned int)slots.size();
+    for (const auto &s : slots)
+    {
+        st.resident += s.state == ResourceState::Resident ? 1 : 0;
+        st.failed += s.state == ResourceState::Failed ? 1 : 0;
+        st.cpuBytes += s.cpuBytes;
+        st.gpuBytes += s.gpuBytes;
+    }
+    st.loads = totalLoads;
+    st.evictions = totalEvictions;
+    st.reloads = totalReloads;
+    st.cpuBudget = cpuBudget;
+    st.gpuBudget = gpuBudget;
+    return st;
+}
+
+void ResourceManager::PrintStats() const
+{
+    Stats st = GetStats();
+    const double kb = 1024.0, mb = 1024.0 * 1024.0;
+    char line[256];
+    snprintf(line, sizeof(line),
+             "ResourceManager: %u assets, %u resident, %u failed, %u loads, %u evictions, %u reloads, "
+             "CPU %.2f / %.0f MB, GPU %.2f / %.0f MB",
+             st.registered, st.resident, st.failed, st.loads, st.evictions, st.reloads, st.cpuBytes / mb,
+             st.cpuBudget / mb, st.gpuBytes / mb, st.gpuBudget / mb);
+    std::cout << line << "\n";
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &s : slots)
+    {
+        snprintf(line, sizeof(line), "  %-28s %-7s %-8s%s cpu %8.1f KB  gpu %8.1f KB  loads %u  evicted %u  "
+                                     "reloaded %u  latency %7.2f ms (cpu %7.2f ms)",
+                 s.name.c_str(), TypeName(s.type), StateName(s.state), s.pinned ? "*" : " ", s.cpuBytes / kb,
+                 s.gpuBytes / kb, s.loads, s.evictions, s.reloads, s.latencyMs, s.cpuMs);
+        std::cout << line << "\n";
+    }
+    std::cout.flush();
+}
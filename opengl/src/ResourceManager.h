@@ -0,0 +1,195 @@
+// src/ResourceManager.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Audio.h"
+#include "StaticModel.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+class AssetLoader;
+
+enum class ResourceType : uint8_t
+{
+    Model,
+    Texture,
+    Sound
+};
+
+enum class ResourceState : uint8_t
+{
+    Unloaded, // registered, or evicted
+    Loading,
+    Resident,
+    Failed // missing or broken file, not retried
+};
+
+// Index into the manager's registry; stays valid for the whole run, across evictions and reloads.
+struct ResourceHandle
+{
+    uint32_t id = 0; // 0: none
+    bool IsValid() const { return id != 0; }
+};
+
+// Registry of the game's models, textures and sounds, addressed by handle instead of owned by
+// the code that uses them. Registering costs nothing; an asset loads the first time it is asked
+// for (Request() or a Get*() that finds it unloaded): the CPU phase (import, decode) runs on a
+// background thread and the GL/AL phase in the next Update(), so a Get*() never blocks and
+// returns nothing until then. Assets needed from the first frame are queued on the startup
+// AssetLoader with Queue() instead.
+//
+// Update() also keeps the resident assets under a CPU and a GPU budget by evicting the least
+// recently used ones that have not been asked for in kColdFrames frames; pinned assets stay.
+// An evicted asset is simply loaded again when it is next asked for.
+// GPU bytes are model geometry plus textures registered here; the mip levels of model textures
+// are governed by the TextureCache's own budget. CPU bytes are sound samples (OpenAL keeps a copy)
+// and the models' CPU-side tables.
+// Reload() (hot reload) re-imports a resident model whose file changed in the background and
+// swaps it in at the next Update(); the old one keeps drawing until then.
+// Everything except Queue()'s CPU phases runs on the GL thread.
+class ResourceManager
+{
+public:
+    static ResourceManager &Instance();
+
+    // sounds need the device to create their buffers
+    void SetAudio(Audio *device) { audio = device; }
+    void SetBudgets(size_t cpuBytes, size_t gpuBytes);
+
+    // Register an asset (nothing is loaded). The same path and type returns the same handle.
+    ResourceHandle AddModel(const std::string &path, VertexFormat format = VertexFormat::Float,
+                            const glm::vec3 &scale = glm::vec3(1.0f));
+    ResourceHandle AddTexture(const std::string &path, TextureColorSpace space = TextureColorSpace::SRGB);
+    ResourceHandle AddSound(const std::string &path);
+    // pinned assets are never evicted
+    void SetPinned(ResourceHandle h, bool pinned);
+    // applied now if the model is resident and again whenever it is reloaded
+    void SetModelScale(ResourceHandle h, const glm::vec3 &scale);
+
+    // load through the startup loader (its Finish() uploads it) instead of lazily
+    void Queue(AssetLoader &loader, ResourceHandle h);
+    // start loading if unloaded and mark the asset used this frame
+    void Request(ResourceHandle h);
+    // the resident asset, or nullptr / 0 while it is not (loading starts as for Request())
+    StaticModel *GetModel(ResourceHandle h);
+    GLuint GetTexture(ResourceHandle h);
+    unsigned int GetSound(ResourceHandle h);
+    ResourceState State(ResourceHandle h) const;
+
+    // GL thread, once per frame: finish the loads whose CPU phase is done, then evict cold assets
+    // while over budget
+    void Update();
+    // GL thread, hot reload: path changed on disk. Resident models made from it, or from the
+    // material library it is, are imported again and replace the loaded version in Update(); if
+    // the new file does not load, the old version stays. Unloaded models read the new file when
+    // they load. Textures are reloaded by the TextureCache itself.
+    void Reload(const std::string &path);
+    // GL thread, before the context goes away: wait for running loads and release everything
+    void Shutdown();
+
+    static const unsigned int kColdFrames = 300; // about 5 s at 60 fps
+    static const size_t kDefaultCpuBudget = 128 * 1024 * 1024;
+    static const size_t kDefaultGpuBudget = 256 * 1024 * 1024;
+
+    struct Stats
+    {
+        unsigned int registered = 0;
+        unsigned int resident = 0;
+        unsigned int failed = 0;
+        unsigned int loads = 0;
+        unsigned int evictions = 0;
+        unsigned int reloads = 0;
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+        size_t cpuBudget = 0;
+        size_t gpuBudget = 0;
+    };
+    Stats GetStats() const;
+    // totals, then one line per asset: state, bytes, loads/evictions and load latency
+    void PrintStats() const;
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    ResourceManager() = default;
+    ResourceManager(const ResourceManager &) = delete;
+    ResourceManager &operator=(const ResourceManager &) = delete;
+
+    struct Slot
+    {
+        ResourceType type = ResourceType::Model;
+        std::string path;
+        std::string name; // file name, for the report
+        ResourceState state = ResourceState::Unloaded;
+        bool pinned = false;
+        unsigned int lastUsed = 0; // frame
+
+        // settings, reapplied on every load
+        VertexFormat format = VertexFormat::Float;
+        glm::vec3 scale = glm::vec3(1.0f);
+        TextureColorSpace space = TextureColorSpace::SRGB;
+
+        // the asset itself
+        std::unique_ptr<StaticModel> model;
+        TextureHandle texture;
+        unsigned int sound = 0;
+        WavData wav; // decoded samples between the two phases
+        // hot reload: the new version, imported on a worker while model keeps drawing
+        std::unique_ptr<StaticModel> next;
+        bool reloadAgain = false; // the file changed again meanwhile
+        Clock::time_point reloadStarted;
+
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+        unsigned int loads = 0;
+        unsigned int evictions = 0;
+        unsigned int reloads = 0;
+        Clock::time_point requested; // start of the current load
+        double cpuMs = 0.0;          // last load: background phase
+        double latencyMs = 0.0;      // last load: first request to resident
+    };
+
+    ResourceHandle Add(ResourceType type, const std::string &path);
+    // registry lookup, nullptr for an invalid handle; mtx held
+    Slot *Find(ResourceHandle h);
+    const Slot *Find(ResourceHandle h) const;
+    // mtx held: Unloaded -> Loading, the CPU phase goes to the workers
+    void StartLoad(Slot &s);
+    // the two halves of a load; CpuPhase runs without mtx on a worker or loader thread
+    bool CpuPhase(Slot &s);
+    bool GlPhase(Slot &s);
+    // mtx held: record the result of a load; a failed one needs no GL thread
+    void FinishLoad(Slot &s, bool ok);
+    // GL thread, mtx held
+    void Evict(Slot &s);
+    void RefreshBytes(Slot &s);
+    // mtx held: import a new version of a resident model into s.next; with a material path, only
+    // if the model still references that library
+    void StartReload(Slot &s, uint32_t id, const std::string &material);
+    // GL thread, mtx held: upload the finished s.next and put it in place of s.model
+    void FinishReload(Slot &s, uint32_t id, bool ok);
+
+    mutable std::mutex mtx;
+    std::deque<Slot> slots; // deque: slots stay put while more are added during loads
+    std::unordered_map<std::string, uint32_t> byPath; // type + path -> id
+    std::vector<uint32_t> ready;                       // CPU phase done, GL phase due in Update()
+    std::vector<std::pair<uint32_t, bool>> reloaded;   // Slot::next imported (or not), due in Update()
+    Audio *audio = nullptr;
+    size_t cpuBudget = kDefaultCpuBudget;
+    size_t gpuBudget = kDefaultGpuBudget;
+    unsigned int frame = 1;
+    unsigned int totalLoads = 0;
+    unsigned int totalEvictions = 0;
+    unsigned int totalReloads = 0;
+    // lazy loads trickle in one at a time; startup batches go through the AssetLoader's threads.
+    // Created on first use; declared last so it is joined first.
+    std::unique_ptr<ThreadPool> workers;
+};
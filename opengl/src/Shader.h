@@ -1,166 +1,360 @@
-#ifndef SHADER_H
-#define SHADER_H
-
-#include <glad/glad.h>
-#include <glm/glm.hpp>
-
-#include <string>
-#include <fstream>
-#include <sstream>
-#include <iostream>
-
-class Shader
-{
-public:
-    unsigned int ID;
-    // constructor generates the shader on the fly
-    // ------------------------------------------------------------------------
-    Shader(const char *vertexPath, const char *fragmentPath)
-    {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure &e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-    }
-    // activate the shader
-    // ------------------------------------------------------------------------
-    void use() const
-    {
-        glUseProgram(ID);
-    }
-    // utility uniform functions
-    // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
-    {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-    }
-    // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
-    {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
-    {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
-    {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-    }
-    void setVec2(const std::string &name, float x, float y) const
-    {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
-    }
-    // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
-    {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-    }
-    void setVec3(const std::string &name, float x, float y, float z) const
-    {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
-    }
-    // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
-    {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-    }
-    void setVec4(const std::string &name, float x, float y, float z, float w) const
-    {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
-    }
-    // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
-    {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-    }
-    // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
-    {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-    }
-    // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
-    {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-    }
-
-private:
-    // utility function for checking shader compilation/linking errors.
-    // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
-    {
-        GLint success;
-        GLchar infoLog[1024];
-        if (type != "PROGRAM")
-        {
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-            if (!success)
-            {
-                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n"
-                          << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            }
-        }
-        else
-        {
-            glGetProgramiv(shader, GL_LINK_STATUS, &success);
-            if (!success)
-            {
-                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n"
-                          << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            }
-        }
-    }
-};
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "AssetPack.h"
+
+#include <array>
+#include <string>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// uniforms the renderers set every frame: resolved once per link, then set through Shader::location(id)
+// instead of being looked up by name on every call
+enum class UniformId
+{
+    Model,
+    NormalMat,
+    Instanced,
+    ShadowMap,
+    HasDiffuse,
+    HasAlpha,
+    UseAlphaTest,
+    AlphaCutoff,
+    MatDiffuse,
+    DiffuseMap,
+    Ortho,
+    Color,
+    Tex,
+    Count
+};
+
+inline const char *uniformName(UniformId id)
+{
+    static const char *const names[] = {"uModel", "uNormalMat", "uInstanced", "uShadowMap", "uHasDiffuse",
+                                        "uHasAlpha", "uUseAlphaTest", "uAlphaCutoff", "uMatDiffuse", "uDiffuseMap",
+                                        "uOrtho", "uColor", "uTex"};
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)UniformId::Count, "one name per UniformId");
+    return names[(size_t)id];
+}
+
+// std140 uniform blocks shared by all programs (see SharedUniforms): a program declaring one gets it
+// bound to the binding point of the same number when it is linked
+enum class UniformBlock
+{
+    Frame,
+    Light,
+    Count
+};
+
+inline const char *uniformBlockName(UniformBlock block)
+{
+    static const char *const names[] = {"Frame", "Light"};
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)UniformBlock::Count, "one name per UniformBlock");
+    return names[(size_t)block];
+}
+
+class Shader
+{
+public:
+    unsigned int ID;
+    // one active uniform of the linked program (glGetActiveUniform)
+    struct UniformInfo
+    {
+        std::string name; // arrays without the "[0]"
+        GLint location;   // -1 for uniform block members (set through the block's buffer)
+        GLenum type;
+        GLint size;       // array length, 1 otherwise
+    };
+    // uniforms looked up by name (the string setters, location(name)) since startup; the render
+    // loop is expected to leave it alone
+    static inline unsigned long long stringLookups = 0;
+    // constructor generates the shader on the fly
+    // ------------------------------------------------------------------------
+    Shader(const char *vertexPath, const char *fragmentPath)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath)
+    {
+        unsigned int vertex, fragment;
+        ID = build(vertex, fragment);
+        checkCompileErrors(vertex, "VERTEX");
+        checkCompileErrors(fragment, "FRAGMENT");
+        checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        reflect();
+    }
+    // hot reload
+    // ------------------------------------------------------------------------
+    bool uses(const std::string &path) const
+    {
+        return path == vertexPath || path == fragmentPath;
+    }
+    // compile and link the files again into a new program; nothing waits for the driver here
+    void beginReload()
+    {
+        discardReload();
+        pendingID = build(pendingVertex, pendingFragment);
+    }
+    // next frame boundary: swap the new program in if it linked, keep the old one otherwise.
+    // true if ID changed (copies of it must be refreshed)
+    bool finishReload()
+    {
+        if (!pendingID)
+            return false;
+        GLint linked = 0;
+        glGetProgramiv(pendingID, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            std::cout << "Shader: " << vertexPath << " + " << fragmentPath
+                      << " failed to rebuild, keeping the previous program" << std::endl;
+            checkCompileErrors(pendingVertex, "VERTEX");
+            checkCompileErrors(pendingFragment, "FRAGMENT");
+            checkCompileErrors(pendingID, "PROGRAM");
+            discardReload();
+            return false;
+        }
+        glDeleteProgram(ID);
+        ID = pendingID;
+        pendingID = 0;
+        discardReload();
+        reflect();
+        std::cout << "Shader: reloaded " << vertexPath << " + " << fragmentPath << std::endl;
+        return true;
+    }
+    // activate the shader
+    // ------------------------------------------------------------------------
+    void use() const
+    {
+        glUseProgram(ID);
+    }
+    // uniform table
+    // ------------------------------------------------------------------------
+    const std::vector<UniformInfo> &uniforms() const
+    {
+        return table;
+    }
+    // pre-resolved: -1 if the program does not use the uniform (glUniform* ignores -1)
+    GLint location(UniformId id) const
+    {
+        return resolved[(size_t)id];
+    }
+    // through the reflected table by name, without asking the driver
+    GLint location(const std::string &name) const
+    {
+        stringLookups++;
+        return find(name);
+    }
+    // utility uniform functions
+    // ------------------------------------------------------------------------
+    void setBool(const std::string &name, bool value) const
+    {
+        glUniform1i(location(name), (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(const std::string &name, int value) const
+    {
+        glUniform1i(location(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(const std::string &name, float value) const
+    {
+        glUniform1f(location(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec2(const std::string &name, const glm::vec2 &value) const
+    {
+        glUniform2fv(location(name), 1, &value[0]);
+    }
+    void setVec2(const std::string &name, float x, float y) const
+    {
+        glUniform2f(location(name), x, y);
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string &name, const glm::vec3 &value) const
+    {
+        glUniform3fv(location(name), 1, &value[0]);
+    }
+    void setVec3(const std::string &name, float x, float y, float z) const
+    {
+        glUniform3f(location(name), x, y, z);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(const std::string &name, const glm::vec4 &value) const
+    {
+        glUniform4fv(location(name), 1, &value[0]);
+    }
+    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    {
+        glUniform4f(location(name), x, y, z, w);
+    }
+    // ------------------------------------------------------------------------
+    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    {
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    // ------------------------------------------------------------------------
+    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    {
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    {
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    // the same through pre-resolved handles
+    // ------------------------------------------------------------------------
+    void setInt(UniformId id, int value) const
+    {
+        glUniform1i(location(id), value);
+    }
+    void setFloat(UniformId id, float value) const
+    {
+        glUniform1f(location(id), value);
+    }
+    void setVec3(UniformId id, const glm::vec3 &value) const
+    {
+        glUniform3fv(location(id), 1, &value[0]);
+    }
+    void setVec3(UniformId id, float x, float y, float z) const
+    {
+        glUniform3f(location(id), x, y, z);
+    }
+    void setMat3(UniformId id, const glm::mat3 &mat) const
+    {
+        glUniformMatrix3fv(location(id), 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(UniformId id, const glm::mat4 &mat) const
+    {
+        glUniformMatrix4fv(location(id), 1, GL_FALSE, &mat[0][0]);
+    }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    // beginReload() result waiting for finishReload()
+    unsigned int pendingID = 0;
+    unsigned int pendingVertex = 0;
+    unsigned int pendingFragment = 0;
+    // reflection of ID, rebuilt whenever it is (re)linked
+    std::vector<UniformInfo> table;
+    std::unordered_map<std::string, size_t> byName; // name -> table index
+    std::array<GLint, (size_t)UniformId::Count> resolved;
+
+    GLint find(const std::string &name) const
+    {
+        auto it = byName.find(name);
+        return it != byName.end() ? table[it->second].location : -1;
+    }
+    // enumerate the active uniforms of ID, resolve the UniformId handles and bind the shared blocks
+    void reflect()
+    {
+        table.clear();
+        byName.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> nameBuf(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            UniformInfo u;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuf.size(), &length, &u.size, &u.type, nameBuf.data());
+            u.name.assign(nameBuf.data(), length);
+            u.location = glGetUniformLocation(ID, u.name.c_str());
+            size_t bracket = u.name.find('['); // arrays are reported as "name[0]"
+            if (bracket != std::string::npos)
+                u.name.resize(bracket);
+            byName[u.name] = table.size();
+            table.push_back(u);
+        }
+        for (size_t i = 0; i < resolved.size(); ++i)
+            resolved[i] = find(uniformName((UniformId)i));
+        for (GLuint b = 0; b < (GLuint)UniformBlock::Count; ++b)
+        {
+            GLuint index = glGetUniformBlockIndex(ID, uniformBlockName((UniformBlock)b));
+            if (index != GL_INVALID_INDEX)
+                glUniformBlockBinding(ID, index, b);
+        }
+    }
+
+    // read the sources (from the asset pack or the files) and compile and link them, without
+    // checking the result
+    unsigned int build(unsigned int &vertex, unsigned int &fragment) const
+    {
+        // 1. retrieve the vertex/fragment source code from the asset pack (or filePath)
+        std::string vertexCode;
+        std::string fragmentCode;
+        AssetData vShaderFile;
+        AssetData fShaderFile;
+        if (ReadAsset(vertexPath, vShaderFile) && ReadAsset(fragmentPath, fShaderFile))
+        {
+            // convert file contents into string
+            vertexCode.assign((const char *)vShaderFile.Data(), vShaderFile.Size());
+            fragmentCode.assign((const char *)fShaderFile.Data(), fShaderFile.Size());
+        }
+        else
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: "
+                      << (vShaderFile.IsOpen() ? fragmentPath : vertexPath) << std::endl;
+        }
+        const char *vShaderCode = vertexCode.c_str();
+        const char *fShaderCode = fragmentCode.c_str();
+        // 2. compile shaders
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        // shader Program
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        return program;
+    }
+    void discardReload()
+    {
+        if (pendingID)
+            glDeleteProgram(pendingID);
+        if (pendingVertex)
+            glDeleteShader(pendingVertex);
+        if (pendingFragment)
+            glDeleteShader(pendingFragment);
+        pendingID = pendingVertex = pendingFragment = 0;
+    }
+    // utility function for checking shader compilation/linking errors.
+    // ------------------------------------------------------------------------
+    void checkCompileErrors(GLuint shader, std::string type)
+    {
+        GLint success;
+        GLchar infoLog[1024];
+        if (type != "PROGRAM")
+        {
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n"
+                          << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            }
+        }
+        else
+        {
+            glGetProgramiv(shader, GL_LINK_STATUS, &success);
+            if (!success)
+            {
+                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+                std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n"
+                          << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            }
+        }
+    }
+};
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+// src/SharedUniforms.cpp
+#include "SharedUniforms.h"
+#include <iostream>
+
+SharedUniforms &SharedUniforms::Instance()
+{
+    static SharedUniforms uniforms;
+    return uniforms;
+}
+
+bool SharedUniforms::InitGL()
+{
+    const size_t sizes[] = {sizeof(FrameBlock), sizeof(LightBlock)};
+    static_assert(sizeof(sizes) / sizeof(sizes[0]) == (size_t)UniformBlock::Count, "one size per UniformBlock");
+    glGenBuffers((GLsizei)UniformBlock::Count, buffers);
+    for (GLuint b = 0; b < (GLuint)UniformBlock::Count; ++b)
+    {
+        if (!buffers[b])
+        {
+            std::cerr << "SharedUniforms: cannot create the " << uniformBlockName((UniformBlock)b) << " buffer\n";
+            return false;
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, buffers[b]);
+        glBufferData(GL_UNIFORM_BUFFER, sizes[b], nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, b, buffers[b]);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+void SharedUniforms::Upload(UniformBlock block, const void *data, size_t size)
+{
+    GLuint buffer = buffers[(size_t)block];
+    if (!buffer)
+        return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    // orphan the old storage: last frame's draws may still be reading it
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SharedUniforms::SetFrame(const glm::mat4 &view, const glm::mat4 &proj, const glm::vec3 &viewPos, float time)
+{
+    frame.view = view;
+    frame.proj = proj;
+    frame.viewProj = proj * view;
+    frame.viewPos = viewPos;
+    frame.time = time;
+    Upload(UniformBlock::Frame, &frame, sizeof(frame));
+}
+
+void SharedUniforms::SetLight(const glm::mat4 &lightVP, const glm::vec3 &dir, const glm::vec3 &color, float intensity)
+{
+    light.lightVP = lightVP;
+    light.dir = dir;
+    light.intensity = intensity;
+    light.color = color;
+    Upload(UniformBlock::Light, &light, sizeof(light));
+}
+
+void SharedUniforms::Shutdown()
+{
+    glDeleteBuffers((GLsizei)UniformBlock::Count, buffers);
+    for (GLuint &b : buffers)
+        b = 0;
+}
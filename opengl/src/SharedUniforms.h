@@ -0,0 +1,62 @@
+// src/SharedUniforms.h
+#pragma once
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+// Per-frame data every program reads, mirrored field for field by the GLSL blocks
+//   layout(std140) uniform Frame { mat4 uView; mat4 uProj; mat4 uViewProj; vec3 uViewPos; float uTime; };
+//   layout(std140) uniform Light { mat4 uLightVP; vec3 uLightDir; float uLightIntensity; vec3 uLightColor; };
+// (a vec3 followed by a float shares one 16-byte slot in std140, so the C++ structs need no padding
+// beyond the last one).
+struct FrameBlock
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 viewProj;
+    glm::vec3 viewPos;
+    float time; // seconds since startup
+};
+
+struct LightBlock
+{
+    glm::mat4 lightVP;
+    glm::vec3 dir; // direction the light travels (the fragment shader negates it)
+    float intensity;
+    glm::vec3 color;
+    float pad;
+};
+
+static_assert(offsetof(FrameBlock, viewPos) == 192 && offsetof(FrameBlock, time) == 204 && sizeof(FrameBlock) == 208,
+              "FrameBlock must match the std140 layout of the Frame block");
+static_assert(offsetof(LightBlock, dir) == 64 && offsetof(LightBlock, intensity) == 76 &&
+                  offsetof(LightBlock, color) == 80 && sizeof(LightBlock) == 96,
+              "LightBlock must match the std140 layout of the Light block");
+
+// One uniform buffer per block, bound once at its UniformBlock binding point and shared by every
+// program (Shader binds the blocks it finds at link time). Each is written once per frame, so the
+// programs stay consistent and no per-program camera/light uniforms are uploaded. GL thread only.
+class SharedUniforms
+{
+public:
+    static SharedUniforms &Instance();
+
+    bool InitGL();
+    void SetFrame(const glm::mat4 &view, const glm::mat4 &proj, const glm::vec3 &viewPos, float time);
+    void SetLight(const glm::mat4 &lightVP, const glm::vec3 &dir, const glm::vec3 &color, float intensity);
+    const FrameBlock &Frame() const { return frame; }
+    const LightBlock &Light() const { return light; }
+    void Shutdown();
+
+private:
+    SharedUniforms() = default;
+    SharedUniforms(const SharedUniforms &) = delete;
+    SharedUniforms &operator=(const SharedUniforms &) = delete;
+
+    void Upload(UniformBlock block, const void *data, size_t size);
+
+    GLuint buffers[(size_t)UniformBlock::Count] = {};
+    FrameBlock frame{};
+    LightBlock light{};
+};
@@ -1,150 +1,448 @@
 // src/StaticModel.cpp
 #include "StaticModel.h"
+#include "AssetIndex.h"
+#include "AssetPack.h"
+#include "AssimpPackIO.h"
+#include "GeometryArena.h"
+#include "GltfLoader.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplify.h"
+#include "ObjLoader.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <string>
+#include <cstdio>
 #include <cstring>
-#include <functional>
-// stb_image single-file loader
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include <fstream>
 
 static glm::vec3 aiVec3ToGlm(const aiVector3D &v) { return glm::vec3(v.x, v.y, v.z); }
 static glm::vec2 aiVec2ToGlm(const aiVector3D &v) { return glm::vec2(v.x, v.y); }
+static glm::mat4 aiMatToGlm(const aiMatrix4x4 &m)
+{
+    return glm::mat4(
+        m.a1, m.b1, m.c1, m.d1,
+        m.a2, m.b2, m.c2, m.d2,
+        m.a3, m.b3, m.c3, m.d3,
+        m.a4, m.b4, m.c4, m.d4);
+}
 
 StaticModel::StaticModel() {}
 StaticModel::~StaticModel() { Cleanup(); }
 
-// compute axis-aligned bbox of all meshes attached to node in node-local coordinates
-void StaticModel::ComputeMeshAABBForNode(const aiNode *node, glm::vec3 &outMin, glm::vec3 &outMax) const
+// Compute pivots for nodes that have geometry from the bbox of their meshes (node-local space:
+// mesh vertices are already in mesh-local / node-local space after Assimp import).
+void StaticModel::ComputeNodePivots(MeshCacheData &data)
 {
-    // initialize
-    outMin = glm::vec3(std::numeric_limits<float>::infinity());
-    outMax = glm::vec3(-std::numeric_limits<float>::infinity());
+    for (auto &nd : data.nodes)
+    {
+        glm::vec3 mn(std::numeric_limits<float>::infinity());
+        glm::vec3 mx(-std::numeric_limits<float>::infinity());
+        for (uint32_t k = 0; k < nd.meshCount; ++k)
+        {
+            const MeshCacheMesh &mesh = data.meshes[data.nodeMeshes[nd.firstMesh + k]];
+            for (uint32_t v = 0; v < mesh.vertexCount; ++v)
+            {
+                mn = glm::min(mn, mesh.vertices[v].pos);
+                mx = glm::max(mx, mesh.vertices[v].pos);
+            }
+        }
 
-    if (!scene)
-        return;
+        nd.pivot = glm::vec3(0.0f);
+        if (mn.x <= mx.x) // valid bbox
+        {
+            // choose pivot: use top edge (max.y) and center x/z to rotate legs around top of mesh
+            glm::vec3 localCenter = (mn + mx) * 0.5f;
+            nd.pivot = glm::vec3(localCenter.x, mx.y, localCenter.z);
+        }
+    }
+}
 
-    for (unsigned int mi = 0; mi < node->mNumMeshes; ++mi)
+// Model-space bbox of every mesh placed by its node transform (without animation)
+void StaticModel::ComputeBBox(MeshCacheData &data)
+{
+    data.bboxInitialized = false;
+    std::vector<glm::mat4> world(data.nodes.size());
+    for (size_t i = 0; i < data.nodes.size(); ++i)
     {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[mi]];
-        if (!mesh || mesh->mNumVertices == 0)
-            continue;
-        for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+        const ModelNode &nd = data.nodes[i];
+        world[i] = nd.parent < 0 ? nd.transform : world[nd.parent] * nd.transform;
+
+        // 遍历该 node 挂载的 mesh
+        for (uint32_t k = 0; k < nd.meshCount; ++k)
         {
-            aiVector3D av = mesh->mVertices[v];
-            glm::vec3 p(av.x, av.y, av.z); // mesh vertices are already in mesh-local / node-local space after Assimp import
-            outMin = glm::min(outMin, p);
-            outMax = glm::max(outMax, p);
+            const MeshCacheMesh &mesh = data.meshes[data.nodeMeshes[nd.firstMesh + k]];
+            for (uint32_t v = 0; v < mesh.vertexCount; ++v)
+            {
+                glm::vec3 wp(world[i] * glm::vec4(mesh.vertices[v].pos, 1.0f));
+                if (!data.bboxInitialized)
+                {
+                    data.bboxMin = data.bboxMax = wp;
+                    data.bboxInitialized = true;
+                }
+                else
+                {
+                    data.bboxMin = glm::min(data.bboxMin, wp);
+                    data.bboxMax = glm::max(data.bboxMax, wp);
+                }
+            }
         }
     }
-    // If node had no meshes, outMin/outMax will be +/-inf
 }
 
-// Walk scene nodes and compute pivots for nodes that have geometry.
-void StaticModel::ComputeNodePivots()
+void StaticModel::Cleanup()
 {
-    if (!scene)
-        return;
+    for (auto &m : meshes)
+    {
+        if (arena)
+            arena->Free(m.geometry);
+        // textures are shared between models, drop our reference only
+        TextureCache::Instance().Release(m.diffuseTex);
+    }
+    meshes.clear();
+    arena = nullptr;
+}
+
+// Import flags are part of the mesh cache key: changing them invalidates baked files.
+static const unsigned int kImportFlags = aiProcess_Triangulate |
+                                         aiProcess_GenSmoothNormals |
+                                         aiProcess_FlipUVs |
+                                         aiProcess_CalcTangentSpace |
+                                         aiProcess_JoinIdenticalVertices |
+                                         aiProcess_OptimizeMeshes;
+// cache key of meshes produced by ObjLoader, which emulates the flags above
+static const uint32_t kObjImportKey = 0x4F424A01; // "OBJ" v1
+
+static bool IsObjPath(const std::string &path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string ext = path.substr(dot + 1);
+    for (auto &c : ext)
+        c = tolower(c);
+    return ext == "obj";
+}
+
+static bool IsGltfPath(const std::string &path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string ext = path.substr(dot + 1);
+    for (auto &c : ext)
+        c = tolower(c);
+    return ext == "gltf" || ext == "glb";
+}
 
-    // recursive lambda
-    std::function<void(const aiNode *)> recur = [&](const aiNode *nd)
+// TextureCache name of an image stored inside a glTF buffer
+static std::string EmbeddedImageName(const std::string &modelPath, int image)
+{
+    return modelPath + "#image" + std::to_string(image);
+}
+
+static bool FileExists(const std::string &path)
+{
+    if (AssetPack::Instance().Contains(path))
+        return true;
+    std::ifstream f(path, std::ios::binary);
+    return f.good();
+}
+
+// Flatten the aiNode tree depth-first, so parents always precede their children
+static void AppendNode(const aiNode *nd, int32_t parent, MeshCacheData &data,
+                       std::unordered_map<std::string, uint32_t> &nameIds)
+{
+    int32_t idx = (int32_t)data.nodes.size();
+    ModelNode out;
+    out.parent = parent;
+    out.transform = aiMatToGlm(nd->mTransformation);
+    out.firstMesh = (uint32_t)data.nodeMeshes.size();
+    out.meshCount = nd->mNumMeshes;
+    data.nodeMeshes.insert(data.nodeMeshes.end(), nd->mMeshes, nd->mMeshes + nd->mNumMeshes);
+    auto name = nameIds.emplace(nd->mName.C_Str(), (uint32_t)data.nodeNames.size());
+    if (name.second)
+        data.nodeNames.push_back(name.first->first);
+    out.nameId = name.first->second;
+    data.nodes.push_back(out);
+
+    for (unsigned int c = 0; c < nd->mNumChildren; ++c)
+        AppendNode(nd->mChildren[c], idx, data, nameIds);
+}
+
+// Map a texture path from the material to a file on disk (does not load it)
+std::string StaticModel::ResolveTexturePath(const std::string &texFile, const std::string &directory, bool &found)
+{
+    std::string full = texFile;
+    found = false;
+
+    // Check if it's an absolute path (works on both Windows and Unix/Mac)
+    // Unix/Mac absolute path: starts with / (check this first, works on all platforms)
+    // Windows absolute path: C:\ or D:\ etc. (or C:/ or D:/)
+    bool isAbsolute = false;
+    if (!texFile.empty())
     {
-        glm::vec3 mn, mx;
-        // initialize to inf so ComputeMeshAABBForNode will change them if meshes exist
-        mn = glm::vec3(std::numeric_limits<float>::infinity());
-        mx = glm::vec3(-std::numeric_limits<float>::infinity());
+        // Unix/Mac absolute path: starts with /
+        if (texFile[0] == '/')
+            isAbsolute = true;
+// Windows absolute path: C:\ or D:\ etc.
+#ifdef _WIN32
+        else if (texFile.length() >= 3 && texFile[1] == ':' && (texFile[2] == '\\' || texFile[2] == '/'))
+            isAbsolute = true;
+#endif
+    }
 
-        // Compute bbox for this node's meshes (if any)
-        ComputeMeshAABBForNode(nd, mn, mx);
+    // With the startup index this is one lookup and no file is opened: the exact relative path,
+    // otherwise any indexed file of the same name (nearest to the model directory first).
+    const AssetIndex &index = AssetIndex::Instance();
+    if (index.IsBuilt())
+    {
+        const AssetIndex::Entry *e = isAbsolute ? nullptr : index.FindPath(directory + "/" + texFile);
+        if (!e)
+            e = index.FindName(texFile, directory);
+        found = e != nullptr;
+        if (found)
+            return e->path;
+    }
 
-        if (mn.x <= mx.x) // valid bbox
+    if (!isAbsolute)
+    {
+        // Relative path: make absolute relative to model directory
+        full = directory + "/" + texFile;
+        if (!index.IsBuilt())
+            found = FileExists(full);
+        return full;
+    }
+
+    // Extract filename from absolute path
+    size_t lastSlash = texFile.find_last_of("/\\");
+    std::string filename = (lastSlash == std::string::npos) ? texFile : texFile.substr(lastSlash + 1);
+    if (index.IsBuilt())
+        return directory + "/" + filename; // not on disk anywhere we know of, keep a readable path
+
+    // Helper function to normalize path separators
+    auto normalizePath = [](const std::string &path) -> std::string
+    {
+        std::string result = path;
+#ifdef _WIN32
+        // On Windows, replace / with \ for consistency
+        for (size_t i = 0; i < result.length(); ++i)
         {
-            // choose pivot: use top edge (max.y) and center x/z to rotate legs around top of mesh
-            glm::vec3 localCenter = (mn + mx) * 0.5f;
-            glm::vec3 pivot = glm::vec3(localCenter.x, mx.y, localCenter.z);
-            std::string nm(nd->mName.C_Str());
-            nodePivots[nm] = pivot;
-            // debug:
-            // std::cout << "Pivot for node '"<<nm<<"' = ("<<pivot.x<<","<<pivot.y<<","<<pivot.z<<")\n";
+            if (result[i] == '/')
+                result[i] = '\\';
         }
-        // recurse children
-        for (unsigned int i = 0; i < nd->mNumChildren; ++i)
-            recur(nd->mChildren[i]);
+#else
+        // On Unix/Mac, replace \ with / for consistency
+        for (size_t i = 0; i < result.length(); ++i)
+        {
+            if (result[i] == '\\')
+                result[i] = '/';
+        }
+#endif
+        return result;
     };
 
-    recur(scene->mRootNode);
+// Try to find texture in multiple locations
+// 1. First try in model directory (same directory as .obj file)
+#ifdef _WIN32
+    full = directory + "\\" + filename;
+#else
+    full = directory + "/" + filename;
+#endif
+    full = normalizePath(full);
+    if (FileExists(full))
+    {
+        found = true;
+        return full;
+    }
+
+    // 2. If not found, try in blender directory (common case)
+    // Find project root by looking for "opengl" in directory path
+    size_t openglPos = directory.find("opengl");
+    if (openglPos != std::string::npos)
+    {
+        std::string projectRoot = directory.substr(0, openglPos);
+#ifdef _WIN32
+        full = projectRoot + "blender\\textures\\" + filename;
+#else
+        full = projectRoot + "blender/textures/" + filename;
+#endif
+        full = normalizePath(full);
+        if (FileExists(full))
+        {
+            found = true;
+            return full;
+        }
+    }
+
+    // 3. Try in assets/models directory
+    size_t assetsPos = directory.find("assets");
+    if (assetsPos != std::string::npos)
+    {
+        std::string baseDir = directory.substr(0, assetsPos);
+#ifdef _WIN32
+        full = baseDir + "assets\\models\\" + filename;
+#else
+        full = baseDir + "assets/models/" + filename;
+#endif
+        full = normalizePath(full);
+        found = FileExists(full);
+    }
+    // last candidate is returned even if missing so the upload reports a useful path
+    return full;
 }
 
-void StaticModel::Cleanup()
+// Run the load-time mesh optimizer and log what it bought
+static void OptimizeAndReport(const std::string &path, size_t m, std::vector<SimpleVertex> &mv,
+                              std::vector<unsigned int> &mi)
 {
-    for (auto &m : meshes)
+    size_t vertsBefore = mv.size();
+    MeshOptimizeStats opt = OptimizeMesh(mv, mi);
+    size_t bytesBefore = mi.size() * sizeof(unsigned int) + vertsBefore * sizeof(SimpleVertex);
+    size_t bytesAfter = mi.size() * (mv.size() <= 65536 ? sizeof(uint16_t) : sizeof(unsigned int)) +
+                        mv.size() * sizeof(SimpleVertex);
+    char line[256];
+    snprintf(line, sizeof(line), "StaticModel: %s mesh %zu: ACMR %.3f -> %.3f, %zu clusters%s, %zu -> %zu bytes",
+             path.substr(path.find_last_of("/\\") + 1).c_str(), m, opt.acmrBefore, opt.acmrAfter, opt.clusters,
+             opt.overdrawOrder ? " (overdraw order)" : "", bytesBefore, bytesAfter);
+    std::cout << line << std::endl;
+}
+
+// meshes below this many triangles are drawn in full at any distance
+static const size_t kMinLodTriangles = 64;
+// a level must drop at least this share of the previous level's triangles to be kept
+static const float kLodMinReduction = 0.2f;
+// largest collapse error a level may reach, relative to the mesh's bounding box diagonal
+static const float kLodMaxError = 0.05f;
+// level switches wait until the projected error is this far past the tolerance
+static const float kLodHysteresis = 0.25f;
+
+// Simplified levels for distance rendering, appended to mi behind the full mesh. Each level is
+// simplified from the previous one to half its triangles; the chain ends early once a level stops
+// paying for itself (locked seams and borders, or the error limit).
+static void BuildLods(const std::string &path, size_t m, const std::vector<SimpleVertex> &mv,
+                      std::vector<unsigned int> &mi, MeshCacheMesh &dst)
+{
+    dst.lodCount = 1;
+    dst.lods[0].firstIndex = 0;
+    dst.lods[0].indexCount = (uint32_t)mi.size();
+    dst.lods[0].error = 0.0f;
+    if (mi.size() < kMinLodTriangles * 3)
+        return;
+
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (const auto &v : mv)
     {
-        if (m.ebo)
-            glDeleteBuffers(1, &m.ebo);
-        if (m.vbo)
-            glDeleteBuffers(1, &m.vbo);
-        if (m.vao)
-            glDeleteVertexArrays(1, &m.vao);
-        if (m.diffuseTex)
-            glDeleteTextures(1, &m.diffuseTex);
+        lo = glm::min(lo, v.pos);
+        hi = glm::max(hi, v.pos);
     }
-    meshes.clear();
+    float maxError = glm::length(hi - lo) * kLodMaxError;
+
+    std::vector<unsigned int> previous(mi), level;
+    char counts[96];
+    int written = snprintf(counts, sizeof(counts), "%zu", mi.size() / 3);
+    while (dst.lodCount < kMaxMeshLods && previous.size() >= kMinLodTriangles * 3)
+    {
+        float error = SimplifyMesh(mv, previous, previous.size() / 6 * 3, maxError, level);
+        if ((float)level.size() > (float)previous.size() * (1.0f - kLodMinReduction))
+            break;
+        OptimizeVertexCache(level, mv.size());
+        const MeshLod &finer = dst.lods[dst.lodCount - 1];
+        MeshLod &lod = dst.lods[dst.lodCount++];
+        lod.firstIndex = (uint32_t)mi.size();
+        lod.indexCount = (uint32_t)level.size();
+        lod.error = finer.error + error; // simplified from the finer level, so the errors add up
+        mi.insert(mi.end(), level.begin(), level.end());
+        if (written > 0 && (size_t)written < sizeof(counts))
+            written += snprintf(counts + written, sizeof(counts) - written, " / %zu", level.size() / 3);
+        previous.swap(level);
+    }
+
+    char line[256];
+    snprintf(line, sizeof(line), "StaticModel: %s mesh %zu: %u LODs, triangles %s, error %.4f",
+             path.substr(path.find_last_of("/\\") + 1).c_str(), m, dst.lodCount, counts,
+             dst.lods[dst.lodCount - 1].error);
+    std::cout << line << std::endl;
 }
 
-GLuint StaticModel::LoadTextureFromFile(const std::string &filename, bool &outHasAlpha, bool silent)
+// Texture coordinate units per mesh space unit, averaged by area over the triangles: the square
+// root of the UV area over the surface area. Degenerate UVs give 0.
+template <typename Index>
+static float UvDensity(const SimpleVertex *v, const Index *indices, size_t count)
 {
-    outHasAlpha = false;
-    int w, h, n;
-    stbi_uc *data = stbi_load(filename.c_str(), &w, &h, &n, 4); // force 4 channels (RGBA)
-    if (!data)
+    double uvArea = 0.0, area = 0.0;
+    for (size_t i = 0; i + 2 < count; i += 3)
     {
-        if (!silent)
-            std::cerr << "stb_image failed to load: " << filename << " reason: " << stbi_failure_reason() << "\n";
-        return 0;
+        const SimpleVertex &a = v[indices[i]], &b = v[indices[i + 1]], &c = v[indices[i + 2]];
+        area += glm::length(glm::cross(b.pos - a.pos, c.pos - a.pos));
+        glm::vec2 e0 = b.uv - a.uv, e1 = c.uv - a.uv;
+        uvArea += std::abs(e0.x * e1.y - e0.y * e1.x);
     }
-    // if original channels < 4, n may be < 4; but we forced load to 4 -> check alpha content
-    outHasAlpha = false;
-    for (int i = 0; i < w * h; ++i)
+    return area > 0.0 ? (float)std::sqrt(uvArea / area) : 0.0f;
+}
+
+void StaticModel::ApplyMaterial(MeshCacheMesh &dst, const std::string &materialName, const std::string &texFile,
+                                float opacity, const std::string &directory)
+{
+    bool texFound = false;
+    if (!texFile.empty())
     {
-        if (data[i * 4 + 3] < 250)
+        // Skip embedded textures (GLB files use *0, *1, etc. as placeholders)
+        if (texFile[0] == '*')
         {
-            outHasAlpha = true;
-            break;
-        } // loose test
+            std::cout << "StaticModel: skipping embedded texture placeholder: " << texFile << "\n";
+        }
+        else
+        {
+            dst.diffusePath = ResolveTexturePath(texFile, directory, texFound);
+        }
     }
 
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // wrap repeat default
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return tex;
+    // opacity or transparency detection
+    if (opacity < 0.999f)
+        dst.hasAlpha = true;
+
+    // heuristic: if material name or texture filename contains "hair" or "fur", mark as hair
+    std::string name = materialName;
+    for (auto &c : name)
+        c = tolower(c);
+    if (name.find("hair") != std::string::npos || name.find("fur") != std::string::npos)
+    {
+        dst.isHair = true;
+        dst.alphaCutoff = 0.4f;
+    }
+    if (!dst.isHair && texFound)
+    {
+        // also check texture filename
+        std::string t = texFile;
+        for (auto &c : t)
+            c = tolower(c);
+        if (t.find("hair") != std::string::npos || t.find("fur") != std::string::npos)
+        {
+            dst.isHair = true;
+            dst.alphaCutoff = 0.4f;
+        }
+    }
 }
 
-bool StaticModel::LoadFromFile(const std::string &path)
+bool StaticModel::ImportWithAssimp(const std::string &path, const std::string &directory, MeshCacheData &data,
+                                   std::vector<std::vector<SimpleVertex>> &verts,
+                                   std::vector<std::vector<unsigned int>> &inds)
 {
-    Cleanup();
-
-    scene = importer.ReadFile(path,
-                              aiProcess_Triangulate |
-                                  aiProcess_GenSmoothNormals |
-                                  aiProcess_FlipUVs |
-                                  aiProcess_CalcTangentSpace |
-                                  aiProcess_JoinIdenticalVertices |
-                                  aiProcess_OptimizeMeshes);
+    // the importer (and its copy of the whole scene) only lives for this function
+    Assimp::Importer importer;
+    importer.SetIOHandler(new AssimpPackIO()); // the importer owns and deletes it
+    const aiScene *scene = importer.ReadFile(path, kImportFlags);
 
     if (!scene || !scene->HasMeshes())
     {
@@ -152,73 +450,46 @@ bool StaticModel::LoadFromFile(const std::string &path)
         return false;
     }
 
-    // directory for relative texture paths
-    size_t p = path.find_last_of("/\\");
-    directory = (p == std::string::npos) ? "." : path.substr(0, p);
-
     // For each mesh, collect vertex/index data and material
-    meshes.resize(scene->mNumMeshes);
+    data.meshes.resize(scene->mNumMeshes);
+    verts.resize(scene->mNumMeshes);
+    inds.resize(scene->mNumMeshes);
 
     for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
     {
         aiMesh *mesh = scene->mMeshes[m];
-        std::vector<SimpleVertex> verts;
-        std::vector<unsigned int> inds;
-        verts.resize(mesh->mNumVertices);
+        std::vector<SimpleVertex> &mv = verts[m];
+        std::vector<unsigned int> &mi = inds[m];
+        mv.resize(mesh->mNumVertices);
         for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
         {
-            verts[i].pos = aiVec3ToGlm(mesh->mVertices[i]);
-            verts[i].normal = mesh->HasNormals() ? aiVec3ToGlm(mesh->mNormals[i]) : glm::vec3(0, 1, 0);
+            mv[i].pos = aiVec3ToGlm(mesh->mVertices[i]);
+            mv[i].normal = mesh->HasNormals() ? aiVec3ToGlm(mesh->mNormals[i]) : glm::vec3(0, 1, 0);
             if (mesh->mTextureCoords[0])
-            {
-                // std::cerr << "Debug: mesh->mTextureCoords[0] exists." << std::endl;
-                verts[i].uv = aiVec2ToGlm(mesh->mTextureCoords[0][i]);
-            }
-
+                mv[i].uv = aiVec2ToGlm(mesh->mTextureCoords[0][i]);
             else
-                verts[i].uv = glm::vec2(0.0f, 0.0f);
+                mv[i].uv = glm::vec2(0.0f, 0.0f);
         }
         for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
         {
             const aiFace &face = mesh->mFaces[f];
             if (face.mNumIndices != 3)
                 continue;
-            inds.push_back(face.mIndices[0]);
-            inds.push_back(face.mIndices[1]);
-            inds.push_back(face.mIndices[2]);
+            mi.push_back(face.mIndices[0]);
+            mi.push_back(face.mIndices[1]);
+            mi.push_back(face.mIndices[2]);
         }
 
-        // create GL buffers
-        MeshRenderData &dst = meshes[m];
-        dst.indexCount = static_cast<GLsizei>(inds.size());
-
-        glGenVertexArrays(1, &dst.vao);
-        glGenBuffers(1, &dst.vbo);
-        glGenBuffers(1, &dst.ebo);
-
-        glBindVertexArray(dst.vao);
-        glBindBuffer(GL_ARRAY_BUFFER, dst.vbo);
-        glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(SimpleVertex), verts.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dst.ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, inds.size() * sizeof(unsigned int), inds.data(), GL_STATIC_DRAW);
-
-        // attribs: location 0 = pos, 1 = normal, 2 = uv
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SimpleVertex), (void *)offsetof(SimpleVertex, pos));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SimpleVertex), (void *)offsetof(SimpleVertex, normal));
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SimpleVertex), (void *)offsetof(SimpleVertex, uv));
-
-        glBindVertexArray(0);
+        // reorder once here; the result is what gets baked into the mesh cache
+        OptimizeAndReport(path, m, mv, mi);
 
-        // material handling
-        dst.hasDiffuse = false;
-        dst.hasAlpha = false;
-        dst.isHair = false;
-        dst.diffuseTex = 0;
-        dst.diffuseColor = glm::vec3(1.0f);
+        MeshCacheMesh &dst = data.meshes[m];
+        BuildLods(path, m, mv, mi, dst);
+        dst.uvDensity = UvDensity(mv.data(), mi.data(), dst.lods[0].indexCount);
+        dst.vertices = mv.data();
+        dst.vertexCount = (uint32_t)mv.size();
+        dst.indices = mi.data();
+        dst.indexCount = (uint32_t)mi.size();
 
         if (scene->mNumMaterials > 0 && mesh->mMaterialIndex < scene->mNumMaterials)
         {
@@ -231,517 +502,670 @@ bool StaticModel::LoadFromFile(const std::string &path)
                 dst.diffuseColor = glm::vec3(col.r, col.g, col.b);
             }
             // diffuse texture
+            std::string texFile;
             if (mat->GetTextureCount(aiTextureType_DIFFUSE) > 0)
             {
                 aiString texPath;
                 mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath);
-                // std::cout << "StaticModel: found diffuse texture path: " << texPath.C_Str() << "\n";
-                std::string texFile = texPath.C_Str();
-
-                // Skip embedded textures (GLB files use *0, *1, etc. as placeholders)
-                if (texFile.empty() || texFile[0] == '*')
-                {
-                    std::cout << "StaticModel: skipping embedded texture placeholder: " << texFile << "\n";
-                }
-                else
-                {
-                    std::string full = texFile;
-
-                    // Check if it's an absolute path (works on both Windows and Unix/Mac)
-                    // Unix/Mac absolute path: starts with / (check this first, works on all platforms)
-                    // Windows absolute path: C:\ or D:\ etc. (or C:/ or D:/)
-                    bool isAbsolute = false;
-                    if (!texFile.empty())
-                    {
-                        // Unix/Mac absolute path: starts with /
-                        if (texFile[0] == '/')
-                            isAbsolute = true;
-// Windows absolute path: C:\ or D:\ etc.
-#ifdef _WIN32
-                        else if (texFile.length() >= 3 && texFile[1] == ':' && (texFile[2] == '\\' || texFile[2] == '/'))
-                            isAbsolute = true;
-#endif
-                    }
-
-                    if (isAbsolute)
-                    {
-                        // Extract filename from absolute path
-                        size_t lastSlash = texFile.find_last_of("/\\");
-                        std::string filename = (lastSlash == std::string::npos) ? texFile : texFile.substr(lastSlash + 1);
-
-                        // Helper function to normalize path separators
-                        auto normalizePath = [](const std::string &path) -> std::string
-                        {
-                            std::string result = path;
-#ifdef _WIN32
-                            // On Windows, replace / with \ for consistency
-                            for (size_t i = 0; i < result.length(); ++i)
-                            {
-                                if (result[i] == '/')
-                                    result[i] = '\\';
-                            }
-#else
-                            // On Unix/Mac, replace \ with / for consistency
-                            for (size_t i = 0; i < result.length(); ++i)
-                            {
-                                if (result[i] == '\\')
-                                    result[i] = '/';
-                            }
-#endif
-                            return result;
-                        };
-
-// Try to find texture in multiple locations
-// 1. First try in model directory (same directory as .obj file)
-#ifdef _WIN32
-                        full = directory + "\\" + filename;
-#else
-                        full = directory + "/" + filename;
-#endif
-                        full = normalizePath(full);
-                        dst.diffuseTex = LoadTextureFromFile(full, dst.hasAlpha, true); // silent for first attempt
-
-                        if (!dst.diffuseTex)
-                        {
-                            // 2. If not found, try in blender directory (common case)
-                            // Find project root by looking for "opengl" in directory path
-                            size_t openglPos = directory.find("opengl");
-                            if (openglPos != std::string::npos)
-                            {
-                                std::string projectRoot = directory.substr(0, openglPos);
-#ifdef _WIN32
-                                full = projectRoot + "blender\\textures\\" + filename;
-#else
-                                full = projectRoot + "blender/textures/" + filename;
-#endif
-                                full = normalizePath(full);
-                                dst.diffuseTex = LoadTextureFromFile(full, dst.hasAlpha, false); // show errors for final attempt
-                            }
-
-                            if (!dst.diffuseTex)
-                            {
-                                // 3. Try in assets/models directory
-                                size_t assetsPos = directory.find("assets");
-                                if (assetsPos != std::string::npos)
-                                {
-                                    std::string baseDir = directory.substr(0, assetsPos);
-#ifdef _WIN32
-                                    full = baseDir + "assets\\models\\" + filename;
-#else
-                                    full = baseDir + "assets/models/" + filename;
-#endif
-                                    full = normalizePath(full);
-                                    dst.diffuseTex = LoadTextureFromFile(full, dst.hasAlpha, false); // show errors for final attempt
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // Relative path: make absolute relative to model directory
-                        if (texFile.find_first_of("/\\") == std::string::npos)
-                            full = directory + "/" + texFile;
-                        else
-                            full = directory + "/" + texFile;
-                        dst.diffuseTex = LoadTextureFromFile(full, dst.hasAlpha, false);
-                    }
-
-                    if (dst.diffuseTex)
-                    {
-                        // std::cout << "StaticModel: loaded diffuse texture " << full << "\n";
-                        dst.hasDiffuse = true;
-                    }
-                    else
-                    {
-                        std::cerr << "StaticModel: failed to load diffuse texture " << full << "\n";
-                    }
-                }
+                texFile = texPath.C_Str();
             }
-
-            // opacity or transparency detection
             float opacity = 1.0f;
-            if (AI_SUCCESS == aiGetMaterialFloat(mat, AI_MATKEY_OPACITY, &opacity))
-            {
-                if (opacity < 0.999f)
-                    dst.hasAlpha = true;
-            }
-
-            // heuristic: if material name or texture filename contains "hair" or "fur", mark as hair
+            aiGetMaterialFloat(mat, AI_MATKEY_OPACITY, &opacity);
             aiString matName;
-            if (AI_SUCCESS == mat->Get(AI_MATKEY_NAME, matName))
-            {
-                std::string name = matName.C_Str();
-                for (auto &c : name)
-                    c = tolower(c);
-                if (name.find("hair") != std::string::npos || name.find("fur") != std::string::npos)
-                {
-                    dst.isHair = true;
-                    dst.alphaCutoff = 0.4f;
-                }
-            }
-            if (!dst.isHair && dst.hasDiffuse)
-            {
-                // also check texture filename
-                std::string t = "";
-                if (mat->GetTextureCount(aiTextureType_DIFFUSE) > 0)
-                {
-                    aiString tpath;
-                    mat->GetTexture(aiTextureType_DIFFUSE, 0, &tpath);
-                    t = tpath.C_Str();
-                    for (auto &c : t)
-                        c = tolower(c);
-                    if (t.find("hair") != std::string::npos || t.find("fur") != std::string::npos)
-                    {
-                        dst.isHair = true;
-                        dst.alphaCutoff = 0.4f;
-                    }
-                }
-            }
+            mat->Get(AI_MATKEY_NAME, matName);
+            ApplyMaterial(dst, matName.C_Str(), texFile, opacity, directory);
         }
     }
-    // After assimp import:
-    // this->scene = scene; // however you store it
-    nodePivots.clear();
-    ComputeNodePivots();
 
-    bboxInitialized = false;
-    ComputeBBoxRecursive(scene->mRootNode, scene, glm::mat4(1.0f));
-    // std::cout << "StaticModel: loaded meshes=" << meshes.size() << " from " << path << std::endl;
+    data.nodes.clear();
+    data.nodeMeshes.clear();
+    data.nodeNames.clear();
+    std::unordered_map<std::string, uint32_t> nameIds;
+    AppendNode(scene->mRootNode, -1, data, nameIds);
+
+    ComputeNodePivots(data);
+    ComputeBBox(data);
     return true;
 }
 
-void StaticModel::Draw(GLuint shaderProgram) const
+bool StaticModel::ImportObj(const std::string &path, const std::string &directory, MeshCacheData &data,
+                            std::vector<std::vector<SimpleVertex>> &verts,
+                            std::vector<std::vector<unsigned int>> &inds)
 {
-    // we assume shaderProgram is already in use, and uniforms uHasDiffuse, uHasAlpha, uUseAlphaTest,
-    // uAlphaCutoff, uMatDiffuse and sampler2D uDiffuseMap exist.
-    GLint locHasDiffuse = glGetUniformLocation(shaderProgram, "uHasDiffuse");
-    GLint locHasAlpha = glGetUniformLocation(shaderProgram, "uHasAlpha");
-    GLint locUseAlphaTest = glGetUniformLocation(shaderProgram, "uUseAlphaTest");
-    GLint locAlphaCutoff = glGetUniformLocation(shaderProgram, "uAlphaCutoff");
-    GLint locMatDiffuse = glGetUniformLocation(shaderProgram, "uMatDiffuse");
-    GLint locDiffuseMap = glGetUniformLocation(shaderProgram, "uDiffuseMap");
-
-    for (const auto &m : meshes)
+    ObjScene scene;
+    ObjLoadStats stats;
+    if (!LoadObj(path, scene, &stats))
+        return false;
+    char line[256];
+    snprintf(line, sizeof(line), "StaticModel: %s parsed natively: %u chunks, parse %.2f ms, dedup %.2f ms, normals %.2f ms",
+             path.substr(path.find_last_of("/\\") + 1).c_str(), stats.chunks, stats.parseMs, stats.buildMs,
+             stats.normalsMs);
+    std::cout << line << std::endl;
+
+    data.meshes.resize(scene.meshes.size());
+    verts.resize(scene.meshes.size());
+    inds.resize(scene.meshes.size());
+    for (size_t m = 0; m < scene.meshes.size(); ++m)
     {
-        // set diffuse color
-        if (locMatDiffuse >= 0)
-            glUniform3f(locMatDiffuse, m.diffuseColor.r, m.diffuseColor.g, m.diffuseColor.b);
-
-        // texture binding
-        if (m.hasDiffuse && m.diffuseTex)
-        {
-            if (locHasDiffuse >= 0)
-                glUniform1i(locHasDiffuse, 1);
-            if (locDiffuseMap >= 0)
-            {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, m.diffuseTex);
-                glUniform1i(locDiffuseMap, 0);
-            }
-        }
-        else
-        {
-            if (locHasDiffuse >= 0)
-                glUniform1i(locHasDiffuse, 0);
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
+        std::vector<SimpleVertex> &mv = verts[m];
+        std::vector<unsigned int> &mi = inds[m];
+        mv.swap(scene.meshes[m].vertices);
+        mi.swap(scene.meshes[m].indices);
+        OptimizeAndReport(path, m, mv, mi);
+
+        MeshCacheMesh &dst = data.meshes[m];
+        BuildLods(path, m, mv, mi, dst);
+        dst.uvDensity = UvDensity(mv.data(), mi.data(), dst.lods[0].indexCount);
+        dst.vertices = mv.data();
+        dst.vertexCount = (uint32_t)mv.size();
+        dst.indices = mi.data();
+        dst.indexCount = (uint32_t)mi.size();
+
+        const ObjMaterial &mat = scene.materials[scene.meshes[m].material];
+        dst.diffuseColor = mat.diffuse;
+        ApplyMaterial(dst, mat.name, mat.diffuseMap, mat.opacity, directory);
+    }
 
-        // alpha/hair handling
-        if (locHasAlpha >= 0)
-            glUniform1i(locHasAlpha, m.hasAlpha ? 1 : 0);
-        if (locUseAlphaTest >= 0)
-            glUniform1i(locUseAlphaTest, (m.hasAlpha || m.isHair) ? 1 : 0);
-        if (locAlphaCutoff >= 0)
-            glUniform1f(locAlphaCutoff, m.alphaCutoff);
+    // same layout Assimp's OBJ importer produces: a root named after the file, one child per object
+    data.nodes.clear();
+    data.nodeMeshes.clear();
+    data.nodeNames.clear();
+    ModelNode root;
+    root.nameId = 0;
+    data.nodeNames.push_back(path.substr(path.find_last_of("/\\") + 1));
+    data.nodes.push_back(root);
+    std::unordered_map<std::string, uint32_t> nameIds;
+    for (const auto &obj : scene.objects)
+    {
+        ModelNode nd;
+        nd.parent = 0;
+        nd.firstMesh = (uint32_t)data.nodeMeshes.size();
+        nd.meshCount = (uint32_t)obj.meshes.size();
+        data.nodeMeshes.insert(data.nodeMeshes.end(), obj.meshes.begin(), obj.meshes.end());
+        auto name = nameIds.emplace(obj.name, (uint32_t)data.nodeNames.size());
+        if (name.second)
+            data.nodeNames.push_back(obj.name);
+        nd.nameId = name.first->second;
+        data.nodes.push_back(nd);
+    }
 
-        // blending for hair: enable blending if isHair
-        if (m.isHair)
-        {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            // also disable depth write optionally to reduce artifacts:
-            glDepthMask(GL_FALSE);
-        }
+    ComputeNodePivots(data);
+    ComputeBBox(data);
+    return true;
+}
 
-        // draw mesh
-        glBindVertexArray(m.vao);
-        glDrawElements(GL_TRIANGLES, m.indexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+// Everything the CPU phase produces for Upload(); dropped once the GL objects exist
+struct StaticModel::Staging
+{
+    std::string directory;
+    MeshCache cache; // keeps the mapping alive on a cache hit
+    MeshCacheData data;
+    // true on a cache hit: meshes carry MeshCodec streams only, decoded by UploadMeshes
+    bool encoded = false;
+    // backing storage for the Assimp path; on a cache hit data points into the mapping
+    std::vector<std::vector<SimpleVertex>> verts;
+    std::vector<std::vector<unsigned int>> inds;
+    // 16-bit copy of the indices, empty for meshes with more than 65536 vertices
+    std::vector<std::vector<uint16_t>> shortInds;
+    // per mesh 16-bit index source for the upload: shortInds or a glTF buffer, nullptr for 32-bit
+    std::vector<const uint16_t *> shortIndexData;
+    // glTF only: the mapped file the mesh data points into
+    std::unique_ptr<GltfScene> gltf;
+    // VertexFormat::Packed only
+    std::vector<std::vector<PackedVertex>> packed;
+    glm::mat4 dequant = glm::mat4(1.0f);
+};
+
+bool StaticModel::ImportGltf(const std::string &path, Staging &st)
+{
+    st.gltf.reset(new GltfScene());
+    GltfScene &scene = *st.gltf;
+    if (!LoadGltf(path, scene))
+        return false;
 
-        // restore state
-        if (m.isHair)
+    MeshCacheData &data = st.data;
+    size_t count = scene.primitives.size();
+    data.meshes.resize(count);
+    st.shortIndexData.assign(count, nullptr);
+    size_t zeroCopyVertices = 0, zeroCopyIndices = 0;
+    std::vector<char> imageUsed(scene.images.size(), 0);
+    std::vector<float> imageCutoff(scene.images.size(), 0.0f); // of the first material using the image
+    for (size_t m = 0; m < count; ++m)
+    {
+        const GltfPrimitive &prim = scene.primitives[m];
+        MeshCacheMesh &dst = data.meshes[m];
+        dst.vertices = prim.vertices;
+        dst.vertexCount = prim.vertexCount;
+        dst.indices = prim.indices;
+        dst.indexCount = prim.indexCount;
+        st.shortIndexData[m] = prim.shortIndices;
+        if (prim.shortIndices)
+            dst.uvDensity = UvDensity(prim.vertices, prim.shortIndices, prim.indexCount);
+        else if (prim.indices)
+            dst.uvDensity = UvDensity(prim.vertices, prim.indices, prim.indexCount);
+        zeroCopyVertices += prim.vertexZeroCopy ? 1 : 0;
+        zeroCopyIndices += prim.shortIndices ? 1 : 0;
+
+        if (prim.material < 0)
+            continue;
+        const GltfMaterial &mat = scene.materials[prim.material];
+        dst.diffuseColor = glm::vec3(mat.baseColor);
+        const GltfImage *img = mat.image >= 0 ? &scene.images[mat.image] : nullptr;
+        // alpha only counts in BLEND mode, OPAQUE ignores it
+        ApplyMaterial(dst, mat.name, img ? img->uri : std::string(), mat.blend ? mat.baseColor.a : 1.0f,
+                      st.directory);
+        if (img && img->data)
         {
-            glDepthMask(GL_TRUE);
-            glDisable(GL_BLEND);
+            dst.diffusePath = EmbeddedImageName(path, mat.image);
+            imageUsed[mat.image] = 1;
         }
+        if (mat.blend)
+            dst.hasAlpha = true;
+        if (mat.mask)
+            dst.alphaCutoff = mat.alphaCutoff;
+        if (img && img->data && imageCutoff[mat.image] == 0.0f)
+            imageCutoff[mat.image] = dst.alphaCutoff;
     }
 
-    // unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // embedded images are decoded straight from the buffer, one per thread
+    std::vector<int> embedded;
+    for (size_t i = 0; i < imageUsed.size(); ++i)
+    {
+        if (imageUsed[i])
+            embedded.push_back((int)i);
+    }
+    ParallelFor(embedded.size(), [&](size_t i)
+                {
+                    const GltfImage &img = scene.images[embedded[i]];
+                    TextureCache::Instance().PrefetchEncoded(EmbeddedImageName(path, embedded[i]), img.data, img.size,
+                                                             TextureColorSpace::SRGB, imageCutoff[embedded[i]]);
+                });
+
+    data.nodes.clear();
+    data.nodeMeshes.clear();
+    data.nodeNames.clear();
+    std::unordered_map<std::string, uint32_t> nameIds;
+    for (const auto &gn : scene.nodes)
+    {
+        ModelNode nd;
+        nd.parent = gn.parent;
+        nd.transform = gn.transform;
+        nd.firstMesh = (uint32_t)data.nodeMeshes.size();
+        nd.meshCount = (uint32_t)gn.primitives.size();
+        data.nodeMeshes.insert(data.nodeMeshes.end(), gn.primitives.begin(), gn.primitives.end());
+        auto name = nameIds.emplace(gn.name, (uint32_t)data.nodeNames.size());
+        if (name.second)
+            data.nodeNames.push_back(gn.name);
+        nd.nameId = name.first->second;
+        data.nodes.push_back(nd);
+    }
+    ComputeNodePivots(data);
+    ComputeBBox(data);
+
+    char line[256];
+    snprintf(line, sizeof(line),
+             "StaticModel: %s: %zu primitives, %zu vertex / %zu index buffers uploaded from the mapped file, "
+             "%zu embedded images",
+             path.substr(path.find_last_of("/\\") + 1).c_str(), count, zeroCopyVertices, zeroCopyIndices,
+             embedded.size());
+    std::cout << line << std::endl;
+    return true;
 }
 
-static glm::mat4 aiMatToGlm(const aiMatrix4x4 &m)
+void StaticModel::PackVertices(const MeshCacheData &data, std::vector<std::vector<PackedVertex>> &packed,
+                               glm::mat4 &outDequant)
 {
-    return glm::mat4(
-        m.a1, m.b1, m.c1, m.d1,
-        m.a2, m.b2, m.c2, m.d2,
-        m.a3, m.b3, m.c3, m.d3,
-        m.a4, m.b4, m.c4, m.d4);
+    // quantization box over the raw (mesh space) positions of every mesh; the same box the mesh
+    // cache encodes with, so a cache hit decodes to the same vertices
+    std::vector<const SimpleVertex *> meshVertices;
+    std::vector<size_t> meshVertexCounts;
+    for (const auto &m : data.meshes)
+    {
+        meshVertices.push_back(m.vertices);
+        meshVertexCounts.push_back(m.vertexCount);
+    }
+    MeshQuantization quant = MeshQuantization::Compute(meshVertices, meshVertexCounts);
+
+    packed.resize(data.meshes.size());
+    for (size_t mi = 0; mi < data.meshes.size(); ++mi)
+    {
+        const MeshCacheMesh &m = data.meshes[mi];
+        std::vector<PackedVertex> &out = packed[mi];
+        out.resize(m.vertexCount);
+        for (uint32_t i = 0; i < m.vertexCount; ++i)
+        {
+            const SimpleVertex &v = m.vertices[i];
+            out[i].pos[0] = quant.QuantizePos(v.pos.x, 0);
+            out[i].pos[1] = quant.QuantizePos(v.pos.y, 1);
+            out[i].pos[2] = quant.QuantizePos(v.pos.z, 2);
+            out[i].pos[3] = 0;
+            out[i].normal = glm::packSnorm3x10_1x2(glm::vec4(v.normal, 0.0f));
+            out[i].uv[0] = glm::packHalf1x16(v.uv.x);
+            out[i].uv[1] = glm::packHalf1x16(v.uv.y);
+        }
+    }
+    outDequant = quant.DequantMatrix();
 }
 
-void StaticModel::ComputeBBoxRecursive(
-    aiNode *node,
-    const aiScene *scene,
-    const glm::mat4 &parentTransform)
+void StaticModel::UploadMeshes(const Staging &st)
 {
-    glm::mat4 nodeTransform = parentTransform * aiMatToGlm(node->mTransformation);
+    const MeshCacheData &data = st.data;
+    const std::vector<std::vector<PackedVertex>> &packed = st.packed;
+    arena = &GeometryArena::Get(vertexFormat);
+    meshes.resize(data.meshes.size());
 
-    // 遍历该 node 挂载的 mesh
-    for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+    for (size_t m = 0; m < data.meshes.size(); ++m)
     {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+        const MeshCacheMesh &src = data.meshes[m];
+        MeshRenderData &dst = meshes[m];
+        dst.indexCount = static_cast<GLsizei>(src.indexCount);
+        dst.lodCount = 1;
+        dst.lods[0] = MeshLod();
+        dst.lods[0].indexCount = src.indexCount;
+        if (src.lodCount > 0)
         {
-            glm::vec3 p = aiVec3ToGlm(mesh->mVertices[v]);
-            glm::vec4 worldP = nodeTransform * glm::vec4(p, 1.0f);
-            glm::vec3 wp(worldP);
+            dst.lodCount = src.lodCount;
+            std::copy(src.lods, src.lods + src.lodCount, dst.lods);
+            dst.indexCount = static_cast<GLsizei>(src.lods[0].indexCount);
+        }
 
-            if (!bboxInitialized)
+        if (st.encoded)
+        {
+            dst.geometry = UploadEncodedMesh(src, data.quant, dst.indexType);
+        }
+        else
+        {
+            const void *vertexData = packed.empty() ? (const void *)src.vertices : (const void *)packed[m].data();
+            const void *indexData;
+            size_t indexBytes;
+            if (st.shortIndexData[m])
             {
-                bboxMin = bboxMax = wp;
-                bboxInitialized = true;
+                dst.indexType = GL_UNSIGNED_SHORT;
+                indexData = st.shortIndexData[m];
+                indexBytes = src.indexCount * sizeof(uint16_t);
             }
             else
             {
-                bboxMin = glm::min(bboxMin, wp);
-                bboxMax = glm::max(bboxMax, wp);
+                dst.indexType = GL_UNSIGNED_INT;
+                indexData = src.indices;
+                indexBytes = src.indexCount * sizeof(unsigned int);
             }
+            dst.geometry = arena->Allocate(vertexData, src.vertexCount, indexData, indexBytes);
         }
-    }
+        if (!dst.geometry)
+            dst.indexCount = 0;
+        lodCount = std::max(lodCount, (int)dst.lodCount);
 
-    // 递归子节点
-    for (unsigned int c = 0; c < node->mNumChildren; ++c)
-    {
-        ComputeBBoxRecursive(node->mChildren[c], scene, nodeTransform);
-    }
-    // std::cout << "bboxMin = "
-    //           << bboxMin.x << ", "
-    //           << bboxMin.y << ", "
-    //           << bboxMin.z << std::endl;
+        // material handling
+        dst.diffuseColor = src.diffuseColor;
+        dst.isHair = src.isHair;
+        dst.alphaCutoff = src.alphaCutoff;
+        dst.diffusePath = src.diffusePath;
+        dst.uvDensity = src.uvDensity;
+        dst.hasDiffuse = false;
+        dst.diffuseTex = 0;
 
-    // std::cout << "bboxMax = "
-    //           << bboxMax.x << ", "
-    //           << bboxMax.y << ", "
-    //           << bboxMax.z << std::endl;
+        if (!src.diffusePath.empty())
+        {
+            TextureHandle tex = TextureCache::Instance().Acquire(src.diffusePath, TextureColorSpace::SRGB, src.alphaCutoff);
+            dst.diffuseTex = tex.id;
+            if (dst.diffuseTex)
+                dst.hasDiffuse = true;
+            else
+                std::cerr << "StaticModel: failed to load diffuse texture " << src.diffusePath << "\n";
+        }
+        // the texture's alpha is only a guess until its first decode finishes, MeshMaterial asks for it
+        dst.hasAlpha = src.hasAlpha;
+    }
 }
 
-void StaticModel::DrawDepth() const
+// Decodes a cached mesh straight into a mapped arena range: the GL buffer is the only copy
+uint32_t StaticModel::UploadEncodedMesh(const MeshCacheMesh &src, const MeshQuantization &quant, GLenum &indexType)
 {
-    for (const auto &m : meshes)
+    bool shortIndices = src.vertexCount <= 65536;
+    size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(unsigned int);
+    indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    void *vertexDst, *indexDst;
+    uint32_t geometry = arena->AllocateMapped(src.vertexCount, src.indexCount * indexSize, vertexDst, indexDst);
+    if (!geometry)
+        return 0;
+    bool decoded = DecodeVertexBuffer(vertexDst, vertexFormat, src.vertexCount, quant, src.encodedVertices,
+                                      src.encodedVertexBytes) &&
+                   DecodeIndexBuffer(indexDst, indexSize, src.indexCount, src.vertexCount, src.encodedIndices,
+                                     src.encodedIndexBytes);
+    if (!arena->Unmap(geometry))
+        return 0;
+    if (!decoded)
     {
-        glBindVertexArray(m.vao);
-        glDrawElements(GL_TRIANGLES, m.indexCount, GL_UNSIGNED_INT, 0);
+        std::cerr << "StaticModel: corrupted mesh data in the mesh cache\n";
+        arena->Free(geometry);
+        return 0;
     }
-    glBindVertexArray(0);
+    return geometry;
 }
 
-// ---- Helper: adapt these to your MeshRenderData definition ----
-// I will assume you have a member std::vector<MeshRenderData> meshes;
-// and MeshRenderData contains at least: unsigned int VAO; unsigned int indexCount; unsigned int VBO (maybe);
-// possibly unsigned int EBO; unsigned int diffuseTex; glm::vec3 diffuseColor; bool hasDiffuseTex;
-// If your field names differ, change below accordingly.
-
-void StaticModel::DrawMeshByIndex(unsigned int meshIndex, unsigned int shaderID) const
+bool StaticModel::ImportData(const std::string &path, Staging &st, bool &rebuilt)
 {
-    if (!scene)
-        return; // or handle accordingly
-    if (meshIndex >= meshes.size())
+    rebuilt = false;
+    // directory for relative texture paths
+    size_t p = path.find_last_of("/\\");
+    st.directory = (p == std::string::npos) ? "." : path.substr(0, p);
+
+    // glTF is read in place every time, everything else goes through the mesh cache
+    bool gltf = IsGltfPath(path);
+    bool obj = IsObjPath(path);
+    std::string cachePath = MeshCache::CachePathFor(path);
+    uint64_t sourceHash = gltf ? 0 : MeshCache::HashSource(path);
+
+    bool cached = sourceHash != 0 && st.cache.Open(cachePath, sourceHash, obj ? kObjImportKey : kImportFlags, st.data);
+    if (gltf)
+        return ImportGltf(path, st);
+    if (cached)
     {
-        std::cerr << "DrawMeshByIndex: invalid meshIndex " << meshIndex << std::endl;
-        return;
+        st.encoded = true;
+        return true;
     }
 
-    const auto &m = meshes[meshIndex];
-
-    // --- set material/texture uniforms (if present) ---
-    GLint locHasDiffuse = glGetUniformLocation(shaderID, "uHasDiffuse");
-    GLint locDiffuseMap = glGetUniformLocation(shaderID, "uDiffuseMap");
-    GLint locMatDiffuse = glGetUniformLocation(shaderID, "uMatDiffuse");
-
-    // Example field names — update to your actual struct:
-    // m.diffuseTex   -> GLuint texture id (0 if none)
-    // m.hasDiffuseTex -> bool
-    // m.diffuseColor -> glm::vec3
+    bool imported = false;
+    uint32_t importKey = kImportFlags;
+    if (obj)
+    {
+        imported = ImportObj(path, st.directory, st.data, st.verts, st.inds);
+        if (imported)
+            importKey = kObjImportKey;
+        else
+            std::cerr << "StaticModel: native OBJ import failed, falling back to Assimp for " << path << "\n";
+    }
+    if (!imported && !ImportWithAssimp(path, st.directory, st.data, st.verts, st.inds))
+        return false;
+    if (sourceHash != 0)
+        rebuilt = MeshCache::Write(cachePath, sourceHash, importKey, st.data);
+    return true;
+}
 
-    bool hasTex = false;
-    GLuint texId = 0;
-    glm::vec3 matColor(1.0f, 1.0f, 1.0f);
+bool StaticModel::Bake(const std::string &path, bool &rebuilt, std::vector<std::pair<std::string, float>> &textures)
+{
+    Staging st;
+    if (!ImportData(path, st, rebuilt))
+        return false;
+    for (const auto &m : st.data.meshes)
+    {
+        if (!m.diffusePath.empty())
+            textures.emplace_back(m.diffusePath, m.alphaCutoff);
+    }
+    return true;
+}
 
-// Try to read common field names (adapt if your names differ)
-// ======= ADAPT HERE if your struct fields are different =======
-// Example assumptions:
-// m.diffuseTex (GLuint), m.hasDiffuse (bool), m.diffuseColor (glm::vec3)
-#ifdef HAS_MESH_FIELDS_EXPLICIT // remove this define in real code; it's explanatory
-    hasTex = m.hasDiffuse;
-    texId = m.diffuseTex;
-    matColor = m.diffuseColor;
-#else
-// Try common variants with safe checks using sizeof/offsetof is overkill here;
-// you should replace these lines with the actual fields from your MeshRenderData:
-// e.g. hasTex = (m.diffuseTextureID != 0);
-//      texId = m.diffuseTextureID;
-//      matColor = m.baseColor;
-#endif
-    // --- end adapt section ---
+bool StaticModel::Import(const std::string &path)
+{
+    staging.reset(new Staging());
+    Staging &st = *staging;
+    bool rebuilt;
+    if (!ImportData(path, st, rebuilt))
+    {
+        staging.reset();
+        return false;
+    }
 
-    // If your mesh struct actually contains a texture id field named `texture_diffuse`:
-    // uncomment/modify the below to match:
-    // hasTex = (m.texture_diffuse != 0);
-    // texId  = m.texture_diffuse;
+    // cached meshes are decoded on upload, already quantized and with indices of the right width
+    if (st.encoded)
+    {
+        if (vertexFormat == VertexFormat::Packed)
+            st.dequant = st.data.quant.DequantMatrix();
+    }
+    else
+    {
+        ConvertForUpload(st);
+    }
 
-    if (locHasDiffuse >= 0)
-        glUniform1i(locHasDiffuse, hasTex ? 1 : 0);
-    if (locMatDiffuse >= 0)
-        glUniform3f(locMatDiffuse, matColor.r, matColor.g, matColor.b);
-    if (hasTex && locDiffuseMap >= 0)
+    // start loading textures here so Upload() finds them baked or decoding; the cache skips files
+    // that are already resident or loading for another model. Every material alpha-tests
+    // (phong.fs, whenever the texture has alpha), so its cutoff is what the mips preserve.
+    for (const auto &m : st.data.meshes)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texId);
-        glUniform1i(locDiffuseMap, 0);
+        if (!m.diffusePath.empty())
+            TextureCache::Instance().Prefetch(m.diffusePath, TextureColorSpace::SRGB, m.alphaCutoff);
     }
-    else if (locDiffuseMap >= 0)
+    return true;
+}
+
+void StaticModel::ConvertForUpload(Staging &st)
+{
+    st.shortInds.resize(st.data.meshes.size());
+    st.shortIndexData.resize(st.data.meshes.size(), nullptr);
+    for (size_t m = 0; m < st.data.meshes.size(); ++m)
     {
-        // ensure shader doesn't sample stale texture unit
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glUniform1i(locDiffuseMap, 0);
+        const MeshCacheMesh &mesh = st.data.meshes[m];
+        if (st.shortIndexData[m] || mesh.vertexCount > 65536)
+            continue;
+        st.shortInds[m].assign(mesh.indices, mesh.indices + mesh.indexCount);
+        st.shortIndexData[m] = st.shortInds[m].data();
     }
 
-    // --- bind VAO and draw ---
-    // Common struct fields: m.VAO, m.indexCount, m.hasIndices (or m.EBO)
-    glBindVertexArray(m.vao);
+    if (vertexFormat == VertexFormat::Packed)
+        PackVertices(st.data, st.packed, st.dequant);
+}
 
-    if (m.indexCount > 0)
+bool StaticModel::Upload()
+{
+    if (!staging)
+        return false;
+    Cleanup();
+
+    Staging &st = *staging;
+    directory = st.directory;
+    lodCount = 1;
+    UploadMeshes(st);
+    // a model level is drawn with every mesh at that level (or its coarsest one)
+    for (int l = 0; l < lodCount; ++l)
     {
-        // indexed draw: assume indices are uint
-        glDrawElements(GL_TRIANGLES, (GLsizei)m.indexCount, GL_UNSIGNED_INT, 0);
+        lodError[l] = l > 0 ? lodError[l - 1] : 0.0f;
+        for (const auto &m : meshes)
+            lodError[l] = std::max(lodError[l], m.lods[std::min((uint32_t)l, m.lodCount - 1)].error);
     }
+    dequant = st.dequant;
+    nodes = std::move(st.data.nodes);
+    nodeMeshes = std::move(st.data.nodeMeshes);
+    nameAnim.clear();
+    for (const auto &name : st.data.nodeNames)
+        nameAnim.push_back(ClassifyNode(name));
+    bboxMin = st.data.bboxMin;
+    bboxMax = st.data.bboxMax;
+    bboxInitialized = st.data.bboxInitialized;
+
+    staging.reset();
+    // std::cout << "StaticModel: loaded meshes=" << meshes.size() << std::endl;
+    return true;
+}
+
+bool StaticModel::LoadFromFile(const std::string &path)
+{
+    return Import(path) && Upload();
+}
+
+void StaticModel::DrawGeometry(const MeshRenderData &m, int lod, GLsizei instances) const
+{
+    if (m.indexCount == 0)
+        return;
+    const MeshLod &level = m.lods[std::min((uint32_t)std::max(lod, 0), m.lodCount - 1)];
+    const GeometryArena::Range &r = arena->GetRange(m.geometry);
+    size_t indexSize = m.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    void *first = (void *)(r.indexOffset + level.firstIndex * indexSize);
+    if (instances > 0)
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)level.indexCount, m.indexType, first, instances,
+                                          (GLint)r.baseVertex);
     else
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)level.indexCount, m.indexType, first, (GLint)r.baseVertex);
+}
+
+RenderMaterial StaticModel::MeshMaterial(uint32_t mesh) const
+{
+    // the mesh's own look: its map or color, alpha test for cutouts and hair
+    const MeshRenderData &m = meshes[mesh];
+    RenderMaterial mat;
+    mat.texture = (m.hasDiffuse && m.diffuseTex) ? m.diffuseTex : 0;
+    mat.color = m.diffuseColor;
+    mat.hasAlpha = m.hasAlpha || (mat.texture && TextureCache::Instance().HasAlpha(mat.texture));
+    mat.alphaTest = mat.hasAlpha || m.isHair;
+    mat.alphaCutoff = m.alphaCutoff;
+    // hair blends without writing depth
+    mat.blend = m.isHair;
+    mat.depthWrite = !m.isHair;
+    return mat;
+}
+
+void StaticModel::DrawMesh(uint32_t mesh, int lod, GLsizei instances) const
+{
+    if (arena && mesh < meshes.size())
+        DrawGeometry(meshes[mesh], lod, instances);
+}
+
+void StaticModel::Submit(RenderQueue &queue, RenderItem item, float depth) const
+{
+    if (!arena)
+        return;
+    item.model = this;
+    for (uint32_t i = 0; i < meshes.size(); ++i)
     {
-        // fallback: draw arrays using vertex count (if stored as vertexCount)
-        // if (m.vertexCount > 0)
-        //     glDrawArrays(GL_TRIANGLES, 0, (GLsizei)m.vertexCount);
-        // else
-        //     std::cerr << "DrawMeshByIndex: mesh " << meshIndex << " has no indices or vertexCount\n";
+        if (meshes[i].indexCount == 0)
+            continue;
+        item.mesh = i;
+        if (item.pass == RenderPass::Main)
+            item.material = MeshMaterial(i);
+        queue.Submit(item, depth);
     }
+}
 
-    // unbind VAO and texture (optional hygiene)
-    glBindVertexArray(0);
-    if (hasTex)
+size_t StaticModel::GpuBytes() const
+{
+    if (!arena)
+        return 0;
+    size_t stride = vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(SimpleVertex);
+    size_t bytes = 0;
+    for (const auto &m : meshes)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        if (!m.geometry)
+            continue;
+        const GeometryArena::Range &r = arena->GetRange(m.geometry);
+        bytes += (size_t)r.vertexCount * stride + r.indexBytes;
     }
+    return bytes;
 }
 
-void StaticModel::DrawNodeAnimated(const aiNode *nd, const glm::mat4 &parentTransform, unsigned int shaderID)
+size_t StaticModel::CpuBytes() const
 {
-    // std::cout << "Drawing node " << nd << std::endl;
-    // compute node transform
-    glm::mat4 nodeTransform = parentTransform * aiMatToGlm(nd->mTransformation);
+    size_t bytes = meshes.capacity() * sizeof(MeshRenderData) + nodes.capacity() * sizeof(ModelNode) +
+                   nodeMeshes.capacity() * sizeof(uint32_t) + nameAnim.capacity() * sizeof(NodeAnim) +
+                   nodeWorld.capacity() * sizeof(glm::mat4);
+    for (const auto &m : meshes)
+        bytes += m.diffusePath.capacity();
+    return bytes;
+}
 
-    // check node name for animation targets
-    std::string nm(nd->mName.C_Str());
+float StaticModel::PixelsPerUnit(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale) const
+{
+    if (!bboxInitialized)
+        return 0.0f;
+    // bounding sphere of the instance; the nearest point of it decides
+    glm::vec3 center = glm::vec3(model * glm::vec4((bboxMin + bboxMax) * 0.5f, 1.0f));
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                           std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    float radius = glm::length(bboxMax - bboxMin) * 0.5f * scale;
+    float distance = std::max(glm::length(center - cameraPos) - radius, 0.1f);
+    return projScale * scale / distance;
+}
 
-    glm::mat4 animatedTransform = nodeTransform; // default
+int StaticModel::SelectLod(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale, float tolerancePx,
+                           int current) const
+{
+    if (lodCount <= 1 || !bboxInitialized)
+        return 0;
+    float pixelsPerUnit = PixelsPerUnit(model, cameraPos, projScale);
+    int lod = glm::clamp(current, 0, lodCount - 1);
+    while (lod > 0 && lodError[lod] * pixelsPerUnit > tolerancePx * (1.0f + kLodHysteresis))
+        lod--;
+    while (lod + 1 < lodCount && lodError[lod + 1] * pixelsPerUnit < tolerancePx * (1.0f - kLodHysteresis))
+        lod++;
+    return lod;
+}
 
-    // set up animation for legs and tail: frequency, amplitude, phase
-    float t = (float)glfwGetTime();
-    float legFreq = 5.5f;
-    float legAmp = glm::radians(13.0f);
+void StaticModel::RequestTextureDetail(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale) const
+{
+    // without a bbox nothing is known about the size on screen: ask for full detail
+    float pixelsPerUnit = PixelsPerUnit(model, cameraPos, projScale);
+    for (const auto &m : meshes)
+    {
+        if (!m.diffuseTex)
+            continue;
+        float uvPerPixel = pixelsPerUnit > 0.0f ? m.uvDensity / pixelsPerUnit : std::numeric_limits<float>::min();
+        TextureCache::Instance().RequestDetail(m.diffuseTex, uvPerPixel);
+    }
+}
 
+// Decide once per interned name how the node animates (the cat's legs swing, the body bobs)
+StaticModel::NodeAnim StaticModel::ClassifyNode(const std::string &nm)
+{
+    NodeAnim anim;
     // simple name matching (case-sensitive). If your node names differ, adjust strings.
     if (nm.find("Leg") != std::string::npos || nm.find("leg") != std::string::npos)
     {
-        // std::cout << "animEnable: " << (animEnable ? "true" : "false") << std::endl;
-        if (!animEnable)
-        {
-            animatedTransform = nodeTransform; // 原样绘制，不动画
-        }
-        else
-        {
-            // determine phase by which leg
-            float phase = 0.0f;
-            if (nm.find("Front_L") != std::string::npos || nm.find("FrontLeft") != std::string::npos || nm.find("Front_L") != std::string::npos)
-                phase = 0.0f;
-            else if (nm.find("Front_R") != std::string::npos || nm.find("FrontRight") != std::string::npos)
-                phase = glm::pi<float>();
-            else if (nm.find("Back_L") != std::string::npos || nm.find("BackLeft") != std::string::npos)
-                phase = glm::pi<float>();
-            else if (nm.find("Back_R") != std::string::npos || nm.find("BackRight") != std::string::npos)
-                phase = 0.0f;
-
-            float rawAngle = sinf(t * legFreq + phase) * legAmp;
-            float angle = rawAngle * animBlend;
-            // pivot in local node coordinates (if available), otherwise use origin (0,0,0)
-            glm::vec3 pivot(0.0f);
-            auto it = nodePivots.find(nm);
-            if (it != nodePivots.end())
-                pivot = it->second;
-            // glm::vec3 size = bboxMax - bboxMin;
-            // glm::vec3 pivot = bboxMin;
-            // pivot.y = bboxMax.y;
-
-            // rotate around local X axis (forward/back swing). If your leg's local axis differs, change axis.
-            glm::mat4 T1 = glm::translate(glm::mat4(1.0f), pivot);
-            glm::mat4 R = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(1, 0, 0));
-            glm::mat4 T2 = glm::translate(glm::mat4(1.0f), -pivot);
-
-            // apply locally: nodeTransform is in model-space; we must insert local rotation
-            animatedTransform = nodeTransform * T1 * R * T2;
-        }
+        anim.kind = NodeAnimKind::Leg;
+        // determine phase by which leg
+        if (nm.find("Front_L") != std::string::npos || nm.find("FrontLeft") != std::string::npos)
+            anim.phase = 0.0f;
+        else if (nm.find("Front_R") != std::string::npos || nm.find("FrontRight") != std::string::npos)
+            anim.phase = glm::pi<float>();
+        else if (nm.find("Back_L") != std::string::npos || nm.find("BackLeft") != std::string::npos)
+            anim.phase = glm::pi<float>();
+        else if (nm.find("Back_R") != std::string::npos || nm.find("BackRight") != std::string::npos)
+            anim.phase = 0.0f;
     }
     else if (nm == "Body")
     {
-        float bob = 0.0f;
-        if (animBlend > 0.001f)
-            bob = sinf(t * legFreq * 0.5f) * 0.01f * animBlend; // 1cm 级别
-
-        animatedTransform = glm::translate(nodeTransform, glm::vec3(0, bob, 0));
+        anim.kind = NodeAnimKind::Body;
     }
+    return anim;
+}
 
-    // Draw meshes attached to this node using animatedTransform as model
-    // set uniform uModel/uNormalMat as in your normal draw path
-    GLint locModel = glGetUniformLocation(shaderID, "uModel");
-    if (locModel >= 0)
-        glUniformMatrix4fv(locModel, 1, GL_FALSE, &animatedTransform[0][0]);
+glm::mat4 StaticModel::AnimateNode(const ModelNode &nd, const glm::mat4 &nodeTransform, float t) const
+{
+    // set up animation for legs and tail: frequency, amplitude, phase
+    const float legFreq = 5.5f;
+    const float legAmp = glm::radians(13.0f);
 
-    GLint locNormal = glGetUniformLocation(shaderID, "uNormalMat");
-    if (locNormal >= 0)
+    const NodeAnim &anim = nameAnim[nd.nameId];
+    if (anim.kind == NodeAnimKind::Leg)
     {
-        glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(animatedTransform)));
-        glUniformMatrix3fv(locNormal, 1, GL_FALSE, &normalMat[0][0]);
-    }
+        if (!animEnable)
+            return nodeTransform; // 原样绘制，不动画
 
-    // draw each mesh of this node
-    for (unsigned int i = 0; i < nd->mNumMeshes; ++i)
-    {
-        unsigned int meshIndex = nd->mMeshes[i];
-        // your existing mesh draw routine; e.g.:
-        // meshes[meshIndex].Draw(shaderID);
-        DrawMeshByIndex(meshIndex, shaderID); // replace with your actual function
-    }
+        float rawAngle = sinf(t * legFreq + anim.phase) * legAmp;
+        float angle = rawAngle * animBlend;
+        // pivot in local node coordinates (origin if the node has no meshes)
+        glm::vec3 pivot = nd.pivot;
 
-    // recurse children with nodeTransform (or animatedTransform if you want children to follow)
-    for (unsigned int c = 0; c < nd->mNumChildren; ++c)
+        // rotate around local X axis (forward/back swing). If your leg's local axis differs, change axis.
+        glm::mat4 T1 = glm::translate(glm::mat4(1.0f), pivot);
+        glm::mat4 R = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(1, 0, 0));
+        glm::mat4 T2 = glm::translate(glm::mat4(1.0f), -pivot);
+
+        // apply locally: nodeTransform is in model-space; we must insert local rotation
+        return nodeTransform * T1 * R * T2;
+    }
+    if (anim.kind == NodeAnimKind::Body)
     {
-        DrawNodeAnimated(nd->mChildren[c], animatedTransform, shaderID);
-        // Note: we pass nodeTransform to children if you don't want child's transform to be affected
-        // by the local animation; if you DO want children to follow, pass animatedTransform instead.
+        float bob = 0.0f;
+        if (animBlend > 0.001f)
+            bob = sinf(t * legFreq * 0.5f) * 0.01f * animBlend; // 1cm 级别
+
+        return glm::translate(nodeTransform, glm::vec3(0, bob, 0));
     }
+    return nodeTransform;
 }
+
 // 新接口：接收外部 modelMatrix
-void StaticModel::DrawAnimated(const glm::mat4 &rootModel, float deltaTime, unsigned int shaderID)
+void StaticModel::Animate(const glm::mat4 &rootModel, float deltaTime)
 {
     // 平滑逼近目标状态
     float target = animEnable ? 1.0f : 0.0f;
@@ -749,7 +1173,34 @@ void StaticModel::DrawAnimated(const glm::mat4 &rootModel, float deltaTime, unsi
 
     animBlend += (target - animBlend) * speed * deltaTime;
     animBlend = glm::clamp(animBlend, 0.0f, 1.0f);
-    if (!scene)
+
+    float t = (float)glfwGetTime();
+    // parents come first in the table, so one forward pass sees every parent's animated
+    // transform before its children (children follow their parent's animation)
+    nodeWorld.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const ModelNode &nd = nodes[i];
+        glm::mat4 nodeTransform = (nd.parent < 0 ? rootModel : nodeWorld[nd.parent]) * nd.transform;
+        nodeWorld[i] = AnimateNode(nd, nodeTransform, t);
+    }
+}
+
+void StaticModel::SubmitAnimated(RenderQueue &queue, RenderItem item, float depth) const
+{
+    if (!arena || nodeWorld.size() != nodes.size())
         return;
-    DrawNodeAnimated(scene->mRootNode, rootModel, shaderID);
+    item.model = this;
+    item.instances = 0;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const ModelNode &nd = nodes[i];
+        item.transform = nodeWorld[i];
+        for (uint32_t k = 0; k < nd.meshCount; ++k)
+        {
+            item.mesh = nodeMeshes[nd.firstMesh + k];
+            if (item.mesh < meshes.size() && meshes[item.mesh].indexCount > 0)
+                queue.Submit(item, depth);
+        }
+    }
 }
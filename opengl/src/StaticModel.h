@@ -1,12 +1,13 @@
 // src/StaticModel.h
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include <assimp/scene.h>
-#include <assimp/Importer.hpp>
-#include <unordered_map>
+#include <memory>
+#include "RenderQueue.h"
+#include "Shader.h"
 
 struct SimpleVertex
 {
@@ -15,39 +16,137 @@ struct SimpleVertex
     glm::vec2 uv;
 };
 
+// Compact 16 byte layout: position as 16-bit unorm inside the model's quantization box,
+// normal as snorm 10:10:10:2 and UV as half floats. The box is undone by
+// StaticModel::DequantMatrix(), which callers fold into uModel.
+struct PackedVertex
+{
+    uint16_t pos[4]; // xyz + padding
+    uint32_t normal;
+    uint16_t uv[2];
+};
+
+// Per-instance attributes for instanced draws (RenderItem::instances): locations 3-6 take the
+// columns of the instance's model matrix (without the DequantMatrix, which stays in uModel), 7 a
+// color that tints the material.
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+enum class VertexFormat
+{
+    Float, // SimpleVertex, 32 bytes
+    Packed // PackedVertex, 16 bytes
+};
+
+// One level of detail of a mesh. The simplified levels (MeshSimplify) reuse the full mesh's vertices,
+// so a level is just a range of the mesh's index data; level 0 is the full mesh.
+static const uint32_t kMaxMeshLods = 4;
+struct MeshLod
+{
+    uint32_t firstIndex = 0; // all levels are stored back to back
+    uint32_t indexCount = 0;
+    float error = 0.0f; // object-space simplification error, never smaller than the previous level's
+};
+
 struct MeshRenderData
 {
-    GLuint vao = 0;
-    GLuint vbo = 0;
-    GLuint ebo = 0;
-    GLsizei indexCount = 0;
+    uint32_t geometry = 0; // GeometryArena handle: base vertex + index range in the shared buffers
+    GLsizei indexCount = 0; // level 0
+    GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT when the mesh has at most 65536 vertices
+    MeshLod lods[kMaxMeshLods];
+    uint32_t lodCount = 1;
+    float uvDensity = 0.0f; // texture coordinate units per mesh space unit (MeshCacheMesh)
 
     // material
     bool hasDiffuse = false;
     GLuint diffuseTex = 0;
+    std::string diffusePath; // resolved texture file, empty if the material has none
     glm::vec3 diffuseColor = glm::vec3(1.0f);
     // hair/alpha behavior
-    bool hasAlpha = false;    // texture contains alpha
+    bool hasAlpha = false;    // material is transparent; the texture's alpha comes from TextureCache::HasAlpha
     bool isHair = false;      // treat as hair: alpha + alpha cutoff + blending
     float alphaCutoff = 0.5f; // default alpha cutoff for alpha-test
 };
 
+// One entry of the flattened node hierarchy (filled from aiScene or from the mesh cache).
+// The table is topologically sorted: a parent always comes before its children.
+struct ModelNode
+{
+    int32_t parent = -1;                   // -1 for the root
+    glm::mat4 transform = glm::mat4(1.0f); // local transform relative to parent
+    uint32_t firstMesh = 0;                // range in the node mesh list
+    uint32_t meshCount = 0;
+    uint32_t nameId = 0;                   // index into the interned node names
+    glm::vec3 pivot = glm::vec3(0.0f);     // top centre of the node's meshes in local space (origin if none)
+};
+
+struct MeshCacheData;
+struct MeshCacheMesh;
+struct MeshQuantization;
+class GeometryArena;
+
 class StaticModel
 {
 public:
     StaticModel();
     ~StaticModel();
 
-    // Load model via Assimp (.obj/.fbx/.gltf/.glb)
+    // Load model (.obj through the native ObjLoader, .fbx and others via Assimp). The import result is
+    // baked to "<path>.smc" and later loads map that file instead of parsing the source again (see MeshCache).
+    // .gltf/.glb go through GltfLoader and are not baked: their buffers already have a GPU layout and
+    // are uploaded from the mapped file.
     bool LoadFromFile(const std::string &path);
 
-    void DrawAnimated(const glm::mat4 &rootModel, float deltaTime, unsigned int shaderID);
+    // LoadFromFile split in two for parallel loading (see AssetLoader):
+    // Import does file I/O, Assimp/cache parsing and texture decoding and may run on a worker thread;
+    // Upload creates the GL objects and must run on the context thread.
+    bool Import(const std::string &path);
+    bool Upload();
+
+    // Offline cook for asset_bake: Import without the GL-side preparation. Writes "<path>.smc" unless
+    // an up-to-date one exists (rebuilt reports which) and appends the resolved diffuse maps to textures,
+    // each with the alpha cutoff its material tests it against (the mip chain depends on it).
+    bool Bake(const std::string &path, bool &rebuilt, std::vector<std::pair<std::string, float>> &textures);
+
+    // Advance the procedural animation (legs swing, body bobs while animEnable) once per frame and
+    // pose the node hierarchy under rootModel for SubmitAnimated.
+    void Animate(const glm::mat4 &rootModel, float deltaTime);
 
-    // Draw with currently bound shader. Caller must set uModel, uNormalMat, and shader must
-    // support uHasDiffuse, uHasAlpha, uUseAlphaTest, uAlphaCutoff, uMatDiffuse, and sampler2D uDiffuseMap.
-    void Draw(GLuint shaderProgram) const;
-    void DrawDepth() const;
+    // Render queue submission: one item per mesh, item supplying the pass, program, level, transform
+    // (or instances) and, for the shadow pass, the material; main pass meshes take their own
+    // (MeshMaterial). SubmitAnimated places each node's meshes at its pose from the last Animate and
+    // keeps item's material for all of them.
+    void Submit(RenderQueue &queue, RenderItem item, float depth) const;
+    void SubmitAnimated(RenderQueue &queue, RenderItem item, float depth) const;
+    RenderMaterial MeshMaterial(uint32_t mesh) const;
+    // one level of one mesh (instanced with instances > 0); the queue has bound the geometry. Meshes
+    // with fewer levels than lod draw their coarsest one.
+    void DrawMesh(uint32_t mesh, int lod, GLsizei instances) const;
+    const GeometryArena *Arena() const { return arena; }
+
+    // Level of detail for one instance: the coarsest level whose simplification error, projected at
+    // the instance's distance, stays below tolerancePx screen pixels. projScale is
+    // viewportHeight / (2 tan(fovy / 2)); current is the level the instance used last frame. A level
+    // changes only once its error is past the tolerance by kLodHysteresis, so an instance sitting at a
+    // switch distance does not pop back and forth.
+    int SelectLod(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale, float tolerancePx,
+                  int current) const;
+    int LodCount() const { return lodCount; }
+    // Reports to the TextureCache how much of each diffuse map one screen pixel covers for this
+    // instance (projScale as for SelectLod), so only the mip levels that show stay resident.
+    void RequestTextureDetail(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale) const;
     GLuint getDiffuseTexID() const;
+    // memory held by the uploaded model: geometry in the arena (its textures are the
+    // TextureCache's) and the CPU-side mesh and node tables
+    size_t GpuBytes() const;
+    size_t CpuBytes() const;
+    // maps packed vertex positions back to model space; identity for VertexFormat::Float
+    const glm::mat4 &DequantMatrix() const { return dequant; }
+    // vertex layout used by the next Import()/LoadFromFile()
+    VertexFormat vertexFormat = VertexFormat::Float;
     // convenience scale
     glm::vec3 modelScale = glm::vec3(1.0f);
     glm::mat4 modelMatrix = glm::mat4(1.0f);
@@ -59,32 +158,72 @@ public:
     float animBlend = 0.0f;
 
 private:
-    // store computed local-space pivot for nodes by name (local coordinates of the model file)
-    std::unordered_map<std::string, glm::vec3> nodePivots;
-
-    // compute pivots after scene loaded
-    void ComputeNodePivots();
-
-    // recursive draw used by DrawAnimated
-    void DrawNodeAnimated(const aiNode *node, const glm::mat4 &parentTransform, unsigned int shaderID);
+    // procedural animation picked from the node name once at upload
+    enum class NodeAnimKind : uint8_t
+    {
+        None,
+        Leg,
+        Body
+    };
+    struct NodeAnim
+    {
+        NodeAnimKind kind = NodeAnimKind::None;
+        float phase = 0.0f; // leg swing phase
+    };
 
-    // helper: compute mesh bbox in node local space (returns min/max)
-    void ComputeMeshAABBForNode(const aiNode *node, glm::vec3 &outMin, glm::vec3 &outMax) const;
+    // pivots and bbox from the node table and the mesh vertices (Assimp import only, the cache stores them)
+    static void ComputeNodePivots(MeshCacheData &data);
+    static void ComputeBBox(MeshCacheData &data);
+    static NodeAnim ClassifyNode(const std::string &name);
 
-    Assimp::Importer importer;
-    // pointer to loaded Assimp scene (assume you already have it)
-    const aiScene *scene = nullptr;
+    // node transform with the leg swing / body bob applied
+    glm::mat4 AnimateNode(const ModelNode &nd, const glm::mat4 &nodeTransform, float t) const;
 
     std::vector<MeshRenderData> meshes;
+    GeometryArena *arena = nullptr;   // shared buffers for this model's vertex format
+    std::vector<ModelNode> nodes;     // nodes[0] is the root
+    std::vector<uint32_t> nodeMeshes; // mesh indices, sliced by ModelNode::firstMesh/meshCount
+    std::vector<NodeAnim> nameAnim;   // by ModelNode::nameId
+    std::vector<glm::mat4> nodeWorld; // pose from the last Animate, one transform per node
     std::string directory;
+    glm::mat4 dequant = glm::mat4(1.0f);
+    int lodCount = 1;
+    float lodError[kMaxMeshLods] = {}; // per level, the largest error of any mesh
 
     void Cleanup();
 
-    // helper to load texture file, returns 0 on failure
-    static GLuint LoadTextureFromFile(const std::string &filename, bool &outHasAlpha, bool silent);
-    void ComputeBBoxRecursive(aiNode *node,
-                              const aiScene *scene,
-                              const glm::mat4 &parentTransform);
-    // Draw single mesh by index (used by DrawNodeAnimated)
-    void DrawMeshByIndex(unsigned int meshIndex, unsigned int shaderID) const;
+    struct Staging;
+    std::unique_ptr<Staging> staging; // result of Import() waiting for Upload()
+
+    // Import up to the mesh cache: open it, or parse the source and rewrite it (rebuilt = true)
+    bool ImportData(const std::string &path, Staging &st, bool &rebuilt);
+    // CPU side of the import: parse the file and fill data (vertex/index pointers reference the two vectors)
+    bool ImportWithAssimp(const std::string &path, const std::string &directory, MeshCacheData &data,
+                          std::vector<std::vector<SimpleVertex>> &verts,
+                          std::vector<std::vector<unsigned int>> &inds);
+    bool ImportObj(const std::string &path, const std::string &directory, MeshCacheData &data,
+                   std::vector<std::vector<SimpleVertex>> &verts,
+                   std::vector<std::vector<unsigned int>> &inds);
+    // glTF: meshes reference the mapped file held by the staging data
+    bool ImportGltf(const std::string &path, Staging &st);
+    // shared by all importers: texture path resolution and the alpha/hair heuristics
+    static void ApplyMaterial(MeshCacheMesh &dst, const std::string &materialName, const std::string &texFile,
+                              float opacity, const std::string &directory);
+    // quantize every mesh of data to PackedVertex inside one box shared by the whole model
+    static void PackVertices(const MeshCacheData &data, std::vector<std::vector<PackedVertex>> &packed,
+                             glm::mat4 &outDequant);
+    // freshly imported meshes: 16-bit index copies and, for VertexFormat::Packed, the packed vertices
+    void ConvertForUpload(Staging &st);
+    // GL side: create buffers/textures for every mesh staged by Import()
+    void UploadMeshes(const Staging &st);
+    // cache hit: decode the mesh into a mapped arena range; returns the geometry handle, 0 on failure
+    uint32_t UploadEncodedMesh(const MeshCacheMesh &src, const MeshQuantization &quant, GLenum &indexType);
+    // found reports whether the returned file exists (from the AssetIndex when it is built)
+    static std::string ResolveTexturePath(const std::string &texFile, const std::string &directory, bool &found);
+
+    // screen pixels per model space unit at the instance's nearest bounding sphere point, 0 without a bbox
+    float PixelsPerUnit(const glm::mat4 &model, const glm::vec3 &cameraPos, float projScale) const;
+    // glDrawElementsBaseVertex for one level of one mesh, the arena VAO bound; with instances > 0
+    // glDrawElementsInstancedBaseVertex, the instanced VAO bound
+    void DrawGeometry(const MeshRenderData &m, int lod, GLsizei instances = 0) const;
 };
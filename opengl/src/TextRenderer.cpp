@@ -1,4 +1,8 @@
 #include "TextRenderer.h"
+#include "AssetIndex.h"
+#include "AssetPack.h"
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <vector>
 #include <iostream>
@@ -9,32 +13,130 @@
 
 bool TextRenderer::LoadFont(const char *ttf_path, int px_height)
 {
-    std::ifstream in(ttf_path, std::ios::binary | std::ios::ate);
-    if (!in.is_open())
+    return BakeFont(ttf_path, px_height) && UploadFont();
+}
+
+// "<ttf>.<px>.atlas": header, the 96 baked glyphs, then the single-channel bitmap
+struct AtlasHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    int32_t pxHeight;
+    int32_t width;
+    int32_t height;
+    uint32_t reserved;
+};
+static const char kAtlasMagic[4] = {'F', 'A', 'T', 'L'};
+static const uint32_t kAtlasVersion = 1;
+
+std::string TextRenderer::CookedPathFor(const std::string &ttfPath, int pxHeight)
+{
+    return ttfPath + "." + std::to_string(pxHeight) + ".atlas";
+}
+
+bool TextRenderer::BakeFont(const char *ttf_path, int px_height)
+{
+    return ReadCooked(ttf_path, px_height) || Rasterize(ttf_path, px_height);
+}
+
+bool TextRenderer::ReadCooked(const std::string &ttfPath, int pxHeight)
+{
+    AssetData file;
+    if (!ReadAsset(CookedPathFor(ttfPath, pxHeight), file) || file.Size() < sizeof(AtlasHeader) + sizeof(atlas.data))
+        return false;
+    AtlasHeader h;
+    std::memcpy(&h, file.Data(), sizeof(h));
+    if (std::memcmp(h.magic, kAtlasMagic, sizeof(kAtlasMagic)) != 0 || h.version != kAtlasVersion ||
+        h.pxHeight != pxHeight || h.width <= 0 || h.height <= 0 ||
+        (size_t)h.width * h.height != file.Size() - sizeof(AtlasHeader) - sizeof(atlas.data))
+        return false;
+    if (h.sourceHash != AssetIndex::ContentHash(ttfPath))
+        return false;
+    const unsigned char *p = file.Data() + sizeof(AtlasHeader);
+    std::memcpy(atlas.data, p, sizeof(atlas.data));
+    atlas.width = h.width;
+    atlas.height = h.height;
+    bakedBitmap.assign(p + sizeof(atlas.data), file.Data() + file.Size());
+    return true;
+}
+
+bool TextRenderer::Rasterize(const char *ttf_path, int px_height)
+{
+    AssetData font;
+    if (!ReadAsset(ttf_path, font))
     {
         std::cerr << "Font not found: " << ttf_path << "\n";
         return false;
     }
-    size_t size = in.tellg();
-    in.seekg(0);
-    std::vector<unsigned char> buf(size);
-    in.read((char *)buf.data(), size);
-    in.close();
-
-    std::vector<unsigned char> bitmap(atlas.width * atlas.height);
-    int res = stbtt_BakeFontBitmap(buf.data(), 0, px_height, bitmap.data(), atlas.width, atlas.height, 32, 96, atlas.data);
+
+    bakedBitmap.assign(atlas.width * atlas.height, 0);
+    int res = stbtt_BakeFontBitmap(font.Data(), 0, px_height, bakedBitmap.data(), atlas.width, atlas.height, 32, 96, atlas.data);
     if (res <= 0)
     {
         std::cerr << "Font bake failed\n";
+        bakedBitmap.clear();
         return false;
     }
+    return true;
+}
+
+bool TextRenderer::CookFont(const std::string &ttfPath, int pxHeight, bool &rebuilt)
+{
+    rebuilt = false;
+    TextRenderer text;
+    if (text.ReadCooked(ttfPath, pxHeight))
+        return true;
+    uint64_t hash = AssetIndex::ContentHash(ttfPath);
+    if (hash == 0 || !text.Rasterize(ttfPath.c_str(), pxHeight))
+        return false;
+
+    AtlasHeader h;
+    std::memcpy(h.magic, kAtlasMagic, sizeof(kAtlasMagic));
+    h.version = kAtlasVersion;
+    h.sourceHash = hash;
+    h.pxHeight = pxHeight;
+    h.width = text.atlas.width;
+    h.height = text.atlas.height;
+    h.reserved = 0;
+    std::string path = CookedPathFor(ttfPath, pxHeight);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "TextRenderer: cannot write " << path << "\n";
+            return false;
+        }
+        out.write((const char *)&h, sizeof(h));
+        out.write((const char *)text.atlas.data, sizeof(text.atlas.data));
+        out.write((const char *)text.bakedBitmap.data(), (std::streamsize)text.bakedBitmap.size());
+        if (!out.good())
+            return false;
+    }
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    rebuilt = true;
+    return true;
+}
+
+bool TextRenderer::UploadFont()
+{
+    if (bakedBitmap.empty())
+        return false;
     glGenTextures(1, &atlas.tex);
     glBindTexture(GL_TEXTURE_2D, atlas.tex);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas.width, atlas.height, 0, GL_RED, GL_UNSIGNED_BYTE, bitmap.data());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas.width, atlas.height, 0, GL_RED, GL_UNSIGNED_BYTE, bakedBitmap.data());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     atlas.ok = true;
+    bakedBitmap.clear();
+    bakedBitmap.shrink_to_fit();
 
     // create VAO/VBO for quads (dynamic)
     glGenVertexArrays(1, &vao);
@@ -50,16 +152,16 @@ bool TextRenderer::LoadFont(const char *ttf_path, int px_height)
     return true;
 }
 
-void TextRenderer::RenderText(const std::string &text, float x_ndc, float y_ndc, float scale, const glm::vec3 &color, int screenW, int screenH, unsigned int shader)
+void TextRenderer::RenderText(const std::string &text, float x_ndc, float y_ndc, float scale, const glm::vec3 &color, int screenW, int screenH, const Shader &shader)
 {
     if (!atlas.ok)
         return;
-    glUseProgram(shader);
+    shader.use();
     // ortho uniform should be set by caller
-    glUniform3f(glGetUniformLocation(shader, "uColor"), color.x, color.y, color.z);
+    glUniform3f(shader.location(UniformId::Color), color.x, color.y, color.z);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, atlas.tex);
-    glUniform1i(glGetUniformLocation(shader, "uTex"), 0);
+    glUniform1i(shader.location(UniformId::Tex), 0);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
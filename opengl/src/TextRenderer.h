@@ -2,10 +2,12 @@
 #define TEXT_RENDERER_HPP
 
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "stb_truetype.h"
+#include "Shader.h"
 
 struct FontAtlas
 {
@@ -21,6 +23,20 @@ public:
     FontAtlas atlas;
     unsigned int vao = 0, vbo = 0;
     bool LoadFont(const char *ttf_path, int px_height = 48);
-    void RenderText(const std::string &text, float x_ndc, float y_ndc, float scale, const glm::vec3 &color, int screenW, int screenH, unsigned int shader);
+    // LoadFont split for parallel loading: BakeFont rasterizes the atlas (any thread),
+    // UploadFont creates the texture and quad buffers (GL thread).
+    // BakeFont reads the cooked "<ttf>.<px>.atlas" instead when it matches the font file.
+    bool BakeFont(const char *ttf_path, int px_height = 48);
+    bool UploadFont();
+    // Offline cook for asset_bake: write the atlas file unless an up-to-date one exists (rebuilt reports which)
+    static bool CookFont(const std::string &ttfPath, int pxHeight, bool &rebuilt);
+    static std::string CookedPathFor(const std::string &ttfPath, int pxHeight);
+    void RenderText(const std::string &text, float x_ndc, float y_ndc, float scale, const glm::vec3 &color, int screenW, int screenH, const Shader &shader);
+
+private:
+    bool ReadCooked(const std::string &ttfPath, int pxHeight);
+    bool Rasterize(const char *ttf_path, int px_height);
+
+    std::vector<unsigned char> bakedBitmap; // atlas waiting for UploadFont
 };
 #endif
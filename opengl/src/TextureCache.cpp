@@ -0,0 +1,770 @@
+// src/TextureCache.cpp
+#include "TextureCache.h"
+#include "AssetIndex.h"
+#include "AssetPack.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+// stb_image single-file loader
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// free video memory queries, not part of the core profile
+#ifndef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+
+void StbiDeleter::operator()(unsigned char *p) const { stbi_image_free(p); }
+
+TextureCache &TextureCache::Instance()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+void TextureCache::InitGL()
+{
+    bool s3tc = false, s3tcSrgb = false, bptc = false, nvxMemory = false, atiMemory = false;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (!ext)
+            continue;
+        std::string name(ext);
+        if (name == "GL_EXT_texture_compression_s3tc")
+            s3tc = true;
+        else if (name == "GL_EXT_texture_sRGB" || name == "GL_EXT_texture_compression_s3tc_srgb")
+            s3tcSrgb = true;
+        else if (name == "GL_ARB_texture_compression_bptc")
+            bptc = true;
+        else if (name == "GL_NVX_gpu_memory_info")
+            nvxMemory = true;
+        else if (name == "GL_ATI_meminfo")
+            atiMemory = true;
+    }
+
+    if (bptc)
+    {
+        opaqueFormat = BlockFormat::BC7;
+        alphaFormat = BlockFormat::BC7;
+        std::cout << "TextureCache: baking textures as BC7" << std::endl;
+    }
+    else if (s3tc && s3tcSrgb)
+    {
+        opaqueFormat = BlockFormat::BC1;
+        alphaFormat = BlockFormat::BC3;
+        std::cout << "TextureCache: baking textures as BC1/BC3" << std::endl;
+    }
+    else
+    {
+        std::cout << "TextureCache: no S3TC/BPTC support, baking RGBA8 mip chains" << std::endl;
+    }
+    bake = true;
+
+    // textures may take half of what is free now (KB); drivers that do not say get the default
+    GLint freeKb[4] = {0, 0, 0, 0};
+    if (nvxMemory)
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, freeKb);
+    else if (atiMemory)
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, freeKb);
+    if (freeKb[0] > 0)
+        SetBudget(std::min(kDefaultBudget, (size_t)freeKb[0] * 1024 / 2));
+    std::cout << "TextureCache: VRAM budget " << budget / (1024 * 1024) << " MB" << std::endl;
+}
+
+void TextureCache::SetBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    budget = bytes;
+}
+
+bool TextureCache::FormatSupported(BlockFormat fmt) const
+{
+    return fmt == opaqueFormat || fmt == alphaFormat;
+}
+
+static MipSettings MakeMipSettings(TextureColorSpace space, float alphaCutoff)
+{
+    MipSettings mips;
+    mips.srgb = space == TextureColorSpace::SRGB;
+    mips.alphaCutoff = alphaCutoff;
+    return mips;
+}
+
+std::string TextureCache::MakeKey(const std::string &path, TextureColorSpace space)
+{
+    std::string key;
+    const AssetIndex::Entry *indexed = AssetIndex::Instance().FindPath(path);
+    if (indexed && indexed->hash != 0)
+    {
+        // by content: identical images under different names share one texture
+        char hashKey[24];
+        snprintf(hashKey, sizeof(hashKey), "#%016llx", (unsigned long long)indexed->hash);
+        key = hashKey;
+    }
+    else
+    {
+        std::error_code ec;
+        std::filesystem::path canon = std::filesystem::weakly_canonical(path, ec);
+        key = ec ? path : canon.generic_string();
+    }
+    key += (space == TextureColorSpace::SRGB) ? "|srgb" : "|linear";
+    return key;
+}
+
+// fills out from 4-channel pixels owned by stb_image
+static void AdoptPixels(stbi_uc *data, int w, int h, DecodedImage &out)
+{
+    // if original channels < 4, n may be < 4; but we forced load to 4 -> check alpha content
+    out.hasAlpha = false;
+    for (int i = 0; i < w * h; ++i)
+    {
+        if (data[i * 4 + 3] < 250)
+        {
+            out.hasAlpha = true;
+            break;
+        } // loose test
+    }
+    out.width = w;
+    out.height = h;
+    out.pixels.reset(data);
+}
+
+bool TextureCache::DecodeFile(const std::string &filename, DecodedImage &out, bool silent)
+{
+    out = DecodedImage();
+    AssetData file;
+    if (!ReadAsset(filename, file))
+    {
+        if (!silent)
+            std::cerr << "stb_image failed to load: " << filename << " reason: can't open file\n";
+        return false;
+    }
+    int w, h, n;
+    stbi_uc *data = stbi_load_from_memory(file.Data(), (int)file.Size(), &w, &h, &n, 4); // force 4 channels (RGBA)
+    if (!data)
+    {
+        if (!silent)
+            std::cerr << "stb_image failed to load: " << filename << " reason: " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    AdoptPixels(data, w, h, out);
+    return true;
+}
+
+bool TextureCache::DecodeMemory(const unsigned char *bytes, size_t size, const std::string &name, DecodedImage &out)
+{
+    out = DecodedImage();
+    int w, h, n;
+    stbi_uc *data = stbi_load_from_memory(bytes, (int)size, &w, &h, &n, 4);
+    if (!data)
+    {
+        std::cerr << "stb_image failed to decode: " << name << " reason: " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    AdoptPixels(data, w, h, out);
+    return true;
+}
+
+GLuint TextureCache::UploadChain(const MipChain &chain, bool srgb, GLuint tex)
+{
+    if (chain.levels.empty())
+        return 0;
+    if (!tex)
+        glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLint internalFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    for (size_t l = 0; l < chain.levels.size(); ++l)
+        glTexImage2D(GL_TEXTURE_2D, (GLint)l, internalFormat, chain.levels[l].width, chain.levels[l].height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, chain.Data(l));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)chain.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // wrap repeat default
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+// shown until the first bake of an image exists (there is no small level to show yet)
+static GLuint UploadGreyPlaceholder(bool srgb)
+{
+    static const unsigned char grey[4] = {128, 128, 128, 255};
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+std::shared_ptr<TextureCache::Pending> TextureCache::StartPending(const std::string &path, TextureColorSpace space,
+                                                                   float alphaCutoff, const unsigned char *encoded,
+                                                                   size_t encodedSize)
+{
+    std::shared_ptr<Pending> p;
+    std::unique_lock<std::mutex> prepare;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        Entry &e = entries[MakeKey(path, space)];
+        if (e.pending)
+            return e.pending;
+        if (e.tex)
+            return nullptr;
+        p = e.pending = std::make_shared<Pending>();
+        // taken before the registry lock is released: everyone else sees p prepared
+        prepare = std::unique_lock<std::mutex>(p->mtx);
+        if (!workers)
+            workers.reset(new ThreadPool());
+    }
+    p->path = path;
+    p->mips = MakeMipSettings(space, alphaCutoff);
+
+    // a baked chain for the current source content only needs its pages read in
+    if (bake)
+    {
+        // the index already hashed the file at startup, no need to read it again here
+        uint64_t hash = encoded ? CompressedTexture::HashBytes(encoded, encodedSize) : AssetIndex::ContentHash(path);
+        if (hash != 0 && p->compressed->Open(CompressedTexture::PathFor(path), hash, p->mips) &&
+            FormatSupported(p->compressed->Format()))
+        {
+            p->hasAlpha = p->compressed->HasAlpha();
+            workers->Submit([this, p]()
+                            { PageIn(*p); });
+            return p;
+        }
+        p->compressed->Close();
+    }
+
+    // no bake yet: read the header only, for a first guess at alpha and to fail missing files now
+    AssetData file;
+    if (encoded)
+    {
+        p->encoded.assign(encoded, encoded + encodedSize);
+    }
+    else if (!ReadAsset(path, file))
+    {
+        std::cerr << "stb_image failed to load: " << path << " reason: can't open file\n";
+        p->done = true;
+        return p;
+    }
+    const unsigned char *bytes = encoded ? encoded : file.Data();
+    int size = (int)(encoded ? encodedSize : file.Size());
+    int w, h, comp;
+    if (!stbi_info_from_memory(bytes, size, &w, &h, &comp))
+    {
+        std::cerr << "stb_image failed to load: " << path << " reason: " << stbi_failure_reason() << "\n";
+        p->done = true;
+        return p;
+    }
+    p->hasAlpha = comp == 2 || comp == 4;
+    workers->Submit([this, p]()
+                    { DecodePending(*p); });
+    return p;
+}
+
+void TextureCache::PageIn(Pending &p)
+{
+    // fault the mapped chain in here instead of inside glCompressedTexImage2D on the GL thread
+    unsigned int sum = 0;
+    for (const auto &lv : p.compressed->Levels())
+    {
+        for (size_t i = 0; i < lv.size; i += 4096)
+            sum += lv.data[i];
+    }
+    volatile unsigned int sink = sum;
+    (void)sink;
+    {
+        std::lock_guard<std::mutex> lock(p.mtx);
+        p.ok = true;
+        p.done = true;
+    }
+    std::lock_guard<std::mutex> statsLock(mtx);
+    stats.compressedLoads++;
+}
+
+void TextureCache::DecodePending(Pending &p)
+{
+    const std::string &path = p.path;
+    MipSettings mips;
+    bool skipBaked;
+    {
+        std::lock_guard<std::mutex> lock(p.mtx);
+        mips = p.mips;
+        skipBaked = p.skipBaked;
+    }
+
+    // path and encoded are only written before the first job is queued
+    auto t0 = std::chrono::high_resolution_clock::now();
+    DecodedImage image;
+    bool ok = p.encoded.empty() ? DecodeFile(path, image, false)
+                                : DecodeMemory(p.encoded.data(), p.encoded.size(), path, image);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+
+    // bake for the next start and use the result right away so both runs look the same
+    bool baked = false;
+    uint64_t hash = 0;
+    std::string btxPath = CompressedTexture::PathFor(path);
+    if (ok && bake && !skipBaked)
+    {
+        if (!p.encoded.empty())
+            hash = CompressedTexture::HashBytes(p.encoded.data(), p.encoded.size());
+        else // the index holds the hash of the file as it was at startup
+            hash = p.reload ? CompressedTexture::HashSource(path) : AssetIndex::ContentHash(path);
+        BlockFormat fmt = image.hasAlpha ? alphaFormat : opaqueFormat;
+        baked = hash != 0 && CompressedTexture::Bake(btxPath, hash, fmt, image.pixels.get(), image.width,
+                                                     image.height, image.hasAlpha, mips);
+    }
+    MipChain chain;
+    if (ok && !baked)
+        BuildMipChain(image.pixels.get(), image.width, image.height, image.hasAlpha, mips, chain);
+
+    {
+        std::lock_guard<std::mutex> lock(p.mtx);
+        if (baked && !p.compressed->Open(btxPath, hash, mips))
+            BuildMipChain(image.pixels.get(), image.width, image.height, image.hasAlpha, mips, chain);
+        p.chain.levels.swap(chain.levels);
+        p.chain.pixels.swap(chain.pixels);
+        p.hasAlpha = image.hasAlpha;
+        p.ok = ok;
+        p.done = true;
+    }
+
+    std::lock_guard<std::mutex> statsLock(mtx);
+    stats.decodes++;
+    stats.decodeMs += ms;
+}
+
+void TextureCache::AccountBytes(Entry &e, size_t bytes, size_t rgba8Bytes)
+{
+    stats.residentBytes += bytes - e.bytes;
+    stats.rgba8Bytes += rgba8Bytes - e.rgba8Bytes;
+    e.bytes = bytes;
+    e.rgba8Bytes = rgba8Bytes;
+}
+
+int TextureCache::TailLevel(const CompressedTexture &c)
+{
+    return (int)c.LevelForSize(kPlaceholderSize);
+}
+
+bool TextureCache::UploadFull(Entry &e)
+{
+    Pending &p = *e.pending;
+    if (p.compressed->IsOpen())
+    {
+        // only the tail goes up now (it may already be the placeholder); detail requests bring in
+        // the levels that are actually needed
+        const CompressedTexture &c = *p.compressed;
+        int tail = TailLevel(c);
+        // the baked placeholder is exactly the tail; the grey one is not (nor the old image)
+        bool tailShown = !p.reload && e.tex && e.baseLevel == tail && e.bytes == c.TotalBytes(tail);
+        GLuint tex = tailShown ? e.tex : c.Upload(p.mips.srgb, tail, e.tex);
+        if (tex)
+        {
+            const CompressedTexture::Level &top = c.Levels()[0];
+            e.tex = tex;
+            e.baseLevel = tail;
+            AccountBytes(e, c.TotalBytes(tail), (size_t)top.width * top.height * 4 * 4 / 3);
+            e.source = std::move(p.compressed);
+            return true;
+        }
+        // the driver rejected the baked chain: build an RGBA8 one instead
+        std::shared_ptr<Pending> retry = e.pending;
+        p.compressed->Close();
+        p.skipBaked = true;
+        p.done = false;
+        workers->Submit([this, retry]()
+                        { DecodePending(*retry); });
+        return false;
+    }
+    e.tex = UploadChain(p.chain, p.mips.srgb, e.tex);
+    e.baseLevel = 0;
+    e.source.reset(); // a reloaded texture may have been baked before
+    const MipChain::Level &top = p.chain.levels[0];
+    AccountBytes(e, p.chain.pixels.size(), (size_t)top.width * top.height * 4 * 4 / 3);
+    p.chain = MipChain();
+    return true;
+}
+
+bool TextureCache::SetBaseLevel(Entry &e, int level)
+{
+    const CompressedTexture &c = *e.source;
+    bool srgb = e.srgb;
+    glBindTexture(GL_TEXTURE_2D, e.tex);
+    bool ok = true;
+    if (level < e.baseLevel)
+    {
+        ok = c.UploadLevels((size_t)level, (size_t)e.baseLevel, srgb);
+        if (ok)
+            stats.levelUploads += e.baseLevel - level;
+    }
+    else
+    {
+        // 0x0 images release the storage of levels that are no longer needed
+        GLint internalFormat = (GLint)CompressedTexture::GLFormat(c.Format(), srgb);
+        for (int l = e.baseLevel; l < level; ++l)
+            glTexImage2D(GL_TEXTURE_2D, l, internalFormat, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        stats.levelDrops += level - e.baseLevel;
+    }
+    if (ok)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        e.baseLevel = level;
+        AccountBytes(e, c.TotalBytes((size_t)level), e.rgba8Bytes);
+    }
+    else
+    {
+        std::cerr << "TextureCache: driver rejected mip levels of " << keyById[e.tex] << "\n";
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return ok;
+}
+
+void TextureCache::Prefetch(const std::string &path, TextureColorSpace space, float alphaCutoff)
+{
+    StartPending(path, space, alphaCutoff);
+}
+
+void TextureCache::PrefetchEncoded(const std::string &name, const unsigned char *data, size_t size,
+                                   TextureColorSpace space, float alphaCutoff)
+{
+    StartPending(name, space, alphaCutoff, data, size);
+}
+
+TextureHandle TextureCache::Acquire(const std::string &path, TextureColorSpace space, float alphaCutoff)
+{
+    TextureHandle h;
+    std::string key = MakeKey(path, space);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.tex)
+        {
+            Entry &e = it->second;
+            e.refs++;
+            stats.hits++;
+            stats.savedBytes += e.bytes;
+            h.id = e.tex;
+            h.hasAlpha = e.hasAlpha;
+            return h;
+        }
+    }
+
+    std::shared_ptr<Pending> p = StartPending(path, space, alphaCutoff);
+    if (!p)
+        return Acquire(path, space, alphaCutoff); // became resident meanwhile
+
+    std::lock_guard<std::mutex> lock(mtx);
+    Entry &e = entries[key];
+    std::lock_guard<std::mutex> pendingLock(p->mtx);
+    e.srgb = p->mips.srgb;
+    e.alphaCutoff = p->mips.alphaCutoff;
+    e.path = std::filesystem::path(path).lexically_normal().generic_string();
+    if (p->done && !p->ok)
+    {
+        entries.erase(key); // allow a later retry (e.g. the file appears)
+        return h;
+    }
+    if (p->done && UploadFull(e))
+    {
+        e.pending.reset();
+    }
+    else
+    {
+        // show the chain's tail (or grey) now, Update() swaps the full chain in later
+        if (p->compressed->IsOpen())
+        {
+            int first = TailLevel(*p->compressed);
+            e.tex = p->compressed->Upload(p->mips.srgb, first);
+            e.baseLevel = first;
+            if (e.tex)
+                AccountBytes(e, p->compressed->TotalBytes(first), 0);
+        }
+        if (!e.tex)
+        {
+            e.tex = UploadGreyPlaceholder(p->mips.srgb);
+            AccountBytes(e, 4, 0);
+        }
+        streaming.push_back(key);
+        stats.placeholders++;
+    }
+    e.hasAlpha = p->hasAlpha;
+    e.refs = 1;
+    keyById[e.tex] = key;
+    stats.uploads++;
+    stats.liveTextures++;
+
+    h.id = e.tex;
+    h.hasAlpha = e.hasAlpha;
+    return h;
+}
+
+void TextureCache::Update()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t uploaded = 0;
+    for (size_t i = 0; i < streaming.size() && uploaded < kStreamBytesPerFrame;)
+    {
+        auto it = entries.find(streaming[i]);
+        if (it == entries.end() || !it->second.pending)
+        {
+            streaming.erase(streaming.begin() + i); // released while loading
+            continue;
+        }
+        Entry &e = it->second;
+        std::shared_ptr<Pending> p = e.pending;
+        std::lock_guard<std::mutex> pendingLock(p->mtx);
+        if (!p->done)
+        {
+            ++i;
+            continue;
+        }
+        if (p->ok && !UploadFull(e))
+        {
+            ++i; // re-decoding after a rejected baked chain
+            continue;
+        }
+        if (p->ok)
+        {
+            uploaded += e.bytes;
+            e.hasAlpha = p->hasAlpha;
+            stats.streamed++;
+        }
+        e.pending.reset(); // a failed decode keeps its placeholder
+        streaming.erase(streaming.begin() + i);
+    }
+    UpdateResidency(uploaded);
+    frame++;
+}
+
+bool TextureCache::Reload(const std::string &path)
+{
+    std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+    std::lock_guard<std::mutex> lock(mtx);
+    bool found = false;
+    for (auto &kv : entries)
+    {
+        Entry &e = kv.second;
+        if (!e.tex || e.path != normalized)
+            continue;
+        // a load still running reads the old file; its result is simply never used
+        bool streamingAlready = e.pending != nullptr;
+        std::shared_ptr<Pending> p = std::make_shared<Pending>();
+        p->path = path;
+        p->mips = MakeMipSettings(e.srgb ? TextureColorSpace::SRGB : TextureColorSpace::Linear, e.alphaCutoff);
+        p->hasAlpha = e.hasAlpha;
+        p->reload = true;
+        e.pending = p;
+        if (!streamingAlready)
+            streaming.push_back(kv.first);
+        if (!workers)
+            workers.reset(new ThreadPool());
+        workers->Submit([this, p]()
+                        { DecodePending(*p); });
+        stats.reloads++;
+        found = true;
+    }
+    return found;
+}
+
+void TextureCache::RequestDetail(GLuint id, float uvPerPixel)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = keyById.find(id);
+    if (it == keyById.end())
+        return;
+    Entry &e = entries[it->second];
+    if (uvPerPixel <= 0.0f)
+        uvPerPixel = std::numeric_limits<float>::max();
+    e.uvPerPixel = e.lastUsed == frame ? std::min(e.uvPerPixel, uvPerPixel) : uvPerPixel;
+    e.lastUsed = frame;
+}
+
+// finest level a request needs: the one where a texel is at least as large as a pixel
+static int LevelForDetail(const CompressedTexture &c, float uvPerPixel)
+{
+    const CompressedTexture::Level &top = c.Levels()[0];
+    float level = std::floor(std::log2(uvPerPixel * (float)std::max(top.width, top.height)));
+    int last = (int)c.Levels().size() - 1;
+    return level >= (float)last ? last : (level <= 0.0f ? 0 : (int)level);
+}
+
+void TextureCache::UpdateResidency(size_t uploaded)
+{
+    struct Plan
+    {
+        Entry *e;
+        int target;
+        int tail;
+        int wanted;
+        bool used; // requested last frame
+    };
+    std::vector<Plan> plans;
+    size_t total = 0; // VRAM with every texture at its target
+    for (auto &kv : entries)
+    {
+        Entry &e = kv.second;
+        if (!e.tex)
+            continue;
+        if (!e.source)
+        {
+            total += e.bytes; // placeholders and RGBA8 chains stay as they are
+            continue;
+        }
+        Plan pl;
+        pl.e = &e;
+        pl.tail = TailLevel(*e.source);
+        pl.used = e.lastUsed == frame;
+        pl.wanted = pl.used ? LevelForDetail(*e.source, e.uvPerPixel) : e.baseLevel;
+        // finer levels are only released under pressure, so detail does not flicker with distance
+        pl.target = std::min(pl.wanted, e.baseLevel);
+        total += e.source->TotalBytes(pl.target);
+        plans.push_back(pl);
+    }
+    auto coarsen = [&](Plan &pl, int level)
+    {
+        level = std::min(level, pl.tail);
+        if (level <= pl.target)
+            return;
+        total -= pl.e->source->TotalBytes(pl.target) - pl.e->source->TotalBytes(level);
+        pl.target = level;
+    };
+
+    if (total > budget)
+    {
+        // 1. detail nobody asked for last frame
+        for (auto &pl : plans)
+            coarsen(pl, std::max(pl.target, pl.wanted));
+        // 2. idle textures down to their tail, least recently used first
+        std::sort(plans.begin(), plans.end(), [](const Plan &a, const Plan &b)
+                  { return a.e->lastUsed < b.e->lastUsed; });
+        for (size_t i = 0; i < plans.size() && total > budget && !plans[i].used; ++i)
+            coarsen(plans[i], plans[i].tail);
+        // 3. visible textures one level at a time, largest first
+        bool progress = true;
+        while (total > budget && progress)
+        {
+            progress = false;
+            std::sort(plans.begin(), plans.end(), [](const Plan &a, const Plan &b)
+                      { return a.target < b.target; });
+            for (size_t i = 0; i < plans.size() && total > budget; ++i)
+            {
+                int before = plans[i].target;
+                coarsen(plans[i], before + 1);
+                progress = progress || plans[i].target != before;
+            }
+        }
+    }
+
+    // releases first, so uploads never stack on top of levels that are about to go
+    for (auto &pl : plans)
+    {
+        if (pl.target > pl.e->baseLevel)
+            SetBaseLevel(*pl.e, pl.target);
+    }
+    // then the most recently used textures' missing levels, coarse to fine, until this frame's
+    // upload allowance is spent; the rest follows in later frames
+    std::sort(plans.begin(), plans.end(), [](const Plan &a, const Plan &b)
+              { return a.e->lastUsed > b.e->lastUsed; });
+    for (auto &pl : plans)
+    {
+        int level = pl.e->baseLevel;
+        while (level > pl.target)
+        {
+            size_t bytes = pl.e->source->Levels()[level - 1].size;
+            if (uploaded > 0 && uploaded + bytes > kStreamBytesPerFrame)
+                break;
+            uploaded += bytes;
+            level--;
+        }
+        if (level < pl.e->baseLevel)
+            SetBaseLevel(*pl.e, level);
+    }
+}
+
+size_t TextureCache::StreamingCount() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return streaming.size();
+}
+
+void TextureCache::Release(GLuint id)
+{
+    if (!id)
+        return;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = keyById.find(id);
+    if (it == keyById.end())
+    {
+        std::cerr << "TextureCache: release of unknown texture " << id << "\n";
+        return;
+    }
+    auto eit = entries.find(it->second);
+    if (eit != entries.end() && --eit->second.refs <= 0)
+    {
+        glDeleteTextures(1, &id);
+        stats.residentBytes -= eit->second.bytes;
+        stats.rgba8Bytes -= eit->second.rgba8Bytes;
+        stats.liveTextures--;
+        entries.erase(eit);
+        keyById.erase(it);
+    }
+}
+
+size_t TextureCache::ResidentBytes(GLuint id) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = keyById.find(id);
+    if (it == keyById.end())
+        return 0;
+    auto eit = entries.find(it->second);
+    return eit != entries.end() ? eit->second.bytes : 0;
+}
+
+bool TextureCache::HasAlpha(GLuint id) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = keyById.find(id);
+    if (it == keyById.end())
+        return false;
+    auto eit = entries.find(it->second);
+    return eit != entries.end() && eit->second.hasAlpha;
+}
+
+TextureCache::Stats TextureCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats s = stats;
+    s.budgetBytes = budget;
+    return s;
+}
+
+void TextureCache::PrintStats() const
+{
+    Stats s = GetStats();
+    const double mb = 1024.0 * 1024.0;
+    char line[512];
+    snprintf(line, sizeof(line),
+             "TextureCache: %u textures (%.2f MB VRAM, %.2f MB as RGBA8), %u from .btx, %u decodes in %.2f ms, "
+             "%u shared hits saved %.2f MB, %u placeholders, %u streamed in, budget %.0f MB, %u mip levels paged in, "
+             "%u released, %u reloaded",
+             s.liveTextures, s.residentBytes / mb, s.rgba8Bytes / mb, s.compressedLoads, s.decodes, s.decodeMs,
+             s.hits, s.savedBytes / mb, s.placeholders, s.streamed, s.budgetBytes / mb,
+             s.levelUploads, s.levelDrops, s.reloads);
+    std::cout << line << std::endl;
+}
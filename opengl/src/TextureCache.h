@@ -0,0 +1,198 @@
+// src/TextureCache.h
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "CompressedTexture.h"
+#include "MipChain.h"
+#include "ThreadPool.h"
+
+struct StbiDeleter
+{
+    void operator()(unsigned char *p) const;
+};
+
+// RGBA8 image decoded on a worker thread, waiting for its GL upload
+struct DecodedImage
+{
+    int width = 0;
+    int height = 0;
+    bool hasAlpha = false;
+    std::unique_ptr<unsigned char, StbiDeleter> pixels;
+};
+
+enum class TextureColorSpace
+{
+    SRGB,  // colour maps (diffuse)
+    Linear // data maps
+};
+
+struct TextureHandle
+{
+    GLuint id = 0;
+    bool hasAlpha = false;
+};
+
+// Process-wide registry of GL textures keyed by canonical file path + colour space.
+// Every Acquire() must be paired with a Release() of the returned id; the GL texture is
+// deleted when the last reference goes away. Decoding is shared as well: Prefetch() may be
+// called from several loader threads for the same file and only one of them decodes it.
+// Mip chains are built on the CPU (MipChain.h) and baked to .btx, never by the driver.
+//
+// Loading is progressive: nothing waits for a full-resolution image. Acquire() returns a texture
+// right away, showing the baked chain's tail (at most kPlaceholderSize square) or, before the first
+// bake, 1x1 grey. Background workers page in the baked chain or decode and bake the image, and
+// Update() respecifies the same texture name with the full chain at the next frame boundary, so
+// models never have to re-fetch their ids.
+//
+// Baked textures are only partly resident. While rendering, RequestDetail() reports how many
+// texels of a texture one screen pixel covers; Update() then keeps just the levels that fine
+// resident (GL_TEXTURE_BASE_LEVEL, finer levels uploaded from the mapped .btx or released).
+// It also keeps everything under a VRAM budget: idle textures are dropped to their tail first,
+// least recently used first, then visible ones lose detail one level at a time. RGBA8 chains
+// built without a bake are always fully resident.
+// alphaCutoff is the value a material alpha-tests the texture against (0: no test); the
+// first Prefetch()/Acquire() of a texture decides the coverage its mips preserve.
+class TextureCache
+{
+public:
+    static TextureCache &Instance();
+
+    // GL thread, once after the context exists and before any Prefetch(): picks the block
+    // format to bake into (BC7 with BPTC, else BC1/BC3 with S3TC, else plain RGBA8) and
+    // enables baking.
+    void InitGL();
+
+    // CPU phase, any thread: open the baked chain or queue the decode unless the texture is
+    // already resident or loading; returns without waiting for either.
+    void Prefetch(const std::string &path, TextureColorSpace space, float alphaCutoff = 0.0f);
+    // CPU phase, any thread: same for an encoded image inside another file (GLB buffer view,
+    // data: URI). name stands in for the path in Acquire(); the bytes are copied for the decoder.
+    void PrefetchEncoded(const std::string &name, const unsigned char *data, size_t size, TextureColorSpace space,
+                         float alphaCutoff = 0.0f);
+    // GL thread: returns a referenced texture (id 0 if the file cannot be read). It may still show
+    // the placeholder; hasAlpha is then the baked value or, before the first bake, a guess from
+    // the file's channel count.
+    TextureHandle Acquire(const std::string &path, TextureColorSpace space, float alphaCutoff = 0.0f);
+    void Release(GLuint id);
+    // VRAM held by texture id (mips included), 0 if unknown
+    size_t ResidentBytes(GLuint id) const;
+    // whether texture id has alpha: Acquire()'s guess until its decode or baked chain is in, then final
+    bool HasAlpha(GLuint id) const;
+    // GL thread, once per frame before drawing: swap finished full chains into their textures and
+    // apply the last frame's detail requests under the budget, up to kStreamBytesPerFrame of
+    // uploads (at least one level) per call
+    void Update();
+    size_t StreamingCount() const;
+    // GL thread, while rendering: a draw samples texture id with uvPerPixel texture coordinate
+    // units across one screen pixel (0: constant UVs, the 1x1 level is enough)
+    void RequestDetail(GLuint id, float uvPerPixel);
+    // VRAM the textures may hold; InitGL() sets it from the driver's free memory when it tells
+    void SetBudget(size_t bytes);
+    // GL thread, hot reload: path changed on disk. Every live texture made from it is decoded (and
+    // baked) again in the background and Update() respecifies the same texture name, so the models
+    // using it keep their ids. false if no texture comes from path.
+    bool Reload(const std::string &path);
+
+    static const int kPlaceholderSize = 32;
+    static const size_t kStreamBytesPerFrame = 16 * 1024 * 1024;
+    static const size_t kDefaultBudget = 256 * 1024 * 1024;
+
+    struct Stats
+    {
+        unsigned int decodes = 0;         // files actually decoded
+        unsigned int compressedLoads = 0; // served from a baked .btx without decoding
+        double decodeMs = 0.0;            // total time spent in stb_image
+        unsigned int uploads = 0;         // GL textures created
+        unsigned int hits = 0;            // Acquire() calls served by an existing texture
+        size_t residentBytes = 0;         // VRAM held by live textures (mips included)
+        size_t rgba8Bytes = 0;            // what the live textures would take as RGBA8
+        size_t savedBytes = 0;            // VRAM that the hits would otherwise have allocated
+        unsigned int liveTextures = 0;
+        unsigned int placeholders = 0;    // textures first shown at placeholder resolution
+        unsigned int streamed = 0;        // full chains swapped in by Update()
+        unsigned int reloads = 0;         // textures rebuilt after their file changed
+        size_t budgetBytes = 0;
+        unsigned int levelUploads = 0;    // mip levels made resident by detail requests
+        unsigned int levelDrops = 0;      // mip levels released for the budget
+    };
+    Stats GetStats() const;
+    void PrintStats() const;
+
+    static bool DecodeFile(const std::string &path, DecodedImage &out, bool silent);
+    static bool DecodeMemory(const unsigned char *data, size_t size, const std::string &name, DecodedImage &out);
+
+private:
+    TextureCache() = default;
+
+    // One texture on its way in. The thread that creates it prepares it (cheap: header checks)
+    // with mtx held, a worker then finishes it; Acquire/Update read it under mtx.
+    struct Pending
+    {
+        std::mutex mtx;
+        bool done = false; // worker finished
+        bool ok = false;
+        bool hasAlpha = false; // final once done, a guess before
+        bool skipBaked = false; // the driver rejected the baked chain, build an RGBA8 one
+        bool reload = false;    // Reload(): the file changed since the index hashed it
+        std::string path;
+        MipSettings mips;
+        std::vector<unsigned char> encoded; // PrefetchEncoded: the image bytes
+        std::unique_ptr<CompressedTexture> compressed{new CompressedTexture()}; // baked chain, preferred when open
+        MipChain chain;                     // RGBA8 chain otherwise
+    };
+    struct Entry
+    {
+        GLuint tex = 0;
+        int refs = 0;
+        bool hasAlpha = false;
+        bool srgb = false;
+        float alphaCutoff = 0.0f;
+        std::string path; // source file (normalized), for Reload()
+        size_t bytes = 0;
+        size_t rgba8Bytes = 0;
+        std::shared_ptr<Pending> pending; // loading, or showing a placeholder until Update()
+        // residency, baked textures only: source stays mapped for levels to be paged back in
+        std::unique_ptr<CompressedTexture> source;
+        int baseLevel = 0;                  // finest resident level (GL_TEXTURE_BASE_LEVEL)
+        float uvPerPixel = 0.0f;            // finest RequestDetail() of frame lastUsed
+        unsigned int lastUsed = 0;          // frame of the last request
+    };
+
+    static std::string MakeKey(const std::string &path, TextureColorSpace space);
+    // returns the pending load for path, creating and starting it if there is none;
+    // nullptr if the texture is already resident
+    std::shared_ptr<Pending> StartPending(const std::string &path, TextureColorSpace space, float alphaCutoff,
+                                          const unsigned char *encoded = nullptr, size_t encodedSize = 0);
+    // worker jobs
+    void PageIn(Pending &p);
+    void DecodePending(Pending &p);
+    // GL thread, mtx and e.pending->mtx held: upload the finished chain into e.tex (created if 0).
+    // false if the driver rejected a baked chain and an RGBA8 one is being built instead.
+    bool UploadFull(Entry &e);
+    // level from which source levels are shown as placeholder and kept when idle
+    static int TailLevel(const CompressedTexture &c);
+    // GL thread, mtx held: make levels [level, end) of e.source resident; false if rejected
+    bool SetBaseLevel(Entry &e, int level);
+    // GL thread, mtx held: pick every baked texture's base level for the requests and the budget,
+    // release levels, then upload up to uploadBudget bytes of new ones
+    void UpdateResidency(size_t uploadBudget);
+    void AccountBytes(Entry &e, size_t bytes, size_t rgba8Bytes);
+    static GLuint UploadChain(const MipChain &chain, bool srgb, GLuint tex);
+    bool FormatSupported(BlockFormat fmt) const;
+
+    mutable std::mutex mtx;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<GLuint, std::string> keyById;
+    std::vector<std::string> streaming; // keys of entries showing a placeholder
+    size_t budget = kDefaultBudget;
+    unsigned int frame = 1; // advanced by Update()
+    Stats stats;
+    bool bake = false;                            // set by InitGL()
+    BlockFormat opaqueFormat = BlockFormat::None; // None bakes RGBA8 chains
+    BlockFormat alphaFormat = BlockFormat::None;
+    std::unique_ptr<ThreadPool> workers; // created on first use; declared last so it is joined first
+};
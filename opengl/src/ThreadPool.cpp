@@ -0,0 +1,175 @@
+// src/ThreadPool.cpp
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int workers)
+{
+    if (workers == 0)
+    {
+        unsigned int hw = std::thread::hardware_concurrency();
+        workers = hw > 1 ? hw - 1 : 1; // leave one core for the GL/main thread
+    }
+    for (unsigned int i = 0; i < workers; ++i)
+        threads.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    jobCv.notify_all();
+    for (auto &t : threads)
+        t.join();
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobs.push_back(std::move(job));
+    }
+    jobCv.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    idleCv.wait(lock, [this]
+                { return jobs.empty() && running == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            jobCv.wait(lock, [this]
+                       { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty())
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++running;
+        }
+        job();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            --running;
+            if (jobs.empty() && running == 0)
+                idleCv.notify_all();
+        }
+    }
+}
+
+namespace
+{
+// one ParallelFor call, shared with the helpers that join it
+struct ForTask
+{
+    size_t count = 0;
+    const std::function<void(size_t)> *body = nullptr;
+    std::atomic<size_t> next{0};
+    unsigned int helpers = 0; // helpers working on it, ForHelpers::mtx
+};
+
+class ForHelpers
+{
+public:
+    static ForHelpers &Instance()
+    {
+        static ForHelpers helpers;
+        return helpers;
+    }
+
+    unsigned int Count() const { return (unsigned int)threads.size(); }
+
+    void Run(ForTask &task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(&task);
+        }
+        taskCv.notify_all();
+        for (size_t i = task.next++; i < task.count; i = task.next++)
+            (*task.body)(i);
+
+        // no helper joins once the task is off the queue; wait for those still on an item
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = std::find(tasks.begin(), tasks.end(), &task);
+        if (it != tasks.end())
+            tasks.erase(it);
+        doneCv.wait(lock, [&task]
+                    { return task.helpers == 0; });
+    }
+
+private:
+    ForHelpers()
+    {
+        unsigned int hw = std::thread::hardware_concurrency();
+        for (unsigned int i = 1; i < hw; ++i)
+            threads.emplace_back(&ForHelpers::HelperLoop, this);
+    }
+
+    ~ForHelpers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        taskCv.notify_all();
+        for (auto &t : threads)
+            t.join();
+    }
+
+    void HelperLoop()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;)
+        {
+            taskCv.wait(lock, [this]
+                        { return stopping || !tasks.empty(); });
+            if (stopping)
+                return;
+            ForTask &task = *tasks.front();
+            if (task.next >= task.count)
+            {
+                tasks.pop_front(); // every item taken, its caller finishes it
+                continue;
+            }
+            ++task.helpers;
+            lock.unlock();
+            for (size_t i = task.next++; i < task.count; i = task.next++)
+                (*task.body)(i);
+            lock.lock();
+            if (--task.helpers == 0)
+                doneCv.notify_all();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::deque<ForTask *> tasks; // calls with items left, oldest first
+    std::mutex mtx;
+    std::condition_variable taskCv;
+    std::condition_variable doneCv;
+    bool stopping = false;
+};
+}
+
+void ParallelFor(size_t count, const std::function<void(size_t)> &body)
+{
+    if (count <= 1 || ForHelpers::Instance().Count() == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            body(i);
+        return;
+    }
+    ForTask task;
+    task.count = count;
+    task.body = &body;
+    ForHelpers::Instance().Run(task);
+}
@@ -0,0 +1,45 @@
+// src/ThreadPool.h
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads executing queued jobs in FIFO order.
+class ThreadPool
+{
+public:
+    // workers == 0 picks hardware_concurrency() - 1 (at least one)
+    explicit ThreadPool(unsigned int workers = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Submit(std::function<void()> job);
+    // block until the queue is empty and no job is running
+    void WaitIdle();
+    unsigned int WorkerCount() const { return (unsigned int)threads.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mtx;
+    std::condition_variable jobCv;
+    std::condition_variable idleCv;
+    unsigned int running = 0;
+    bool stopping = false;
+};
+
+// Run body(i) for every i in [0, count) on the calling thread, joined by whichever of a process-wide
+// set of hardware_concurrency() - 1 helper threads are idle. The helpers are started once and shared
+// by every call, also nested ones (a body calling ParallelFor) and calls from ThreadPool workers, so
+// the thread count stays fixed however many jobs use it at once. The caller works through the items
+// itself and never waits for a helper to become free, so this cannot deadlock; with count <= 1 or a
+// single core it runs inline. Meant for data-parallel steps inside an asset job; it never touches a
+// ThreadPool.
+void ParallelFor(size_t count, const std::function<void(size_t)> &body);
@@ -84,7 +84,7 @@ void UI::UpdateMouse(float mouseNDCx, float mouseNDCy, bool mouseDown, int winW,
 }
 
 // 内部工具：画一个屏幕空间矩形（NDC）并填充颜色
-static void DrawRectNDC(TextRenderer &text, unsigned int textShader,
+static void DrawRectNDC(TextRenderer &text, const Shader &textShader,
                         float cx, float cy, float w, float h, glm::vec3 color)
 {
     glDisable(GL_DEPTH_TEST);
@@ -101,14 +101,14 @@ static void DrawRectNDC(TextRenderer &text, unsigned int textShader,
         x1, y1, 1, 1,
         x0, y1, 0, 1};
 
-    glUseProgram(textShader);
+    textShader.use();
     glm::mat4 ortho = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
-    glUniformMatrix4fv(glGetUniformLocation(textShader, "uOrtho"), 1, GL_FALSE, &ortho[0][0]);
-    glUniform3f(glGetUniformLocation(textShader, "uColor"), color.r, color.g, color.b);
+    glUniformMatrix4fv(textShader.location(UniformId::Ortho), 1, GL_FALSE, &ortho[0][0]);
+    glUniform3f(textShader.location(UniformId::Color), color.r, color.g, color.b);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, text.atlas.tex);
-    glUniform1i(glGetUniformLocation(textShader, "uTex"), 0);
+    glUniform1i(textShader.location(UniformId::Tex), 0);
 
     glBindVertexArray(text.vao);
     glBindBuffer(GL_ARRAY_BUFFER, text.vbo);
@@ -117,7 +117,7 @@ static void DrawRectNDC(TextRenderer &text, unsigned int textShader,
     glBindVertexArray(0);
 }
 
-void UI::Render(int winW, int winH, unsigned int textShader, bool gameover)
+void UI::Render(int winW, int winH, const Shader &textShader, bool gameover)
 {
     glDisable(GL_DEPTH_TEST);
 
@@ -144,7 +144,7 @@ void UI::Render(int winW, int winH, unsigned int textShader, bool gameover)
     glEnable(GL_DEPTH_TEST);
 }
 
-void UI::RenderHUD(int winW, int winH, unsigned int textShader,
+void UI::RenderHUD(int winW, int winH, const Shader &textShader,
                    int playerHealth, int playerMaxHealth,
                    float stamina,
                    int score,
@@ -212,7 +212,7 @@ void UI::RenderHUD(int winW, int winH, unsigned int textShader,
     glEnable(GL_DEPTH_TEST);
 }
 
-void UI::RenderGameOver(int winW, int winH, unsigned int textShader,
+void UI::RenderGameOver(int winW, int winH, const Shader &textShader,
                        int currentScore,
                        const std::vector<int> &leaderboard)
 {
@@ -23,17 +23,17 @@ public:
     void UpdateMouse(float mx, float my, bool mousePressed, int winW, int winH, int *outAction, bool gameOver); // outAction: 0 none, 1 start, 2 quit, 3 retry
 
     // 渲染菜单界面（开始/结束）
-    void Render(int winW, int winH, unsigned int textShader, bool gameOver);
+    void Render(int winW, int winH, const Shader &textShader, bool gameOver);
 
     // 在游戏进行中渲染 HUD：血条 & 体力条
-    void RenderHUD(int winW, int winH, unsigned int textShader,
+    void RenderHUD(int winW, int winH, const Shader &textShader,
                    int playerHealth, int playerMaxHealth,
                    float stamina,
                    int score,
                    float hitEffectTimer);
 
     // 渲染 GameOver 界面：显示排行榜和当前分数
-    void RenderGameOver(int winW, int winH, unsigned int textShader,
+    void RenderGameOver(int winW, int winH, const Shader &textShader,
                        int currentScore,
                        const std::vector<int> &leaderboard);
 };
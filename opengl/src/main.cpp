@@ -24,6 +24,15 @@
 #include "UI.h"
 #include "Game.h"
 #include "Audio.h"
+#include "AssetIndex.h"
+#include "AssetPack.h"
+#include "AssetLoader.h"
+#include "ResourceManager.h"
+#include "TextureCache.h"
+#include "GeometryArena.h"
+#include "HotReload.h"
+#include "SharedUniforms.h"
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -138,67 +147,112 @@ int main()
     glEnable(GL_DEPTH_TEST);
     glDisable(GL_BLEND);
     glEnable(GL_FRAMEBUFFER_SRGB);
+    TextureCache::Instance().InitGL();
+    SharedUniforms::Instance().InitGL();
     std::string base = GetExecutableDir();
+    // shaders and assets come out of one mapped pack; without assets.pak the loose copies are read
+    AssetPack::Instance().Mount(base + "/assets.pak", base);
+    // index assets (and the Blender texture folder the MTL files point into) before anything is loaded
+    std::vector<std::string> assetRoots = {base + "/assets"};
+    size_t openglPos = base.find("opengl");
+    if (openglPos != std::string::npos)
+        assetRoots.push_back(base.substr(0, openglPos) + "blender/textures");
+    AssetIndex::Instance().Build(assetRoots, base + "/asset_manifest.txt");
     Audio audio;
     audio.Init();
-    unsigned int dropBuffer = audio.LoadWAV(base + "/assets/sound/drop.wav");
-    audio.PlaySound(dropBuffer, true); // loop background sound
+    ResourceManager::Instance().SetAudio(&audio);
+    UI ui;
+    Game game;
+
+    // Queue every asset first: decoding/parsing runs on worker threads while this thread
+    // compiles the shaders below, then Finish() performs the GL uploads here.
+    AssetLoader loader;
+    ResourceHandle dropSound = ResourceManager::Instance().AddSound(base + "/assets/sound/drop.wav");
+    ResourceManager::Instance().SetPinned(dropSound, true); // loops for the whole run
+    ResourceManager::Instance().Queue(loader, dropSound);
+    std::string fontPath = base + "/assets/fonts/Roboto-Regular.ttf"; // ensure assets/Roboto-Regular.ttf exists relative to build dir
+    loader.Add("Roboto-Regular.ttf",
+               [&]()
+               { return ui.text.BakeFont(fontPath.c_str(), 48); },
+               [&]()
+               { return ui.text.UploadFont(); });
+    game.QueueResources(loader, base + "/assets");
+    // Load walk_cat.obj model file
+    std::string modelPath = base + "/assets/models/cat_for_opengl.obj";
+    game.QueuePlayerModel(loader, modelPath);
+
     Shader shader3D(
         (base + "/shaders/phong.vs").c_str(),
         (base + "/shaders/phong.fs").c_str());
     Shader shadowShader((base + "/shaders/shadow_depth.vs").c_str(), (base + "/shaders/shadow_depth.fs").c_str());
 
     Shader shaderText((base + "/shaders/text.vs").c_str(), (base + "/shaders/text.fs").c_str());
-    UI ui;
-    ui.Init((base + "/assets/fonts/Roboto-Regular.ttf").c_str(), 48); // ensure assets/Roboto-Regular.ttf exists relative to build dir
-    Game game;
-    game.LoadResources(base + "/assets");
-    game.shadowShader = shadowShader.ID;
+    Shader collectibleShader((base + "/shaders/collectible.vs").c_str(), (base + "/shaders/phong.fs").c_str());
+
+    loader.Finish();
+    TextureCache::Instance().PrintStats();
+    GeometryArena::PrintStats();
+    ResourceManager::Instance().PrintStats();
+    audio.PlaySound(ResourceManager::Instance().GetSound(dropSound), true); // loop background sound
+
+    game.shadowShader = &shadowShader;
+    game.collectibleShader = &collectibleShader;
+#ifdef HELLOGL_HOT_RELOAD
+    // saving a shader, model, material or texture reloads just that file; edits in the source tree
+    // are copied over the build tree copies the game reads
+    Shader *shaders[] = {&shader3D, &shadowShader, &shaderText, &collectibleShader};
+    HotReload &hotReload = HotReload::Instance();
+    for (const auto &root : assetRoots)
+        hotReload.Watch(root);
+    hotReload.Watch(base + "/shaders");
+    std::error_code sameEc;
+    if (!std::filesystem::equivalent(HELLOGL_SOURCE_DIR, base, sameEc))
+    {
+        hotReload.Watch(std::string(HELLOGL_SOURCE_DIR) + "/shaders", base + "/shaders");
+        hotReload.Watch(std::string(HELLOGL_SOURCE_DIR) + "/assets", base + "/assets");
+    }
+    hotReload.AddListener([&](const std::string &path)
+                          {
+                              for (Shader *s : shaders)
+                              {
+                                  if (s->uses(path))
+                                      s->beginReload();
+                              }
+                              TextureCache::Instance().Reload(path);
+                              ResourceManager::Instance().Reload(path);
+                          });
+#endif
     game.Reset();
     game.InitShadowMap();
-    // Load walk_cat.obj model file
-    std::string modelPath = base + "/assets/models/cat_for_opengl.obj";
-    game.LoadPlayerModel(modelPath.c_str());
-    game.playerModel.modelScale = glm::vec3(0.5f);
-    std::vector<float> data;
-
-    float cubeVerts[] = {
-        -0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f,
-        0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f,
-        0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f,
-        -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, -0.5f, -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f, -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f,
-        0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f, -0.5f, -0.5f,
-        0.5f, -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f,
-        -0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f, 0.5f,
-        0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, -0.5f,
-        -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f,
-        0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, -0.5f};
-    // duplicate colors for each vertex: use single color attribute per draw by setting vertex attribute 1 as constant via glVertexAttrib3f later
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVerts), cubeVerts, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    // set attribute 1 to be constant color using glVertexAttrib3f before drawing
-    glBindVertexArray(0);
-    // store vao id in a global known to Game::Render via binding assumption:
-    // We'll attach VAO id to glObjectLabel? Simpler: set as global
-    glBindVertexArray(VAO); // keep bound for draw calls later (we'll not unbind)
-    // To make it accessible, set to 1 (not ideal), but we'll use VAO 1 implicitly
-    // after creating VAO (variable name VAO)
-    game.SetCubeVAO(VAO);
+    ResourceManager::Instance().SetModelScale(game.playerHandle, glm::vec3(0.5f));
+    game.InitCollectibles();
     // Create Text renderer and UI
 
     auto last = std::chrono::high_resolution_clock::now();
 
+    bool texturesStreamed = false;
+    // uniforms are set through the handles Shader resolved at link time; the loop should add nothing here
+    unsigned long long lookupsBefore = Shader::stringLookups;
     while (!glfwWindowShouldClose(win))
     {
         glfwPollEvents();
+#ifdef HELLOGL_HOT_RELOAD
+        // programs rebuilt last frame go in (their link has had a frame to finish), then this frame's
+        // file changes start their reloads
+        for (Shader *s : shaders)
+            s->finishReload();
+        hotReload.Poll();
+#endif
+        // frame boundary: full-resolution textures replace their placeholders here and the mip levels
+        // the last frame asked for (Game::Render) are paged in or released
+        TextureCache::Instance().Update();
+        // lazily requested assets finish loading here, cold ones are evicted over budget
+        ResourceManager::Instance().Update();
+        if (!texturesStreamed && TextureCache::Instance().StreamingCount() == 0)
+        {
+            texturesStreamed = true;
+            TextureCache::Instance().PrintStats();
+        }
         auto now = std::chrono::high_resolution_clock::now();
         float dt = std::chrono::duration<float>(now - last).count();
         last = now;
@@ -312,18 +366,17 @@ int main()
         }
         if (state == State::PLAYING)
         {
-            glBindVertexArray(VAO);
-            shader3D.use();
-            shader3D.setMat4("uView", view);
-            shader3D.setMat4("uProj", proj);
+            // camera for every program that reads the Frame block
+            SharedUniforms::Instance().SetFrame(view, proj, cameraPos, (float)glfwGetTime());
 
             // now render the game (Game::Render should bind VAO and use shader uniforms)
-            game.Render(shader3D.ID, dt, cameraPos);
+            game.SetProjection(glm::radians(aspect), H);
+            game.Render(shader3D, dt, cameraPos);
 
             glBindVertexArray(0);
 
             // 在游戏中绘制 HUD（血条 & 体力条），以及计时器
-            ui.RenderHUD(winW, winH, shaderText.ID,
+            ui.RenderHUD(winW, winH, shaderText,
                          game.playerHealth, game.playerMaxHealth,
                          game.player.stamina,
                          game.score,
@@ -332,7 +385,7 @@ int main()
             survivalTime += dt;
             char buf[64];
             snprintf(buf, sizeof(buf), "Time: %.2f s", survivalTime);
-            ui.text.RenderText(buf, -0.98f, 0.9f, 0.8f, glm::vec3(0.95f), winW, winH, shaderText.ID);
+            ui.text.RenderText(buf, -0.98f, 0.9f, 0.8f, glm::vec3(0.95f), winW, winH, shaderText);
         }
         // draw UI overlays（菜单 / 结束界面）
         if (state != State::PLAYING)
@@ -342,8 +395,8 @@ int main()
             if (state == State::MENU)
             {
                 // 主菜单界面
-                ui.Render(winW, winH, shaderText.ID, false);
-                ui.text.RenderText("CAT DODGE", -0.35f, 0.45f, 1.8f, glm::vec3(0.95f), winW, winH, shaderText.ID);
+                ui.Render(winW, winH, shaderText, false);
+                ui.text.RenderText("CAT DODGE", -0.35f, 0.45f, 1.8f, glm::vec3(0.95f), winW, winH, shaderText);
             }
             else if (state == State::GAMEOVER)
             {
@@ -354,11 +407,17 @@ int main()
                 if (leaderboard.size() > 10)
                     leaderboard.resize(10);
                 
-                ui.RenderGameOver(winW, winH, shaderText.ID, game.score, leaderboard);
+                ui.RenderGameOver(winW, winH, shaderText, game.score, leaderboard);
             }
         }
         glfwSwapBuffers(win);
     }
+    ResourceManager::Instance().PrintStats();
+    game.queue.PrintStats();
+    std::cout << "Uniform name lookups in the render loop: " << Shader::stringLookups - lookupsBefore << std::endl;
+    HotReload::Instance().Shutdown();
+    SharedUniforms::Instance().Shutdown();
+    ResourceManager::Instance().Shutdown();
     audio.Shutdown();
     glfwTerminate();
     return 0;
@@ -0,0 +1,269 @@
+// tools/AssetBake.cpp
+// Cooks everything HelloGL would otherwise build on first start, next to the sources:
+//   models   -> "<model>.smc"       (import + optimize, see MeshCache)
+//   images   -> "<image>.btx"       (block-compressed mip chain, see CompressedTexture)
+//   fonts    -> "<ttf>.<px>.atlas"  (rasterized glyph atlas)
+//   sounds   -> "<wav>.pcm"         (decoded and resampled PCM)
+// Every artifact stores the content hash of its inputs, so a rerun only cooks what changed: the
+// asset index supplies the hashes of unchanged files from its manifest and each job compares them
+// with the artifact header before doing any work. Models are cooked first because their materials
+// add the texture jobs (maps outside the asset tree, e.g. blender/textures); every stage runs its
+// jobs in parallel.
+// usage: asset_bake [--bc7] [--font-px N] [--textures DIR]... <assets dir>
+#include "AssetIndex.h"
+#include "Audio.h"
+#include "CompressedTexture.h"
+#include "StaticModel.h"
+#include "TextRenderer.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::high_resolution_clock;
+
+enum class JobKind
+{
+    Mesh,
+    Texture,
+    Font,
+    Sound
+};
+
+struct BakeJob
+{
+    JobKind kind;
+    std::string source;
+    bool ok = false;
+    bool rebuilt = false;
+    double ms = 0.0;
+    // Mesh: diffuse maps its materials reference, with their alpha cutoff
+    std::vector<std::pair<std::string, float>> textures;
+    float alphaCutoff = 0.0f; // Texture: coverage the mips preserve
+};
+
+struct BakeOptions
+{
+    BlockFormat opaqueFormat = BlockFormat::BC1;
+    BlockFormat alphaFormat = BlockFormat::BC3;
+    std::vector<int> fontSizes;
+};
+
+static std::string Lower(std::string s)
+{
+    for (auto &c : s)
+        c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+static JobKind ClassifyExtension(const std::string &ext, bool &known)
+{
+    known = true;
+    if (ext == ".obj" || ext == ".fbx" || ext == ".dae" || ext == ".3ds" || ext == ".ply" || ext == ".stl")
+        return JobKind::Mesh;
+    if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp")
+        return JobKind::Texture;
+    if (ext == ".ttf" || ext == ".otf")
+        return JobKind::Font;
+    if (ext == ".wav")
+        return JobKind::Sound;
+    known = false; // .gltf/.glb are read in place, everything else is not an asset we cook
+    return JobKind::Mesh;
+}
+
+static bool BakeTexture(const std::string &path, float alphaCutoff, const BakeOptions &opt, bool &rebuilt)
+{
+    rebuilt = false;
+    uint64_t hash = AssetIndex::ContentHash(path);
+    if (hash == 0)
+        return false;
+    // the game only loads colour maps (TextureColorSpace::SRGB)
+    MipSettings mips;
+    mips.alphaCutoff = alphaCutoff;
+    std::string btxPath = CompressedTexture::PathFor(path);
+    CompressedTexture existing;
+    if (existing.Open(btxPath, hash, mips) &&
+        existing.Format() == (existing.HasAlpha() ? opt.alphaFormat : opt.opaqueFormat))
+        return true;
+    existing.Close();
+
+    DecodedImage img;
+    if (!TextureCache::DecodeFile(path, img, false))
+        return false;
+    BlockFormat fmt = img.hasAlpha ? opt.alphaFormat : opt.opaqueFormat;
+    rebuilt = CompressedTexture::Bake(btxPath, hash, fmt, img.pixels.get(), img.width, img.height, img.hasAlpha,
+                                      mips);
+    return rebuilt;
+}
+
+static void RunJob(BakeJob &job, const BakeOptions &opt)
+{
+    Clock::time_point t0 = Clock::now();
+    switch (job.kind)
+    {
+    case JobKind::Mesh:
+    {
+        StaticModel model;
+        job.ok = model.Bake(job.source, job.rebuilt, job.textures);
+        break;
+    }
+    case JobKind::Texture:
+        job.ok = BakeTexture(job.source, job.alphaCutoff, opt, job.rebuilt);
+        break;
+    case JobKind::Font:
+        job.ok = true;
+        for (int px : opt.fontSizes)
+        {
+            bool rebuilt = false;
+            job.ok = TextRenderer::CookFont(job.source, px, rebuilt) && job.ok;
+            job.rebuilt = job.rebuilt || rebuilt;
+        }
+        break;
+    case JobKind::Sound:
+        job.ok = Audio::CookWAV(job.source, job.rebuilt);
+        break;
+    }
+    job.ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static void RunStage(std::vector<BakeJob> &jobs, size_t first, const BakeOptions &opt)
+{
+    ParallelFor(jobs.size() - first, [&](size_t i)
+                { RunJob(jobs[first + i], opt); });
+}
+
+static const char *KindName(JobKind kind)
+{
+    switch (kind)
+    {
+    case JobKind::Mesh:
+        return "mesh";
+    case JobKind::Texture:
+        return "texture";
+    case JobKind::Font:
+        return "font";
+    case JobKind::Sound:
+        return "sound";
+    }
+    return "?";
+}
+
+int main(int argc, char **argv)
+{
+    BakeOptions opt;
+    std::vector<std::string> textureDirs;
+    std::string assetsDir;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bc7") == 0)
+            opt.opaqueFormat = opt.alphaFormat = BlockFormat::BC7;
+        else if (std::strcmp(argv[i], "--font-px") == 0 && i + 1 < argc)
+            opt.fontSizes.push_back(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--textures") == 0 && i + 1 < argc)
+            textureDirs.push_back(argv[++i]);
+        else
+            assetsDir = argv[i];
+    }
+    if (assetsDir.empty())
+    {
+        std::fprintf(stderr, "usage: %s [--bc7] [--font-px N] [--textures DIR]... <assets dir>\n", argv[0]);
+        return 2;
+    }
+    if (opt.fontSizes.empty())
+        opt.fontSizes.push_back(48); // the size UI and main() load
+    Clock::time_point t0 = Clock::now();
+
+    // same roots and manifest as the game, so the index resolves texture references identically and
+    // the first start finds the manifest already up to date
+    std::vector<std::string> roots = {assetsDir};
+    roots.insert(roots.end(), textureDirs.begin(), textureDirs.end());
+    fs::path assetsPath = fs::absolute(fs::path(assetsDir)).lexically_normal();
+    if (!assetsPath.has_filename())
+        assetsPath = assetsPath.parent_path();
+    AssetIndex::Instance().Build(roots, (assetsPath.parent_path() / "asset_manifest.txt").string());
+
+    std::vector<BakeJob> jobs;
+    std::vector<BakeJob> later; // textures, fonts and sounds found by the scan
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(assetsPath, fs::directory_options::skip_permission_denied, ec), end;
+         it != end && !ec; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec) || it->path().filename().string()[0] == '.')
+            continue;
+        bool known;
+        JobKind kind = ClassifyExtension(Lower(it->path().extension().string()), known);
+        if (!known)
+            continue;
+        BakeJob job;
+        job.kind = kind;
+        job.source = it->path().lexically_normal().generic_string();
+        (kind == JobKind::Mesh ? jobs : later).push_back(job);
+    }
+
+    // stage 1: models
+    RunStage(jobs, 0, opt);
+
+    // stage 2: images in the asset tree plus every map a model references, each once; the
+    // first material to reference a map picks its alpha cutoff, as TextureCache does at runtime
+    std::map<std::string, float> textures;
+    size_t missing = 0;
+    for (const auto &job : jobs)
+    {
+        for (const auto &tex : job.textures)
+        {
+            std::string path = fs::absolute(fs::path(tex.first)).lexically_normal().generic_string();
+            if (fs::is_regular_file(path, ec))
+                textures.emplace(path, tex.second);
+            else
+                missing++;
+        }
+    }
+    for (const auto &job : later)
+    {
+        if (job.kind == JobKind::Texture)
+            textures.emplace(job.source, 0.0f);
+    }
+    size_t first = jobs.size();
+    for (auto &job : later)
+    {
+        if (job.kind != JobKind::Texture)
+            jobs.push_back(job);
+    }
+    for (const auto &tex : textures)
+    {
+        BakeJob job;
+        job.kind = JobKind::Texture;
+        job.source = tex.first;
+        job.alphaCutoff = tex.second;
+        jobs.push_back(job);
+    }
+    RunStage(jobs, first, opt);
+
+    size_t rebuilt = 0, failed = 0;
+    for (const auto &job : jobs)
+    {
+        if (!job.ok)
+        {
+            failed++;
+            std::fprintf(stderr, "asset_bake: FAILED %s %s\n", KindName(job.kind), job.source.c_str());
+        }
+        else if (job.rebuilt)
+        {
+            rebuilt++;
+            std::printf("asset_bake: cooked %-7s %8.1f ms  %s\n", KindName(job.kind), job.ms, job.source.c_str());
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::printf("asset_bake: %zu jobs, %zu cooked, %zu up to date, %zu failed, %zu missing texture references, "
+                "%.0f ms\n",
+                jobs.size(), rebuilt, jobs.size() - rebuilt - failed, failed, missing, ms);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+// tools/AssetPackTool.cpp
+// Builds the single-file asset pack the game mounts at startup.
+// usage: asset_pack <out.pak> <root dir> <dir> [dir ...]   (dirs relative to root or absolute)
+#include "AssetPack.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        std::fprintf(stderr, "usage: %s <out.pak> <root dir> <dir> [dir ...]\n", argv[0]);
+        return 2;
+    }
+    std::vector<std::string> dirs(argv + 3, argv + argc);
+    return AssetPack::Write(argv[2], dirs, argv[1]) ? 0 : 1;
+}
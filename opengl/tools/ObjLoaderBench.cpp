@@ -0,0 +1,100 @@
+// tools/ObjLoaderBench.cpp
+// Times the native ObjLoader against Assimp on the same files.
+// usage: ObjLoaderBench [-n runs] [model.obj ...]   (defaults to the bundled models)
+#include "ObjLoader.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// same flags as StaticModel's import
+static const unsigned int kImportFlags = aiProcess_Triangulate |
+                                         aiProcess_GenSmoothNormals |
+                                         aiProcess_FlipUVs |
+                                         aiProcess_CalcTangentSpace |
+                                         aiProcess_JoinIdenticalVertices |
+                                         aiProcess_OptimizeMeshes;
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[v.size() / 2];
+}
+
+int main(int argc, char **argv)
+{
+    int runs = 10;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        files = {"assets/models/cat_for_opengl.obj", "assets/models/walk_cat.obj",
+                 "assets/models/teapot.obj", "assets/models/floor.obj"};
+    }
+
+    std::printf("%-36s %10s %10s %8s   %s\n", "model", "assimp ms", "native ms", "speedup", "verts/tris (assimp | native)");
+    for (const auto &path : files)
+    {
+        std::vector<double> assimpMs, nativeMs;
+        size_t aVerts = 0, aTris = 0, nVerts = 0, nTris = 0;
+        bool ok = true;
+        for (int r = 0; r < runs && ok; ++r)
+        {
+            Clock::time_point t0 = Clock::now();
+            {
+                Assimp::Importer importer;
+                const aiScene *scene = importer.ReadFile(path, kImportFlags);
+                if (!scene)
+                {
+                    std::fprintf(stderr, "assimp failed on %s: %s\n", path.c_str(), importer.GetErrorString());
+                    ok = false;
+                    break;
+                }
+                aVerts = aTris = 0;
+                for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+                {
+                    aVerts += scene->mMeshes[m]->mNumVertices;
+                    aTris += scene->mMeshes[m]->mNumFaces;
+                }
+            }
+            Clock::time_point t1 = Clock::now();
+            {
+                ObjScene scene;
+                if (!LoadObj(path, scene))
+                {
+                    ok = false;
+                    break;
+                }
+                nVerts = nTris = 0;
+                for (const auto &m : scene.meshes)
+                {
+                    nVerts += m.vertices.size();
+                    nTris += m.indices.size() / 3;
+                }
+            }
+            Clock::time_point t2 = Clock::now();
+            assimpMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+            nativeMs.push_back(std::chrono::duration<double, std::milli>(t2 - t1).count());
+        }
+        if (!ok)
+            continue;
+        double a = Median(assimpMs), n = Median(nativeMs);
+        std::printf("%-36s %10.2f %10.2f %7.1fx   %zu/%zu | %zu/%zu\n", path.c_str(), a, n, n > 0.0 ? a / n : 0.0,
+                    aVerts, aTris, nVerts, nTris);
+    }
+    return 0;
+}